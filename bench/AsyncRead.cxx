@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <AsyncFileIo.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <PositionalFile.hxx>
+
+/* Random reads of 4 KiB blocks from a single thread, synchronous (pread) then asynchronous, the queue depth going
+ * from 1 to 128, first straight through AsyncFileIo, then loading pages in the buffer through prefetchPages.
+ * The gain of the deep queues comes from the device serving many reads at once : it is the most visible on a cold
+ * cache, with a NVMe drive. With the file in the cache of the OS, the reads are memory copies, and the queue depth
+ * only saves system calls.
+ */
+
+#ifdef HAS_POSITIONAL_IO
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type blockSize = 4096;
+static constexpr size_type blockCount = 1 << 15;
+static constexpr size_type readCount = 1 << 17;
+static constexpr size_type pageCount = 1 << 14;
+static constexpr size_type slotCount = 448;
+
+static const std::string blockFileName = "AsyncRead.db";
+static const std::string pageFileName = "AsyncReadPages.db";
+
+std::vector<std::streamoff> randomOffsets(size_type count, size_type maxIndex, size_type step)
+{
+	std::mt19937_64 generator{42};
+	std::uniform_int_distribution<size_type> distribution{0, maxIndex - 1};
+	std::vector<std::streamoff> offsets;
+
+	for(size_type i = 0; i < count; ++i)
+	{
+		offsets.push_back(distribution(generator) * step);
+	}
+
+	return offsets;
+}
+
+void createBlockFile()
+{
+	std::ofstream file{blockFileName, std::ios::binary | std::ios::trunc};
+	std::vector<char> block(blockSize, 1);
+
+	for(size_type i = 0; i < blockCount; ++i)
+	{
+		file.write(block.data(), block.size());
+	}
+}
+
+void printRate(const std::string& name, size_type depth, size_type count, std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << std::setw(24) << name << std::setw(8) << depth
+			  << std::setw(16) << std::fixed << std::setprecision(3) << (count / elapsed.count() / 1e6) << std::endl;
+}
+
+void benchmarkBlocks()
+{
+	PositionalFile file{blockFileName, std::ios_base::in | std::ios::binary};
+	auto offsets = randomOffsets(readCount, blockCount, blockSize);
+	std::vector<uint8_t> blocks(128 * blockSize);
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(std::streamoff offset : offsets)
+	{
+		file.read(blocks.data(), blockSize, offset);
+	}
+
+	printRate("pread", 1, readCount, start);
+
+	for(size_type depth = 1; depth <= 128; depth *= 2)
+	{
+		AsyncFileIo io{file.getDescriptor(), depth};
+		std::vector<AsyncIoCompletion> completions;
+		std::vector<uint64_t> freeSlots;
+
+		for(size_type i = 0; i < depth; ++i) freeSlots.push_back(i);
+
+		start = std::chrono::steady_clock::now();
+
+		for(size_type next = 0; (next < readCount) || (io.getPendingCount() > 0);)
+		{
+			while((next < readCount) && !freeSlots.empty())
+			{
+				uint64_t slot = freeSlots.back();
+				freeSlots.pop_back();
+				io.prepareRead(blocks.data() + slot * blockSize, blockSize, offsets[next++], slot);
+			}
+
+			completions.clear();
+			io.wait(completions);
+
+			for(const AsyncIoCompletion& completion : completions) freeSlots.push_back(completion.tag);
+		}
+
+		printRate(io.usesIoUring() ? "io_uring" : "thread pool", depth, readCount, start);
+	}
+}
+
+void createPageFile()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+
+	// The writer expects an existing file.
+	std::ofstream{pageFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{pageFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		writer.appendPage(page);
+	}
+}
+
+void benchmarkPages()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	size_type rawPageSize = DiskPage<usedEndianness>{0, schema, slotCount}.getRawPageSize();
+
+	auto offsets = randomOffsets(pageCount, pageCount, rawPageSize);
+	std::sort(offsets.begin(), offsets.end());
+	offsets.erase(std::unique(offsets.begin(), offsets.end()), offsets.end());
+	std::shuffle(offsets.begin(), offsets.end(), std::mt19937_64{7});
+
+	{
+		BufferManager<usedEndianness> manager{pageFileName, pageCount};
+		manager.setMaxReadAheadWindow(0);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(std::streamoff offset : offsets)
+		{
+			manager.template requestPage<PageType::ReadOnly>(offset);
+		}
+
+		printRate("requestPage", 1, offsets.size(), start);
+	}
+
+	for(size_type depth = 1; depth <= 128; depth *= 2)
+	{
+		BufferManager<usedEndianness> manager{pageFileName, pageCount};
+		manager.setMaxReadAheadWindow(0);
+		manager.setAsyncQueueDepth(depth);
+
+		auto start = std::chrono::steady_clock::now();
+		manager.prefetchPages(offsets);
+
+		printRate("prefetchPages", depth, manager.getPrefetchedPageCount(), start);
+	}
+}
+
+int main()
+{
+	createBlockFile();
+	createPageFile();
+
+	std::clog << readCount << " random reads of " << blockSize << " bytes in " << blockCount << " blocks, then "
+			  << pageCount << " random pages" << std::endl << std::endl;
+	std::clog << std::setw(24) << "path" << std::setw(8) << "depth" << std::setw(16) << "reads (M/s)" << std::endl;
+
+	benchmarkBlocks();
+	benchmarkPages();
+
+	std::remove(blockFileName.c_str());
+	std::remove(pageFileName.c_str());
+	std::remove((pageFileName + ".fsm").c_str());
+
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::clog << "The asynchronous reads need pread, and are not available on this system." << std::endl;
+
+	return 0;
+}
+
+#endif
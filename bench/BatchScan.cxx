@@ -0,0 +1,156 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <BulkLoader.hxx>
+#include <Predicate.hxx>
+#include <QueryParser.hxx>
+
+/* Rows per second, and bytes of rows per second, of the average best time of the runners faster than a limit, grouped
+ * by name : first row at a time through an iterator, then batch at a time through a Query.
+ * The row count can be given as the first argument, 2M rows by default.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type defaultRowCount = 2000000;
+static constexpr uint32_t timeRange = 100000;
+
+static const std::string dbFileName = "BatchScan.db";
+static const std::string schemaFileName = "BatchScan.sch";
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+											 {"Number", {DataType::INTEGER, 32}}}};
+
+	return schema;
+}
+
+void createDatabase(size_type rowCount)
+{
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	{
+		std::ofstream{schemaFileName, std::ios::binary | std::ios::trunc};
+		FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+		schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(getSchema()));
+	}
+
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+	BulkLoader<usedEndianness> loader{system, "Runner"};
+	DbEntry<usedEndianness> entry{getSchema(), std::vector<uint8_t>(getSchema().getDataSize())};
+
+	for(size_type i = 0; i < rowCount; ++i)
+	{
+		entry.setAs("Name", (i % 2) ? "Runner" : "Walker");
+		entry.setAs<uint32_t>(1, static_cast<uint32_t>((i * 7919) % timeRange));
+		entry.setAs<uint32_t>(2, static_cast<uint32_t>(i));
+		loader.add(entry);
+	}
+}
+
+template<class Run>
+void benchmark(DbSystem<usedEndianness>& system, const std::string& name, size_type rowCount, Run run)
+{
+	// A first run to load the pages.
+	run(system);
+
+	auto start = std::chrono::steady_clock::now();
+	double result = run(system);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << std::setw(20) << name << std::setw(12) << rowCount << std::setw(16) << std::fixed << std::setprecision(2)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(16) << std::setprecision(1)
+			  << (rowCount * getSchema().getDataSize() / elapsed.count() / (1 << 20)) << std::setw(16) << std::setprecision(1)
+			  << result << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type rowCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultRowCount;
+	uint32_t limit = timeRange / 2;
+
+	createDatabase(rowCount);
+
+	{
+		DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+		std::clog << "Average best time below " << limit << " by name, over " << rowCount << " rows of " << getSchema().getDataSize()
+				  << " bytes" << std::endl << std::endl;
+		std::clog << std::setw(20) << "execution" << std::setw(12) << "rows" << std::setw(16) << "rows (M/s)"
+				  << std::setw(16) << "rows (MiB/s)" << std::setw(16) << "avg(Runner)" << std::endl;
+
+		benchmark(system, "row at a time", rowCount, [limit](DbSystem<usedEndianness>& system) {
+			std::map<std::string, std::pair<uint64_t, uint64_t>> groups;
+
+			auto end = system.template endIterator<PageType::ReadOnly>("Runner");
+
+			for(auto it = system.template getIterator<PageType::ReadOnly>("Runner"); it != end; ++it)
+			{
+				uint32_t bestTime = (*it).template getAs<uint32_t>(1);
+
+				if(bestTime < limit)
+				{
+					auto& group = groups[(*it).template getAs<std::string>(0)];
+					++group.first;
+					group.second += bestTime;
+				}
+			}
+
+			return static_cast<double>(groups["Runner"].second) / groups["Runner"].first;
+		});
+		benchmark(system, "batch at a time", rowCount, [limit](DbSystem<usedEndianness>& system) {
+			Query<usedEndianness> query{system, "Runner"};
+			query.where(Predicate::compare("BestTime", CompareOperator::less, limit)).groupBy({"Name"})
+				 .aggregate(AggregateFunction::average, "BestTime");
+
+			double average = 0;
+			QueryIterator result = query.execute();
+			size_type nameSize = result.getColumns()[0].size;
+
+			while(result.next())
+			{
+				const ColumnBatch& batch = result.getBatch();
+
+				for(size_type i = 0; i < batch.getSelectedCount(); ++i)
+				{
+					size_type row = batch.getSelectedRow(i);
+					const char* name = reinterpret_cast<const char*>(&batch.columns[0].bytes[row * nameSize]);
+
+					if(std::strncmp(name, "Runner", nameSize) == 0) average = batch.columns[1].floats[row];
+				}
+			}
+
+			return average;
+		});
+	}
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+	std::remove(schemaFileName.c_str());
+
+	return 0;
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+
+/* Throughput of read only point lookups through the BufferManager, from 1 to 16 threads.
+ * Every page of the file fits in the buffer, so after the warm up each lookup is a hit : the page table lookup,
+ * the pin, the shared latch of the frame, and the unpin. The lookups should scale with the number of threads,
+ * as long as the policy is concurrent (CLOCK). With LRU, the policy calls are serialized.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type pageCount = 4096;
+static constexpr size_type slotCount = 64;
+static constexpr size_type lookupCountByThread = 1 << 20;
+
+static const std::string dbFileName = "BufferManagerThroughput.db";
+
+std::vector<std::streamoff> createDatabase()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+	std::vector<std::streamoff> offsets;
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		offsets.push_back(i * page.getRawPageSize());
+		page.setNextPageOffset((i + 1 < pageCount) ? (i + 1) * page.getRawPageSize() : 0);
+		writer.appendPage(page);
+	}
+
+	return offsets;
+}
+
+template<class Policy>
+void benchmarkPolicy(const std::string& name, const std::vector<std::streamoff>& offsets)
+{
+	BufferManager<usedEndianness> manager{dbFileName, pageCount, std::make_unique<Policy>(pageCount)};
+
+	for(auto offset : offsets)
+	{
+		manager.template requestPage<PageType::ReadOnly>(offset);
+	}
+
+	double singleThreadRate = 0;
+
+	for(size_type threadCount = 1; threadCount <= 16; threadCount *= 2)
+	{
+		std::vector<std::thread> threads;
+		auto start = std::chrono::steady_clock::now();
+
+		for(size_type t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&manager, &offsets, t]() {
+				std::mt19937_64 generator{t};
+				std::uniform_int_distribution<size_type> pageDistribution{0, offsets.size() - 1};
+				size_type freeSlots = 0;
+
+				for(size_type i = 0; i < lookupCountByThread; ++i)
+				{
+					auto handle = manager.template requestPage<PageType::ReadOnly>(offsets[pageDistribution(generator)]);
+					freeSlots += handle.get()->getFreeSlotCount();
+				}
+
+				volatile size_type sink = freeSlots;
+				(void)sink;
+			});
+		}
+
+		for(auto& thread : threads) thread.join();
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		double rate = (threadCount * lookupCountByThread) / elapsed.count() / 1e6;
+
+		if(threadCount == 1) singleThreadRate = rate;
+
+		std::clog << std::setw(8) << name << std::setw(10) << threadCount
+				  << std::setw(18) << std::fixed << std::setprecision(2) << rate
+				  << std::setw(12) << (rate / singleThreadRate) << std::endl;
+	}
+}
+
+int main()
+{
+	auto offsets = createDatabase();
+
+	std::clog << pageCount << " pages, all resident, " << lookupCountByThread << " lookups by thread, "
+			  << std::thread::hardware_concurrency() << " hardware threads" << std::endl << std::endl;
+	std::clog << std::setw(8) << "policy" << std::setw(10) << "threads" << std::setw(18) << "lookups (M/s)" << std::setw(12) << "speedup" << std::endl;
+
+	benchmarkPolicy<ClockPageReplacePolicy<usedEndianness>>("CLOCK", offsets);
+	benchmarkPolicy<LRUPageReplacePolicy<usedEndianness>>("LRU", offsets);
+
+	std::remove(dbFileName.c_str());
+
+	return 0;
+}
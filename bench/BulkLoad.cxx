@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <BulkLoader.hxx>
+
+/* Rows per second, and bytes per second written to the database file, when loading an empty database row by row with
+ * DbSystem::add, then with a BulkLoader. Every add looks for a free page, and every page it has to create is written
+ * on its own, with the previous last page written again to link it. The loader only writes whole batches of pages,
+ * sequentially, and links them once by batch.
+ * The row count can be given as the first argument, 1M rows by default. The adds are much slower, so they only load
+ * a tenth of the rows.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type defaultRowCount = 1000000;
+
+static const std::string dbFileName = "BulkLoad.db";
+static const std::string schemaFileName = "BulkLoad.sch";
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+											 {"Number", {DataType::INTEGER, 32}}}};
+
+	return schema;
+}
+
+void createDatabase()
+{
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	std::ofstream{schemaFileName, std::ios::binary | std::ios::trunc};
+	FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+	schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(getSchema()));
+}
+
+template<class Load>
+void benchmarkLoad(const std::string& name, size_type rowCount, Load load)
+{
+	createDatabase();
+
+	auto start = std::chrono::steady_clock::now();
+
+	{
+		DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+		const DbSchema& schema = *system.getSchema(*system.getSchemaIndex("Runner"));
+
+		DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+		entry.setAs("Name", "Runner");
+
+		load(system, entry, rowCount);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::streamoff fileSize = std::ifstream{dbFileName, std::ios::binary | std::ios::ate}.tellg();
+
+	std::clog << std::setw(12) << name << std::setw(12) << rowCount << std::setw(16) << std::fixed << std::setprecision(3)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(16) << std::setprecision(1)
+			  << (fileSize / elapsed.count() / (1 << 20)) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type rowCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultRowCount;
+
+	std::clog << "Load of " << rowCount << " rows of " << getSchema().getDataSize() << " bytes in an empty database"
+			  << std::endl << std::endl;
+	std::clog << std::setw(12) << "load" << std::setw(12) << "rows" << std::setw(16) << "rows (M/s)"
+			  << std::setw(16) << "file (MiB/s)" << std::endl;
+
+	benchmarkLoad("add", rowCount / 10, [](DbSystem<usedEndianness>& system, DbEntry<usedEndianness>& entry, size_type count) {
+		for(size_type i = 0; i < count; ++i)
+		{
+			entry.setAs<uint32_t>(1, static_cast<uint32_t>(i));
+			system.add(entry);
+		}
+	});
+
+	benchmarkLoad("bulk", rowCount, [](DbSystem<usedEndianness>& system, DbEntry<usedEndianness>& entry, size_type count) {
+		BulkLoader<usedEndianness> loader{system, "Runner"};
+
+		for(size_type i = 0; i < count; ++i)
+		{
+			entry.setAs<uint32_t>(1, static_cast<uint32_t>(i));
+			loader.add(entry);
+		}
+	});
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+	std::remove(schemaFileName.c_str());
+
+	return 0;
+}
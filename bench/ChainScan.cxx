@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+
+/* Time of a cold walk along a page chain, the way a DbIterator goes through a table, depending on the read ahead window.
+ * The chain is much bigger than the buffer, so every page has to be read from the file, either by the walk itself
+ * or ahead of it by the prefetcher. The file is likely in the cache of the OS though : the gain is the most visible
+ * on a cold cache, with a latency bound device.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type pageCount = 1 << 16;
+static constexpr size_type slotCount = 64;
+static constexpr size_type bufferSize = 1024;
+
+static const std::string dbFileName = "ChainScan.db";
+
+void createDatabase()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		page.setNextPageOffset((i + 1 < pageCount) ? (i + 1) * page.getRawPageSize() : 0);
+		writer.appendPage(page);
+	}
+}
+
+void benchmarkWindow(size_type window)
+{
+	BufferManager<usedEndianness> manager{dbFileName, bufferSize};
+	manager.setMaxReadAheadWindow(window);
+
+	auto start = std::chrono::steady_clock::now();
+
+	size_type walkedPageCount = 1;
+	size_type freeSlots = 0;
+	auto handle = manager.template requestPage<PageType::ReadOnly>(0);
+
+	while(true)
+	{
+		auto nextHandle = manager.template requestNextPage<PageType::ReadOnly>(*handle.get());
+
+		if(!nextHandle.get()) break;
+
+		freeSlots += nextHandle.get()->getFreeSlotCount();
+		handle = std::move(nextHandle);
+		++walkedPageCount;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	volatile size_type sink = freeSlots;
+	(void)sink;
+
+	std::clog << std::setw(8) << window << std::setw(10) << walkedPageCount
+			  << std::setw(14) << manager.getPrefetchedPageCount()
+			  << std::setw(14) << std::fixed << std::setprecision(3) << elapsed.count() << std::endl;
+}
+
+int main()
+{
+	createDatabase();
+
+	std::clog << pageCount << " pages in the chain, " << bufferSize << " frames" << std::endl << std::endl;
+	std::clog << std::setw(8) << "window" << std::setw(10) << "pages" << std::setw(14) << "prefetched" << std::setw(14) << "time (s)" << std::endl;
+
+	for(size_type window : {0, 8, 64, 256})
+	{
+		benchmarkWindow(window);
+	}
+
+	std::remove(dbFileName.c_str());
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <CsvImporter.hxx>
+
+/* Rows per second, and bytes per second read from the CSV file, when importing a CSV file into an empty database, with
+ * one parsing thread and up to the number of cores. The file is read once before, so that it is in the page cache and
+ * the parsing, not the disk, is measured.
+ * The row count can be given as the first argument, 2M rows by default.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type defaultRowCount = 2000000;
+
+static const std::string dbFileName = "CsvImport.db";
+static const std::string schemaFileName = "CsvImport.sch";
+static const std::string csvFileName = "CsvImport.csv";
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+											 {"Speed", {DataType::FLOAT, 24}}, {"Birth", {DataType::DATE}}}};
+
+	return schema;
+}
+
+void createCsvFile(size_type rowCount)
+{
+	std::ofstream csv{csvFileName, std::ios::binary | std::ios::trunc};
+
+	csv << "Name,BestTime,Speed,Birth\n";
+
+	for(size_type i = 0; i < rowCount; ++i)
+	{
+		csv << "\"Runner " << i << "\"," << (i * 7919) % 100000 << ',' << (i % 300) / 10.0 << ','
+			<< (i % 28 + 1) << '/' << (i % 12 + 1) << '/' << (1950 + i % 60) << '\n';
+	}
+}
+
+void createDatabase()
+{
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	std::ofstream{schemaFileName, std::ios::binary | std::ios::trunc};
+	FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+	schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(getSchema()));
+}
+
+void benchmarkImport(size_type threadCount, std::streamoff csvSize)
+{
+	createDatabase();
+
+	auto start = std::chrono::steady_clock::now();
+	size_type rowCount = 0;
+
+	{
+		DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+		CsvImportOptions options;
+		options.hasHeader = true;
+		options.threadCount = threadCount;
+
+		rowCount = CsvImporter<usedEndianness>{system, "Runner", options}.import(csvFileName);
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << std::setw(12) << threadCount << std::setw(12) << rowCount << std::setw(16) << std::fixed << std::setprecision(3)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(16) << std::setprecision(1)
+			  << (csvSize / elapsed.count() / (1 << 20)) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type rowCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultRowCount;
+
+	createCsvFile(rowCount);
+
+	std::streamoff csvSize = std::ifstream{csvFileName, std::ios::binary | std::ios::ate}.tellg();
+
+	{
+		std::ifstream csv{csvFileName, std::ios::binary};
+		std::vector<char> buffer(1 << 20);
+
+		while(csv.read(buffer.data(), buffer.size())) {}
+	}
+
+	std::clog << "Import of " << rowCount << " rows (" << (csvSize >> 20) << " MiB of CSV) in an empty database"
+			  << std::endl << std::endl;
+	std::clog << std::setw(12) << "threads" << std::setw(12) << "rows" << std::setw(16) << "rows (M/s)"
+			  << std::setw(16) << "CSV (MiB/s)" << std::endl;
+
+	size_type coreCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for(size_type threadCount = 1; threadCount <= coreCount; threadCount *= 2)
+	{
+		benchmarkImport(threadCount, csvSize);
+	}
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+	std::remove(schemaFileName.c_str());
+	std::remove(csvFileName.c_str());
+
+	return 0;
+}
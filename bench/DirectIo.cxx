@@ -0,0 +1,153 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+
+/* Random page requests on a file of aligned 4 KiB pages, four times bigger than the buffer, read through the cache of
+ * the system then with direct I/O. Along with the time, the share of the file left in the cache of the system once
+ * done : through the cache, the pages evicted from the buffer are still in memory, a second copy of them; with direct
+ * I/O, the buffer is the only cache, and the memory used is its size.
+ * Direct I/O has every miss of the buffer go to the device, so it is slower when the file would fit in memory : it pays
+ * off when the memory is better spent on a bigger buffer.
+ */
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr PageLayout layout = PageLayout::aligned4K;
+static constexpr size_type pageCount = 1 << 14;
+static constexpr size_type bufferSize = 1 << 12;
+static constexpr size_type requestCount = 1 << 17;
+
+static const std::string dbFileName = "DirectIo.db";
+
+void createDatabase()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	DiskPage<usedEndianness> page{0, schema, layout};
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		writer.appendPage(page);
+	}
+}
+
+// Only a hint too, the pages are kept if the system does not want to drop them.
+void dropFromCache()
+{
+	int descriptor = ::open(dbFileName.c_str(), O_RDONLY);
+
+	if(descriptor < 0) return;
+
+	::fdatasync(descriptor);
+	::posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+	::close(descriptor);
+}
+
+// The share of the file in the cache of the system, from the residency of a mapping of it.
+double getCachedShare()
+{
+	int descriptor = ::open(dbFileName.c_str(), O_RDONLY);
+	size_type size = pageCount * static_cast<size_type>(layout);
+	void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+
+	if(data == MAP_FAILED) return 0;
+
+	size_type systemPageSize = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+	std::vector<unsigned char> residency((size + systemPageSize - 1) / systemPageSize);
+	size_type cached = 0;
+
+	if(::mincore(data, size, residency.data()) == 0)
+	{
+		for(unsigned char page : residency) cached += page & 1;
+	}
+
+	::munmap(data, size);
+
+	return static_cast<double>(cached) / residency.size();
+}
+
+void benchmarkRequests(const std::string& name, OpenMode mode)
+{
+	dropFromCache();
+
+	std::mt19937_64 generator{42};
+	std::uniform_int_distribution<size_type> distribution{0, pageCount - 1};
+
+	auto start = std::chrono::steady_clock::now();
+
+	{
+		BufferManager<usedEndianness> manager{dbFileName, bufferSize, std::make_unique<ClockPageReplacePolicy<usedEndianness>>(bufferSize),
+											  4096, 16, mode, layout};
+		manager.setMaxReadAheadWindow(0);
+
+		for(size_type i = 0; i < requestCount; ++i)
+		{
+			manager.template requestPage<PageType::ReadOnly>(distribution(generator) * static_cast<size_type>(layout));
+		}
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << std::setw(12) << name << std::setw(16) << std::fixed << std::setprecision(3) << (requestCount / elapsed.count() / 1e6)
+			  << std::setw(16) << std::setprecision(1) << (getCachedShare() * 100) << std::endl;
+}
+
+int main()
+{
+	createDatabase();
+
+	std::clog << requestCount << " random requests of " << pageCount << " pages of " << static_cast<size_type>(layout)
+			  << " bytes, " << bufferSize << " frames in the buffer" << std::endl << std::endl;
+	std::clog << std::setw(12) << "file" << std::setw(16) << "requests (M/s)" << std::setw(16) << "cached (%)" << std::endl;
+
+	try
+	{
+		benchmarkRequests("buffered", OpenMode::readWrite);
+		benchmarkRequests("direct", OpenMode::readWriteDirect);
+	}
+	catch(const std::exception& e)
+	{
+		std::clog << e.what() << std::endl;
+	}
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::clog << "The direct I/O needs pread, and is not available on this system." << std::endl;
+
+	return 0;
+}
+
+#endif
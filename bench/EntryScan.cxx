@@ -0,0 +1,183 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <TypedSchema.hxx>
+
+/* Rows per second of a full scan summing a field, through the views the iterator yields, and copying every row into a
+ * DbEntry first (what the iterator used to do). Along with the time, the heap allocations by row, counted by replacing
+ * the global operator new : the views should need none.
+ * The field is read by its index, by its name (a lookup by row, as in most predicates), through a FieldRef resolved
+ * before the scan, and through the typed schema of the rows.
+ * The row count can be given as the first argument, 10M rows by default.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type slotCount = 512;
+static constexpr size_type defaultRowCount = 10000000;
+
+static const std::string dbFileName = "EntryScan.db";
+static const std::string schemaFileName = "EntryScan.sch";
+
+static std::atomic<size_type> allocationCount{0};
+
+void* operator new(std::size_t size)
+{
+	++allocationCount;
+
+	if(void* pointer = std::malloc(size ? size : 1)) return pointer;
+
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+TYPED_FIELD(Name, CHARACTER, 24);
+TYPED_FIELD(BestTime, INTEGER, 32);
+TYPED_FIELD(Number, INTEGER, 32);
+TYPED_SCHEMA(Runner, Name, BestTime, Number);
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema = Runner::toDbSchema();
+
+	return schema;
+}
+
+// Full pages, written straight to the file : the catalog is rebuilt from them when the database is opened.
+void createDatabase(size_type rowCount)
+{
+	const DbSchema& schema = getSchema();
+
+	{
+		std::ofstream{schemaFileName, std::ios::binary | std::ios::trunc};
+		FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+		schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(schema));
+	}
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+	entry.setAs("Name", "Runner");
+
+	size_type pageCount = (rowCount + slotCount - 1) / slotCount;
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		DiskPage<usedEndianness> page{0, schema, slotCount};
+
+		for(size_type j = 0; (j < slotCount) && ((i * slotCount) + j < rowCount); ++j)
+		{
+			entry.setAs<uint32_t>(1, static_cast<uint32_t>(j));
+			page.add(entry);
+		}
+
+		page.setNextPageOffset((i + 1 < pageCount) ? (i + 1) * page.getRawPageSize() : 0);
+		writer.appendPage(page);
+	}
+}
+
+template<class ReadRow>
+void benchmarkScan(const std::string& name, ReadRow readRow)
+{
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+	size_type rowCount = 0;
+	size_type sum = 0;
+	size_type allocations = allocationCount;
+
+	auto start = std::chrono::steady_clock::now();
+
+	auto it = system.template getIterator<PageType::ReadOnly>("Runner");
+	auto end = system.template endIterator<PageType::ReadOnly>("Runner");
+
+	while(it != end)
+	{
+		sum += readRow(*it);
+		++rowCount;
+		++it;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	allocations = allocationCount - allocations;
+
+	volatile size_type sink = sum;
+	(void)sink;
+
+	std::clog << std::setw(12) << name << std::setw(12) << rowCount << std::setw(16) << std::fixed << std::setprecision(2)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(20) << std::setprecision(3)
+			  << (static_cast<double>(allocations) / rowCount) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type rowCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultRowCount;
+
+	createDatabase(rowCount);
+
+	std::clog << "Full scan of " << rowCount << " rows of " << getSchema().getDataSize() << " bytes, summing a field"
+			  << std::endl << std::endl;
+	std::clog << std::setw(12) << "read" << std::setw(12) << "rows" << std::setw(16) << "rows (M/s)"
+			  << std::setw(20) << "allocations by row" << std::endl;
+
+	// The rows of the database have the same layout.
+	FieldRef bestTime = *getSchema().findFieldRef("BestTime");
+
+	for(int i = 0; i < 2; ++i)
+	{
+		benchmarkScan("copied", [](const DbEntryView<usedEndianness>& view) {
+			DbEntry<usedEndianness> entry{view};
+			return entry.template getAs<uint32_t>(1);
+		});
+		benchmarkScan("views", [](const DbEntryView<usedEndianness>& view) {
+			return view.template getAs<uint32_t>(1);
+		});
+		benchmarkScan("by name", [](const DbEntryView<usedEndianness>& view) {
+			return view.template getAs<uint32_t>("BestTime");
+		});
+		benchmarkScan("field ref", [&bestTime](const DbEntryView<usedEndianness>& view) {
+			return view.template getAs<uint32_t>(bestTime);
+		});
+		benchmarkScan("typed", [](const DbEntryView<usedEndianness>& view) {
+			return TypedEntryView<usedEndianness, Runner>{view}.template get<BestTime>();
+		});
+	}
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+	std::remove(schemaFileName.c_str());
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <SlotBitmap.hxx>
+#include <FieldCompare.hxx>
+#include <Predicate.hxx>
+
+/* Rows per second, and bytes of rows per second, of a range predicate on an integer of the rows of a page, evaluated
+ * row by row (BoundPredicate::matches), then for all the slots at once (BoundPredicate::matchSlots), then by the
+ * comparison alone with each of the instruction sets of the processor (FieldCompare), free slots included.
+ * The rows stay in the cache : only the comparisons are measured. The slot count can be given as the first argument.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type defaultSlotCount = 64 * 1024;
+static constexpr size_type repetitionCount = 200;
+static constexpr uint32_t timeRange = 100000;
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+											 {"Number", {DataType::INTEGER, 32}}}};
+
+	return schema;
+}
+
+template<class Run>
+void benchmark(const std::string& name, size_type slotCount, Run run)
+{
+	size_type matchCount = 0;
+	auto start = std::chrono::steady_clock::now();
+
+	for(size_type i = 0; i < repetitionCount; ++i) matchCount += run();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	double rowCount = static_cast<double>(slotCount) * repetitionCount;
+
+	std::clog << std::setw(20) << name << std::setw(12) << slotCount << std::setw(16) << std::fixed << std::setprecision(1)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(16) << std::setprecision(2)
+			  << (rowCount * getSchema().getDataSize() / elapsed.count() / (1 << 30)) << std::setw(12) << (matchCount / repetitionCount)
+			  << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type slotCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultSlotCount;
+	size_type rowSize = getSchema().getDataSize();
+
+	// The rows of a page, after its header, with every eighth slot free.
+	std::vector<uint8_t> page(8 + slotCount * rowSize);
+	std::vector<uint8_t> slotBitmap(SlotBitmap::getSize(slotCount), 0);
+	std::vector<uint8_t> mask(slotBitmap.size());
+	DbEntry<usedEndianness> entry{getSchema(), std::vector<uint8_t>(rowSize)};
+	std::mt19937 generator{42};
+
+	for(size_type slot = 0; slot < slotCount; ++slot)
+	{
+		entry.setAs("Name", (slot % 2) ? "Runner" : "Walker");
+		entry.setAs<uint32_t>(1, generator() % timeRange);
+		entry.setAs<uint32_t>(2, static_cast<uint32_t>(slot));
+		std::copy(entry.getRawData().begin(), entry.getRawData().end(), page.begin() + 8 + slot * rowSize);
+
+		if(slot % 8 != 7) SlotBitmap::set(slotBitmap.data(), slot);
+	}
+
+	const uint8_t* rows = page.data() + 8;
+	size_type bestTimeOffset = getSchema().getFieldOffset("BestTime");
+	Predicate predicate = Predicate::compare("BestTime", CompareOperator::greaterOrEqual, timeRange / 4)
+						&& Predicate::compare("BestTime", CompareOperator::less, timeRange / 2);
+	BoundPredicate<usedEndianness> boundPredicate{predicate, getSchema()};
+
+	auto countMatches = [&mask, slotCount]() {
+		size_type count = 0;
+
+		for(size_type slot = SlotBitmap::findNextUsed(mask.data(), 0, slotCount); slot < slotCount;
+			slot = SlotBitmap::findNextUsed(mask.data(), slot + 1, slotCount))
+		{
+			++count;
+		}
+
+		return count;
+	};
+
+	std::clog << "Best time in [" << timeRange / 4 << ", " << timeRange / 2 << "[ over the slots of a page of " << rowSize
+			  << " bytes rows" << std::endl << std::endl;
+	std::clog << std::setw(20) << "evaluation" << std::setw(12) << "slots" << std::setw(16) << "rows (M/s)"
+			  << std::setw(16) << "rows (GiB/s)" << std::setw(12) << "matches" << std::endl;
+
+	benchmark("row by row", slotCount, [&]() {
+		size_type count = 0;
+
+		for(size_type slot = SlotBitmap::findNextUsed(slotBitmap.data(), 0, slotCount); slot < slotCount;
+			slot = SlotBitmap::findNextUsed(slotBitmap.data(), slot + 1, slotCount))
+		{
+			count += boundPredicate.matches(rows + slot * rowSize);
+		}
+
+		return count;
+	});
+
+	benchmark("page, predicate", slotCount, [&]() {
+		boundPredicate.matchSlots(rows, slotBitmap.data(), slotCount, mask.data());
+		return countMatches();
+	});
+
+	const char* instructionSetNames[] = {"page, scalar", "page, SSE 4.2", "page, AVX2"};
+
+	for(size_type i = 0; i <= static_cast<size_type>(FieldCompare::getInstructionSet()); ++i)
+	{
+		benchmark(instructionSetNames[i], slotCount, [&]() {
+			FieldCompare::compareIntegers(rows + bestTimeOffset, sizeof(uint32_t), rowSize, slotCount, timeRange / 4, timeRange / 2 - 1, false,
+										  mask.data(), static_cast<FieldCompare::InstructionSet>(i));
+			return countMatches();
+		});
+	}
+
+	return 0;
+}
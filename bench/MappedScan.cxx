@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+
+/* Time to the first page, then to the end of a walk along a page chain, with the file read through the buffer and
+ * with the file mapped read only. The file is dropped from the cache of the OS before every run (when the system
+ * lets us), so the first page has to come from the device : opening the buffer allocates its arena and starts its
+ * threads, opening the mapping only maps the file.
+ */
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type pageCount = 1 << 16;
+static constexpr size_type slotCount = 64;
+static constexpr size_type bufferSize = 1024;
+
+static const std::string dbFileName = "MappedScan.db";
+
+void createDatabase()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		page.setNextPageOffset((i + 1 < pageCount) ? (i + 1) * page.getRawPageSize() : 0);
+		writer.appendPage(page);
+	}
+}
+
+// Only a hint too, the pages are kept if the system does not want to drop them.
+void dropFromCache()
+{
+	int descriptor = ::open(dbFileName.c_str(), O_RDONLY);
+
+	if(descriptor < 0) return;
+
+	::fdatasync(descriptor);
+	::posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+	::close(descriptor);
+}
+
+void benchmarkScan(const std::string& name, OpenMode mode)
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+	size_type rawPageSize = DiskPage<usedEndianness>{0, schema, slotCount}.getRawPageSize();
+
+	dropFromCache();
+
+	auto start = std::chrono::steady_clock::now();
+
+	BufferManager<usedEndianness> manager{dbFileName, bufferSize, std::make_unique<LRUPageReplacePolicy<usedEndianness>>(bufferSize),
+										  4096, 16, mode};
+	manager.adviseScan(0, (pageCount - 1) * rawPageSize);
+
+	size_type walkedPageCount = 1;
+	size_type freeSlots = 0;
+	auto handle = manager.template requestPage<PageType::ReadOnly>(0);
+
+	std::chrono::duration<double> firstPage = std::chrono::steady_clock::now() - start;
+
+	while(true)
+	{
+		auto nextHandle = manager.template requestNextPage<PageType::ReadOnly>(*handle.get());
+
+		if(!nextHandle.get()) break;
+
+		freeSlots += nextHandle.get()->getFreeSlotCount();
+		handle = std::move(nextHandle);
+		++walkedPageCount;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	volatile size_type sink = freeSlots;
+	(void)sink;
+
+	std::clog << std::setw(12) << name << std::setw(10) << walkedPageCount
+			  << std::setw(18) << std::fixed << std::setprecision(3) << (firstPage.count() * 1e3)
+			  << std::setw(14) << elapsed.count() << std::endl;
+}
+
+int main()
+{
+	createDatabase();
+
+	std::clog << "Cold walk along a chain of " << pageCount << " pages, " << bufferSize << " frames in the buffer" << std::endl << std::endl;
+	std::clog << std::setw(12) << "file" << std::setw(10) << "pages" << std::setw(18) << "first page (ms)" << std::setw(14) << "walk (s)" << std::endl;
+
+	for(int i = 0; i < 2; ++i)
+	{
+		benchmarkScan("buffered", OpenMode::readWrite);
+		benchmarkScan("mapped", OpenMode::readOnlyMapped);
+	}
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::clog << "The database file cannot be mapped on this system." << std::endl;
+
+	return 0;
+}
+
+#endif
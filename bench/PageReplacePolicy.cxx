@@ -0,0 +1,101 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <ClockPageReplacePolicy.hxx>
+#include <LRUPageReplacePolicy.hxx>
+
+/* Microbenchmark of the replace policies.
+ * For each buffer size, we measure the mean cost of a pin/unpin cycle on a random frame (use + release,
+ * what the BufferManager does for every handle), and the mean cost of an eviction (getCandidate, then
+ * the new page is pinned and unpinned). Both costs should stay flat from 64 up to 1M frames, apart from
+ * the cache misses once the frames (and the pages themselves) no longer fit in the CPU caches.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+static constexpr size_type operationCount = 1 << 22;
+static constexpr size_type maxFrameCount = 1 << 20;
+
+using Clock = std::chrono::steady_clock;
+
+double nanosecondsPerOperation(Clock::time_point start, Clock::time_point end, size_type operations)
+{
+	return std::chrono::duration<double, std::nano>(end - start).count() / operations;
+}
+
+template<class Policy>
+void benchmarkPolicy(const std::string& policyName, const std::vector<DiskPage<usedEndianness>>& pages)
+{
+	std::minstd_rand generator{42};
+	std::vector<size_type> accesses(operationCount);
+
+	std::cout << policyName << std::endl;
+	std::cout << std::setw(10) << "frames" << std::setw(18) << "pin/unpin (ns)" << std::setw(18) << "eviction (ns)" << std::endl;
+
+	for(size_type frameCount = 64; frameCount <= maxFrameCount; frameCount *= 4)
+	{
+		Policy policy{frameCount};
+
+		for(size_type i = 0; i < frameCount; ++i)
+		{
+			policy.release(pages[i]);
+		}
+
+		std::uniform_int_distribution<size_type> distribution{0, frameCount - 1};
+		for(auto& access : accesses)
+		{
+			access = distribution(generator);
+		}
+
+		auto start = Clock::now();
+		for(auto access : accesses)
+		{
+			policy.use(pages[access]);
+			policy.release(pages[access]);
+		}
+		auto end = Clock::now();
+		double pinCost = nanosecondsPerOperation(start, end, operationCount);
+
+		start = Clock::now();
+		for(size_type i = 0; i < operationCount; ++i)
+		{
+			auto candidate = policy.getCandidate();
+			policy.use(pages[*candidate]);
+			policy.release(pages[*candidate]);
+		}
+		end = Clock::now();
+		double evictionCost = nanosecondsPerOperation(start, end, operationCount);
+
+		std::cout << std::setw(10) << frameCount
+				  << std::setw(18) << std::fixed << std::setprecision(2) << pinCost
+				  << std::setw(18) << evictionCost << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
+int main()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 1}}}};
+
+	std::vector<DiskPage<usedEndianness>> pages;
+	pages.reserve(maxFrameCount);
+	for(size_type i = 0; i < maxFrameCount; ++i)
+	{
+		pages.emplace_back(i, schema, 1);
+	}
+
+	benchmarkPolicy<LRUPageReplacePolicy<usedEndianness>>("LRU", pages);
+	benchmarkPolicy<ClockPageReplacePolicy<usedEndianness>>("CLOCK", pages);
+
+	return 0;
+}
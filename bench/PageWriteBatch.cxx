@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriteBatch.hxx>
+#include <PageWriter.hxx>
+
+/* Write throughput of the dirty pages an insert heavy load leaves behind, depending on the size of the write batches.
+ * The inserts fill the pages at the end of the chains, so the dirty pages are mostly adjacent in the file, but the
+ * buffer hands them out in the order of its frames : the order of the writes is shuffled by small windows.
+ * A batch of 1 is the old write path, a write and a flush by page.
+ * The second part inserts through the BufferManager, in a file bigger than its buffer, and reports how many writes
+ * the background writer and the evictions needed for the pages they wrote.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type pageCount = 1 << 14;
+static constexpr size_type slotCount = 64;
+static constexpr size_type shuffleWindow = 16;
+static constexpr size_type bufferSize = 1024;
+
+static const std::string dbFileName = "PageWriteBatch.db";
+
+static const DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 8}}}};
+
+void createDatabase()
+{
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+
+	// The writer expects an existing file.
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	PageWriter<usedEndianness> writer{dbFileName};
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		page.setNextPageOffset((i + 1 < pageCount) ? (i + 1) * page.getRawPageSize() : 0);
+		writer.appendPage(page);
+	}
+}
+
+void benchmarkBatchSize(size_type batchSize, const DiskPage<usedEndianness>& page)
+{
+	std::vector<std::streamoff> offsets;
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		offsets.push_back(i * page.getRawPageSize());
+	}
+
+	std::mt19937_64 generator{42};
+
+	for(size_type i = 0; i < pageCount; i += shuffleWindow)
+	{
+		std::shuffle(offsets.begin() + i, offsets.begin() + std::min(i + shuffleWindow, pageCount), generator);
+	}
+
+	PageWriter<usedEndianness> writer{dbFileName};
+	PageWriteBatch<usedEndianness> batch;
+	size_type writeCount = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(size_type i = 0; i < pageCount; ++i)
+	{
+		batch.add(page, offsets[i]);
+
+		if((batch.getPageCount() == batchSize) || (i + 1 == pageCount))
+		{
+			writeCount += writer.writeBatch(batch);
+			batch.clear();
+		}
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	double rate = (pageCount * page.getRawPageSize()) / elapsed.count() / (1 << 20);
+
+	std::clog << std::setw(8) << batchSize << std::setw(10) << pageCount << std::setw(10) << writeCount
+			  << std::setw(14) << std::fixed << std::setprecision(3) << elapsed.count()
+			  << std::setw(14) << std::setprecision(1) << rate << std::endl;
+}
+
+void benchmarkInserts()
+{
+	std::vector<uint8_t> value(8, 'x');
+	DbEntry<usedEndianness> entry{schema, value};
+	size_type rawPageSize = DiskPage<usedEndianness>{0, schema, slotCount}.getRawPageSize();
+
+	auto start = std::chrono::steady_clock::now();
+	size_type writtenPageCount = 0;
+	size_type writeCount = 0;
+	size_type evictionWriteCount = 0;
+
+	{
+		BufferManager<usedEndianness> manager{dbFileName, bufferSize};
+		manager.setMaxReadAheadWindow(0);
+
+		for(size_type i = 0; i < pageCount; ++i)
+		{
+			auto handle = manager.template requestPage<PageType::Writable>(i * rawPageSize);
+			handle.get()->add(entry);
+		}
+
+		writtenPageCount = manager.getWrittenPageCount();
+		writeCount = manager.getWriteCount();
+		evictionWriteCount = manager.getEvictionWriteCount();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << pageCount << " inserts, one by page, " << bufferSize << " frames : " << std::fixed << std::setprecision(3)
+			  << elapsed.count() << " s, " << writtenPageCount << " pages written before the shutdown in "
+			  << writeCount << " writes, " << evictionWriteCount << " by the evictions" << std::endl;
+}
+
+int main()
+{
+	createDatabase();
+
+	DiskPage<usedEndianness> page{0, schema, slotCount};
+
+	std::clog << pageCount << " dirty pages of " << page.getRawPageSize() << " bytes, shuffled by windows of "
+			  << shuffleWindow << " pages" << std::endl << std::endl;
+	std::clog << std::setw(8) << "batch" << std::setw(10) << "pages" << std::setw(10) << "writes"
+			  << std::setw(14) << "time (s)" << std::setw(14) << "MiB/s" << std::endl;
+
+	for(size_type batchSize : {1, 8, 64, 512})
+	{
+		benchmarkBatchSize(batchSize, page);
+	}
+
+	std::clog << std::endl;
+	benchmarkInserts();
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	return 0;
+}
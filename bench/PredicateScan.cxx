@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <BulkLoader.hxx>
+#include <Predicate.hxx>
+
+/* Rows per second, and bytes of rows per second, of an update and a delete of about 1% of the rows, selected by a
+ * lambda reading the fields by name (a string built by row for the name), then by a Predicate evaluated on the bytes
+ * of the rows in the pages.
+ * The row count can be given as the first argument, 2M rows by default.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type defaultRowCount = 2000000;
+static constexpr uint32_t timeRange = 100000;
+
+static const std::string dbFileName = "PredicateScan.db";
+static const std::string schemaFileName = "PredicateScan.sch";
+
+static const DbSchema& getSchema()
+{
+	static const DbSchema schema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+											 {"Number", {DataType::INTEGER, 32}}}};
+
+	return schema;
+}
+
+void createDatabase(size_type rowCount)
+{
+	std::ofstream{dbFileName, std::ios::binary | std::ios::trunc};
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+
+	{
+		std::ofstream{schemaFileName, std::ios::binary | std::ios::trunc};
+		FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+		schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(getSchema()));
+	}
+
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+	BulkLoader<usedEndianness> loader{system, "Runner"};
+	DbEntry<usedEndianness> entry{getSchema(), std::vector<uint8_t>(getSchema().getDataSize())};
+
+	for(size_type i = 0; i < rowCount; ++i)
+	{
+		entry.setAs("Name", (i % 2) ? "Runner" : "Walker");
+		entry.setAs<uint32_t>(1, static_cast<uint32_t>((i * 7919) % timeRange));
+		entry.setAs<uint32_t>(2, static_cast<uint32_t>(i));
+		loader.add(entry);
+	}
+}
+
+template<class Run>
+void benchmark(const std::string& name, size_type rowCount, Run run)
+{
+	createDatabase(rowCount);
+
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+	auto start = std::chrono::steady_clock::now();
+	run(system);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::clog << std::setw(20) << name << std::setw(12) << rowCount << std::setw(16) << std::fixed << std::setprecision(2)
+			  << (rowCount / elapsed.count() / 1e6) << std::setw(16) << std::setprecision(1)
+			  << (rowCount * getSchema().getDataSize() / elapsed.count() / (1 << 20)) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	size_type rowCount = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : defaultRowCount;
+
+	std::clog << "Update and delete of about 1% of " << rowCount << " rows of " << getSchema().getDataSize() << " bytes"
+			  << std::endl << std::endl;
+	std::clog << std::setw(20) << "statement" << std::setw(12) << "rows" << std::setw(16) << "rows (M/s)"
+			  << std::setw(16) << "rows (MiB/s)" << std::endl;
+
+	uint32_t limit = timeRange / 50;
+
+	benchmark("update, lambda", rowCount, [limit](DbSystem<usedEndianness>& system) {
+		system.updateWhen<uint32_t>("Runner", "Number", 0, [limit](const DbEntryView<usedEndianness>& entry) {
+			return (entry.getAs<std::string>("Name") == "Runner") && (entry.getAs<uint32_t>("BestTime") < limit);
+		});
+	});
+	benchmark("update, predicate", rowCount, [limit](DbSystem<usedEndianness>& system) {
+		system.updateWhen<uint32_t>("Runner", "Number", 0, Predicate::compare("Name", CompareOperator::equal, "Runner")
+														&& Predicate::compare("BestTime", CompareOperator::less, limit));
+	});
+	benchmark("delete, lambda", rowCount, [limit](DbSystem<usedEndianness>& system) {
+		system.removeWhen("Runner", [limit](const DbEntryView<usedEndianness>& entry) {
+			return (entry.getAs<std::string>("Name") == "Runner") && (entry.getAs<uint32_t>("BestTime") < limit);
+		});
+	});
+	benchmark("delete, predicate", rowCount, [limit](DbSystem<usedEndianness>& system) {
+		system.removeWhen("Runner", Predicate::compare("Name", CompareOperator::equal, "Runner")
+								 && Predicate::compare("BestTime", CompareOperator::less, limit));
+	});
+
+	std::remove(dbFileName.c_str());
+	std::remove((dbFileName + ".cat").c_str());
+	std::remove((dbFileName + ".fsm").c_str());
+	std::remove(schemaFileName.c_str());
+
+	return 0;
+}
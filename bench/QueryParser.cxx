@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <Predicate.hxx>
+#include <QueryPlan.hxx>
+#include <QueryParser.hxx>
+
+/* Microseconds to parse then plan typical statements, the time spent before the first page is read. The schemas are
+ * given to the parser directly : no database is opened.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type repetitionCount = 100000;
+
+int main()
+{
+	std::vector<DbSchema> schemas{
+		DbSchema{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}}, {"Number", {DataType::INTEGER, 32}},
+							{"Club", {DataType::INTEGER, 32}}, {"Speed", {DataType::FLOAT, 48}}}},
+		DbSchema{"Club", {{"Id", {DataType::INTEGER, 32}}, {"Name", {DataType::CHARACTER, 24}}, {"City", {DataType::CHARACTER, 24}}}}};
+
+	std::vector<std::string> statements{
+		"SELECT Name, BestTime FROM Runner WHERE BestTime < 3600",
+		"SELECT Name, count(*), avg(BestTime) FROM Runner WHERE BestTime BETWEEN 3000 AND 4000 OR Speed > 4.5 GROUP BY Name "
+		"ORDER BY count(*) DESC LIMIT 10",
+		"SELECT r.Name, c.Name FROM Runner r JOIN Club c ON r.Club = c.Id WHERE c.City = 'Lyon' AND r.BestTime < 3600",
+		"INSERT INTO Runner (Name, BestTime, Number) VALUES ('Norbert', 3400, 7), ('Ann', 3550, 8)",
+		"UPDATE Runner SET BestTime = 3300 WHERE Name = 'Norbert'",
+		"DELETE FROM Runner WHERE Number = 5"};
+
+	QueryParser<usedEndianness> parser{schemas};
+
+	std::clog << std::setw(12) << "parse (us)" << std::setw(12) << "plan (us)" << std::setw(8) << "scans" << "  statement" << std::endl;
+
+	for(const auto& statement : statements)
+	{
+		size_type tableCount = 0;
+		size_type scanCount = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_type i = 0; i < repetitionCount; ++i) tableCount += parser.parse(statement).tables.size();
+		std::chrono::duration<double, std::micro> parseTime = std::chrono::steady_clock::now() - start;
+
+		SqlStatement parsed = parser.parse(statement);
+
+		start = std::chrono::steady_clock::now();
+		for(size_type i = 0; i < repetitionCount; ++i) scanCount += QueryPlanner::plan(parsed).scans.size();
+		std::chrono::duration<double, std::micro> planTime = std::chrono::steady_clock::now() - start;
+
+		std::clog << std::setw(12) << std::fixed << std::setprecision(2) << (parseTime.count() / repetitionCount) << std::setw(12)
+				  << (planTime.count() / repetitionCount) << std::setw(8) << (scanCount / repetitionCount) << "  " << statement.substr(0, 60)
+				  << ((statement.size() > 60) ? "..." : "") << std::endl;
+
+		if(tableCount != scanCount) std::cerr << "The plan does not scan every table of the statement" << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <FileValueReader.hxx>
+#include <PositionalFile.hxx>
+
+/* Random reads of 4 KiB blocks, from 1 to 8 threads sharing a single reader, through the file stream (seek then read,
+ * serialized by a mutex, as the stream position is shared) and through the positional file (pread, no lock).
+ * The file is likely in the cache of the OS, so this mostly measures the cost of the read path itself : the stream
+ * buffer copies and the seeks on one side, a system call on the other.
+ */
+
+static constexpr size_type blockSize = 4096;
+static constexpr size_type blockCount = 1 << 14;
+static constexpr size_type readCountByThread = 1 << 17;
+
+static const std::string fileName = "RandomRead.db";
+
+void createFile()
+{
+	std::ofstream file{fileName, std::ios::binary | std::ios::trunc};
+	std::vector<char> block(blockSize);
+
+	for(size_type i = 0; i < blockCount; ++i)
+	{
+		std::fill(block.begin(), block.end(), static_cast<char>(i));
+		file.write(block.data(), block.size());
+	}
+}
+
+template<class ReadBlock>
+double benchmarkReads(size_type threadCount, ReadBlock readBlock)
+{
+	std::vector<std::thread> threads;
+	auto start = std::chrono::steady_clock::now();
+
+	for(size_type t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&readBlock, t]() {
+			std::mt19937_64 generator{t};
+			std::uniform_int_distribution<size_type> blockDistribution{0, blockCount - 1};
+			std::array<unsigned char, blockSize> block;
+			size_type sum = 0;
+
+			for(size_type i = 0; i < readCountByThread; ++i)
+			{
+				readBlock(block.data(), static_cast<std::streamoff>(blockDistribution(generator) * blockSize));
+				sum += block[0];
+			}
+
+			volatile size_type sink = sum;
+			(void)sink;
+		});
+	}
+
+	for(auto& thread : threads) thread.join();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return (threadCount * readCountByThread) / elapsed.count() / 1e6;
+}
+
+int main()
+{
+	createFile();
+
+	FileReader streamReader{fileName};
+	std::mutex streamMutex;
+	PositionalFile positionalReader{fileName, std::ios_base::in | std::ios::binary};
+
+	std::clog << blockCount << " blocks of " << blockSize << " bytes, " << readCountByThread << " reads by thread, "
+			  << std::thread::hardware_concurrency() << " hardware threads" << std::endl << std::endl;
+	std::clog << std::setw(10) << "threads" << std::setw(18) << "stream (M/s)" << std::setw(18) << "pread (M/s)" << std::endl;
+
+	for(size_type threadCount = 1; threadCount <= 8; threadCount *= 2)
+	{
+		double streamRate = benchmarkReads(threadCount, [&](unsigned char* block, std::streamoff offset) {
+			std::lock_guard<std::mutex> lock{streamMutex};
+			streamReader.read(block, blockSize, offset);
+		});
+
+		double positionalRate = benchmarkReads(threadCount, [&](unsigned char* block, std::streamoff offset) {
+			positionalReader.read(block, blockSize, offset);
+		});
+
+		std::clog << std::setw(10) << threadCount << std::setw(18) << std::fixed << std::setprecision(3) << streamRate
+				  << std::setw(18) << positionalRate << std::endl;
+	}
+
+	std::remove(fileName.c_str());
+
+	return 0;
+}
@@ -0,0 +1,172 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <ARCPageReplacePolicy.hxx>
+#include <ClockPageReplacePolicy.hxx>
+#include <LRUPageReplacePolicy.hxx>
+#include <TwoQueuePageReplacePolicy.hxx>
+
+/* Hit ratio of the replace policies on a mixed workload : point accesses to a small hot set of pages,
+ * interleaved with full scans of the whole schema (what DbIterator does).
+ * The buffer is simulated, driving the policy exactly like the BufferManager does : a pin/unpin cycle
+ * on hits, and candidate / eviction / load notifications on misses.
+ */
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static constexpr size_type frameCount = 1024;
+static constexpr size_type databasePageCount = 32768;
+static constexpr size_type hotPageCount = 512;
+static constexpr size_type accessCount = 1 << 21;
+static constexpr size_type pageRawSize = 4096;
+
+struct HitCounters
+{
+	size_type pointAccesses = 0;
+	size_type pointHits = 0;
+	size_type scanAccesses = 0;
+	size_type scanHits = 0;
+};
+
+class BufferSimulator
+{
+	public:
+	using PageIndex = DiskPage<usedEndianness>::PageIndex;
+
+	BufferSimulator(std::unique_ptr<PageReplacePolicy<usedEndianness>> policy, const std::vector<DiskPage<usedEndianness>>& frames)
+	: policy_{std::move(policy)},
+	  frames_{frames},
+	  frameOffsets_(frames.size()),
+	  usedFrameCount_{0}
+	{}
+
+	bool access(std::streamoff offset)
+	{
+		auto position = positions_.find(offset);
+		bool hit = (position != positions_.end());
+		PageIndex pageId;
+
+		if(hit)
+		{
+			pageId = position->second;
+		}
+		else if(usedFrameCount_ < frames_.size())
+		{
+			pageId = usedFrameCount_++;
+			load(pageId, offset);
+		}
+		else
+		{
+			pageId = *policy_->getCandidate();
+			policy_->pageEvicted(frames_[pageId], frameOffsets_[pageId]);
+			positions_.erase(frameOffsets_[pageId]);
+			load(pageId, offset);
+		}
+
+		policy_->use(frames_[pageId]);
+		policy_->release(frames_[pageId]);
+
+		return hit;
+	}
+
+	private:
+
+	void load(PageIndex pageId, std::streamoff offset)
+	{
+		frameOffsets_[pageId] = offset;
+		positions_[offset] = pageId;
+		policy_->pageLoaded(frames_[pageId], offset);
+	}
+
+	std::unique_ptr<PageReplacePolicy<usedEndianness>> policy_;
+	const std::vector<DiskPage<usedEndianness>>& frames_;
+	std::vector<std::streamoff> frameOffsets_;
+	std::unordered_map<std::streamoff, PageIndex> positions_;
+	size_type usedFrameCount_;
+};
+
+// One scan page every scanPeriod accesses, point accesses otherwise.
+HitCounters runWorkload(BufferSimulator& simulator, size_type scanPeriod)
+{
+	std::minstd_rand generator{42};
+	std::uniform_int_distribution<size_type> hotDistribution{0, hotPageCount - 1};
+
+	HitCounters counters;
+	size_type scanCursor = 0;
+
+	for(size_type i = 0; i < accessCount; ++i)
+	{
+		if(i % scanPeriod == 0)
+		{
+			counters.scanHits += simulator.access(static_cast<std::streamoff>(scanCursor * pageRawSize));
+			++counters.scanAccesses;
+			scanCursor = (scanCursor + 1) % databasePageCount;
+		}
+		else
+		{
+			// The hot pages are spread over the whole file, so that the scans go through them too.
+			size_type hotPage = hotDistribution(generator) * (databasePageCount / hotPageCount);
+			counters.pointHits += simulator.access(static_cast<std::streamoff>(hotPage * pageRawSize));
+			++counters.pointAccesses;
+		}
+	}
+
+	return counters;
+}
+
+double ratio(size_type hits, size_type accesses)
+{
+	return accesses ? (100.0 * hits) / accesses : 0.0;
+}
+
+template<class Policy>
+void benchmarkPolicy(const std::string& policyName, const std::vector<DiskPage<usedEndianness>>& frames, size_type scanPeriod)
+{
+	BufferSimulator simulator{std::make_unique<Policy>(frameCount), frames};
+	HitCounters counters = runWorkload(simulator, scanPeriod);
+
+	std::cout << std::setw(8) << policyName
+			  << std::setw(16) << ratio(counters.pointHits, counters.pointAccesses)
+			  << std::setw(16) << ratio(counters.scanHits, counters.scanAccesses)
+			  << std::setw(16) << ratio(counters.pointHits + counters.scanHits, counters.pointAccesses + counters.scanAccesses)
+			  << std::endl;
+}
+
+int main()
+{
+	DbSchema schema{"Bench", {{"Value", {DataType::CHARACTER, 1}}}};
+
+	std::vector<DiskPage<usedEndianness>> frames;
+	frames.reserve(frameCount);
+	for(size_type i = 0; i < frameCount; ++i)
+	{
+		frames.emplace_back(i, schema, 1);
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << frameCount << " frames, " << databasePageCount << " pages, " << hotPageCount << " hot pages" << std::endl;
+
+	for(size_type scanPeriod : {2, 4, 16})
+	{
+		std::cout << std::endl << "One scanned page every " << scanPeriod << " accesses" << std::endl;
+		std::cout << std::setw(8) << "policy" << std::setw(16) << "point hits (%)" << std::setw(16) << "scan hits (%)" << std::setw(16) << "total (%)" << std::endl;
+
+		benchmarkPolicy<LRUPageReplacePolicy<usedEndianness>>("LRU", frames, scanPeriod);
+		benchmarkPolicy<ClockPageReplacePolicy<usedEndianness>>("CLOCK", frames, scanPeriod);
+		benchmarkPolicy<TwoQueuePageReplacePolicy<usedEndianness>>("2Q", frames, scanPeriod);
+		benchmarkPolicy<ARCPageReplacePolicy<usedEndianness>>("ARC", frames, scanPeriod);
+	}
+
+	return 0;
+}
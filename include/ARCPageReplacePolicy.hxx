@@ -0,0 +1,253 @@
+#ifndef ARC_PAGE_REPLACE_POLICY_HXX
+#define ARC_PAGE_REPLACE_POLICY_HXX
+
+#include <Configuration.hxx>
+#include <FrameList.hxx>
+#include <GhostList.hxx>
+#include <Optional.hxx>
+#include <PageReplacePolicy.hxx>
+
+#include <algorithm>
+#include <vector>
+
+/* Adaptive replacement cache policy (Megiddo & Modha, "ARC: A Self-Tuning, Low Overhead Replacement Cache").
+ * The resident frames are split between T1 (pages accessed once since they were loaded) and T2 (pages accessed
+ * at least twice), both in LRU order. The offsets of the pages evicted from T1 and T2 are remembered in the
+ * ghost lists B1 and B2.
+ * The target size of T1 adapts online : a page loaded again while its ghost is in B1 means T1 was too small,
+ * one whose ghost is in B2 means T2 was too small. Candidates are then taken from T1 while it exceeds its target.
+ * Pinned frames are unlinked from their list, and every operation is O(1).
+ */
+template<Endianness endian>
+class ARCPageReplacePolicy : public PageReplacePolicy<endian>
+{
+	public:
+	using PageIndex = typename PageReplacePolicy<endian>::PageIndex;
+
+	private:
+	using FrameQueue = FrameList<PageIndex>;
+
+	enum class ListId : uint8_t
+	{
+		none,
+		recent,
+		frequent
+	};
+
+	struct FrameInfo
+	{
+		ListId list = ListId::none;
+
+		// Set when the page is loaded, so that the pin of the request which loaded it does not count as a second access.
+		bool freshlyLoaded = false;
+	};
+
+	public:
+	ARCPageReplacePolicy()
+	: ARCPageReplacePolicy(0)
+	{}
+
+	ARCPageReplacePolicy(size_type totalPageCount)
+	: nodes_(totalPageCount),
+	  frames_(totalPageCount),
+	  recent_{},
+	  frequent_{},
+	  recentGhosts_{std::max<size_type>(1, totalPageCount)},
+	  frequentGhosts_{std::max<size_type>(1, totalPageCount)},
+	  recentCount_{0},
+	  frequentCount_{0},
+	  capacity_{std::max<size_type>(1, totalPageCount)},
+	  recentTarget_{0}
+	{}
+
+	virtual void use(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+
+		FrameInfo& frame = frames_[pageId];
+
+		if(frame.freshlyLoaded)
+		{
+			frame.freshlyLoaded = false;
+		}
+		else if(frame.list == ListId::recent)
+		{
+			assign(pageId, ListId::frequent);
+		}
+	}
+
+	virtual void release(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+
+		// A frame we were not told about is treated as a new page.
+		if(frames_[pageId].list == ListId::none)
+		{
+			assign(pageId, ListId::recent);
+		}
+
+		getList(frames_[pageId].list).pushBack(nodes_, pageId);
+	}
+
+	virtual optional<PageIndex> getCandidate() override
+	{
+		bool preferRecent = (recentCount_ > recentTarget_) || frequent_.empty();
+
+		if(preferRecent && !recent_.empty()) return recent_.popFront(nodes_);
+		if(!frequent_.empty()) return frequent_.popFront(nodes_);
+		if(!recent_.empty()) return recent_.popFront(nodes_);
+
+		return {};
+	}
+
+	virtual void pageLoaded(const DiskPage<endian>& page, std::streamoff offset) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+
+		if(recentGhosts_.contains(offset))
+		{
+			// T1 was too small to keep this page : grow its target.
+			size_type delta = std::max<size_type>(1, frequentGhosts_.size() / recentGhosts_.size());
+			recentTarget_ = std::min(capacity_, recentTarget_ + delta);
+
+			recentGhosts_.erase(offset);
+			assign(pageId, ListId::frequent);
+		}
+		else if(frequentGhosts_.contains(offset))
+		{
+			// T2 was too small to keep this page : shrink the target of T1.
+			size_type delta = std::max<size_type>(1, recentGhosts_.size() / frequentGhosts_.size());
+			recentTarget_ -= std::min(recentTarget_, delta);
+
+			frequentGhosts_.erase(offset);
+			assign(pageId, ListId::frequent);
+		}
+		else
+		{
+			assign(pageId, ListId::recent);
+			trimGhosts();
+		}
+
+		frames_[pageId].freshlyLoaded = true;
+	}
+
+	virtual void pageEvicted(const DiskPage<endian>& page, std::streamoff offset) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+
+		ListId list = frames_[pageId].list;
+
+		if(list == ListId::recent) recentGhosts_.insert(offset);
+		else if(list == ListId::frequent) frequentGhosts_.insert(offset);
+
+		assign(pageId, ListId::none);
+		frames_[pageId].freshlyLoaded = false;
+	}
+
+	// The current target size of T1, the part of the buffer dedicated to the pages seen only once.
+	size_type getRecentTarget() const noexcept
+	{
+		return recentTarget_;
+	}
+
+	size_type getRecentCount() const noexcept
+	{
+		return recentCount_;
+	}
+
+	size_type getFrequentCount() const noexcept
+	{
+		return frequentCount_;
+	}
+
+	size_type getRecentGhostCount() const noexcept
+	{
+		return recentGhosts_.size();
+	}
+
+	size_type getFrequentGhostCount() const noexcept
+	{
+		return frequentGhosts_.size();
+	}
+
+	private:
+
+	void reserve(PageIndex pageId)
+	{
+		if(pageId >= nodes_.size())
+		{
+			nodes_.resize(pageId + 1);
+			frames_.resize(pageId + 1);
+		}
+	}
+
+	FrameQueue& getList(ListId id) noexcept
+	{
+		return (id == ListId::frequent) ? frequent_ : recent_;
+	}
+
+	void unlink(PageIndex pageId) noexcept
+	{
+		if(nodes_[pageId].linked)
+		{
+			getList(frames_[pageId].list).remove(nodes_, pageId);
+		}
+	}
+
+	// Moves a (non linked) frame from one list to another, keeping the resident counts up to date.
+	void assign(PageIndex pageId, ListId newId) noexcept
+	{
+		ListId& id = frames_[pageId].list;
+
+		if(id == ListId::recent) --recentCount_;
+		else if(id == ListId::frequent) --frequentCount_;
+
+		if(newId == ListId::recent) ++recentCount_;
+		else if(newId == ListId::frequent) ++frequentCount_;
+
+		id = newId;
+	}
+
+	// Keeps |T1| + |B1| <= c, and the whole directory under 2c entries.
+	void trimGhosts()
+	{
+		while(!recentGhosts_.empty() && (recentCount_ + recentGhosts_.size() > capacity_))
+		{
+			recentGhosts_.popOldest();
+		}
+
+		while(!frequentGhosts_.empty()
+		   && (recentCount_ + frequentCount_ + recentGhosts_.size() + frequentGhosts_.size() > 2 * capacity_))
+		{
+			frequentGhosts_.popOldest();
+		}
+	}
+
+	typename FrameQueue::NodeArray nodes_;
+	std::vector<FrameInfo> frames_;
+	FrameQueue recent_;
+	FrameQueue frequent_;
+	GhostList recentGhosts_;
+	GhostList frequentGhosts_;
+
+	// Resident frames of each list, pinned ones included.
+	size_type recentCount_;
+	size_type frequentCount_;
+
+	size_type capacity_;
+	size_type recentTarget_;
+};
+
+#endif // ARC_PAGE_REPLACE_POLICY_HXX
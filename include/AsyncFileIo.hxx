@@ -0,0 +1,94 @@
+#ifndef ASYNC_FILE_IO_HXX
+#define ASYNC_FILE_IO_HXX
+
+#include <Configuration.hxx>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <sys/uio.h>
+
+#if (OS == LINUX) && defined(__has_include)
+#	if __has_include(<linux/io_uring.h>)
+#		define HAS_IO_URING
+#	endif
+#endif
+
+enum class AsyncIoEngine : flag_type
+{
+	automatic,
+	ioUring,
+	threadPool
+};
+
+// What became of a request : the bytes transferred, or minus the error number.
+struct AsyncIoCompletion
+{
+	uint64_t tag;
+	int64_t result;
+};
+
+/* Reads and writes a file without blocking the thread which asks for them : the requests are prepared, handed to the
+ * system all at once by submit, and their completions are collected later, by poll or wait, in any order, identified
+ * by the tag given with the request.
+ * The requests go through io_uring when the system has it, so a single thread keeps up to queueDepth requests in
+ * flight with a system call by batch. Otherwise, or if asked to, a pool of threads runs them with pread and pwrite.
+ * A transfer may be short, like with pread and pwrite : the caller checks the result.
+ * The buffers, and the iovec arrays, must stay alive, and unchanged for the writes, until the request completes.
+ * Not thread safe, an engine is meant to be driven by a single thread.
+ */
+class AsyncFileIo
+{
+public:
+	// Defined with the implementation.
+	class Engine;
+	struct Request;
+
+	AsyncFileIo(int descriptor, size_type queueDepth, AsyncIoEngine engine = AsyncIoEngine::automatic);
+	~AsyncFileIo();
+
+	AsyncFileIo(const AsyncFileIo&) = delete;
+	AsyncFileIo& operator=(const AsyncFileIo&) = delete;
+
+	// False if queueDepth requests are already prepared or in flight, the caller must collect some completions first.
+	bool prepareRead(uint8_t* buffer, size_type size, std::streamoff offset, uint64_t tag);
+	bool prepareWrite(const uint8_t* buffer, size_type size, std::streamoff offset, uint64_t tag);
+	bool prepareWriteVector(const iovec* buffers, size_type count, std::streamoff offset, uint64_t tag);
+
+	// Hands the prepared requests to the system. Returns how many.
+	size_type submit();
+
+	// Appends the completions already there to completions, without waiting. Returns how many.
+	size_type poll(std::vector<AsyncIoCompletion>& completions);
+
+	// Same, but waits until at least minCount requests completed (or none is left in flight).
+	size_type wait(std::vector<AsyncIoCompletion>& completions, size_type minCount = 1);
+
+	// The requests prepared or submitted, and not collected yet.
+	size_type getPendingCount() const noexcept;
+
+	size_type getQueueDepth() const noexcept
+	{
+		return queueDepth_;
+	}
+
+	bool usesIoUring() const noexcept
+	{
+		return usesIoUring_;
+	}
+
+private:
+	bool prepare(const Request& request);
+
+	size_type queueDepth_;
+	bool usesIoUring_;
+	std::unique_ptr<Engine> engine_;
+	size_type pendingCount_;
+};
+
+#endif
+
+#endif // ASYNC_FILE_IO_HXX
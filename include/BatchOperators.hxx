@@ -0,0 +1,1032 @@
+#ifndef BATCH_OPERATORS_HXX
+#define BATCH_OPERATORS_HXX
+
+#include <Configuration.hxx>
+#include <ColumnBatch.hxx>
+#include <CsvRowEncoder.hxx>
+#include <Predicate.hxx>
+#include <Schema.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Details
+{
+
+inline size_type findColumn(const std::vector<ColumnDescriptor>& columns, const std::string& name)
+{
+	auto it = std::find_if(columns.begin(), columns.end(), [&name](const ColumnDescriptor& column) { return column.name == name; });
+
+	if(it == columns.end()) throw QueryException("the column " + name + " is not read by the query");
+
+	return it - columns.begin();
+}
+
+}
+
+/* Narrows the selection of the batches of its input to the rows matching a predicate. Every comparison is a loop over
+ * a whole column, writing the rows kept to a selection vector without branching : a conjunction narrows the selection
+ * of its previous operand, a disjunction merges the selections of its operands.
+ * The fields of the predicate must be columns of the input.
+ */
+template<Endianness endian>
+class BatchFilter : public BatchOperator
+{
+public:
+	BatchFilter(std::unique_ptr<BatchOperator> input, const Predicate& predicate)
+	: input_{std::move(input)}
+	{
+		bind(predicate);
+		selection_.reserve(ColumnBatch::capacity);
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return input_->getColumns();
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!input_->next(batch)) return false;
+
+		selection_.resize(ColumnBatch::capacity);
+
+		size_type count = evaluate(0, batch, batch.isFiltered ? batch.selection.data() : nullptr, batch.getSelectedCount(), selection_.data());
+
+		selection_.resize(count);
+		std::swap(selection_, batch.selection);
+		batch.isFiltered = true;
+
+		return true;
+	}
+
+private:
+	struct Node
+	{
+		Predicate::Kind kind;
+		// The node after the operands of this one.
+		size_type end;
+		size_type column;
+		ColumnKind columnKind;
+		size_type size;
+		CompareOperator op;
+		uint64_t integer;
+		double floating;
+		std::vector<uint8_t> bytes;
+		// The selections of the operands of a disjunction, and their union.
+		std::vector<uint32_t> operandSelection;
+		std::vector<uint32_t> unionSelection;
+		std::vector<uint32_t> mergedSelection;
+	};
+
+	void bind(const Predicate& predicate)
+	{
+		size_type index = nodes_.size();
+		nodes_.push_back(Node{predicate.kind_, 0, 0, ColumnKind::bytes, 0, predicate.operator_, 0, 0, {}, {}, {}, {}});
+
+		if(predicate.kind_ == Predicate::Kind::comparison)
+		{
+			bindComparison(nodes_[index], predicate);
+		}
+		else
+		{
+			if(predicate.kind_ == Predicate::Kind::disjunction)
+			{
+				nodes_[index].operandSelection.resize(ColumnBatch::capacity);
+				nodes_[index].unionSelection.resize(ColumnBatch::capacity);
+				nodes_[index].mergedSelection.resize(ColumnBatch::capacity);
+			}
+
+			for(const Predicate& operand : predicate.operands_) bind(operand);
+		}
+
+		nodes_[index].end = nodes_.size();
+	}
+
+	// The constant is written as the field, then decoded as the column.
+	void bindComparison(Node& node, const Predicate& predicate)
+	{
+		const std::vector<ColumnDescriptor>& columns = input_->getColumns();
+
+		node.column = Details::findColumn(columns, predicate.fieldName_);
+
+		const ColumnDescriptor& column = columns[node.column];
+		std::vector<uint8_t> field(column.size);
+
+		node.columnKind = column.kind;
+		node.size = column.size;
+
+		try
+		{
+			DbSchema noSchema{"", std::vector<FieldDescriptor>{}};
+			CsvRowEncoder<endian> encoder{noSchema};
+			encoder.encodeField(FieldRef{0, 0, column.size, column.type},
+								{predicate.constant_.data(), predicate.constant_.data() + predicate.constant_.size()}, field.data());
+		}
+		catch(const CsvImportException&)
+		{
+			throw PredicateException("'" + predicate.constant_ + "' can not be compared to the field " + predicate.fieldName_);
+		}
+
+		ColumnVector constant;
+		constant.integers.resize(1);
+		constant.floats.resize(1);
+		constant.bytes.resize(column.size);
+
+		const uint8_t* row = field.data();
+		ColumnDecoder<endian>::decode(column, 0, &row, 1, constant);
+
+		node.integer = constant.integers[0];
+		node.floating = constant.floats[0];
+		node.bytes = std::move(constant.bytes);
+	}
+
+	// Writes the rows of in matching the node to out, all the rows of the batch if in is null. out may be in.
+	size_type evaluate(size_type index, const ColumnBatch& batch, const uint32_t* in, size_type count, uint32_t* out)
+	{
+		Node& node = nodes_[index];
+
+		if(node.kind == Predicate::Kind::comparison) return compare(node, batch.columns[node.column], in, count, out);
+
+		if(node.kind == Predicate::Kind::conjunction)
+		{
+			// Without any operand, every row is kept.
+			if(index + 1 == node.end)
+			{
+				for(size_type i = 0; i < count; ++i) out[i] = in ? in[i] : static_cast<uint32_t>(i);
+
+				return count;
+			}
+
+			for(size_type operand = index + 1; operand < node.end; operand = nodes_[operand].end)
+			{
+				count = evaluate(operand, batch, in, count, out);
+				in = out;
+			}
+
+			return count;
+		}
+
+		// The operands all read in, which may be out : the union is only written to out at the end.
+		size_type unionCount = 0;
+
+		for(size_type operand = index + 1; operand < node.end; operand = nodes_[operand].end)
+		{
+			size_type operandCount = evaluate(operand, batch, in, count, node.operandSelection.data());
+			uint32_t* mergedEnd = std::set_union(node.unionSelection.data(), node.unionSelection.data() + unionCount,
+												 node.operandSelection.data(), node.operandSelection.data() + operandCount,
+												 node.mergedSelection.data());
+
+			unionCount = mergedEnd - node.mergedSelection.data();
+			std::swap(node.unionSelection, node.mergedSelection);
+		}
+
+		std::copy(node.unionSelection.data(), node.unionSelection.data() + unionCount, out);
+
+		return unionCount;
+	}
+
+	static size_type compare(const Node& node, const ColumnVector& column, const uint32_t* in, size_type count, uint32_t* out)
+	{
+		if(node.columnKind == ColumnKind::unsignedInteger)
+		{
+			const uint64_t* values = column.integers.data();
+			return compareWith(node.op, [values](uint32_t row) { return values[row]; }, node.integer, in, count, out);
+		}
+
+		if(node.columnKind == ColumnKind::floatingPoint)
+		{
+			const double* values = column.floats.data();
+			return compareWith(node.op, [values](uint32_t row) { return values[row]; }, node.floating, in, count, out);
+		}
+
+		const uint8_t* values = column.bytes.data();
+		const uint8_t* constant = node.bytes.data();
+		size_type size = node.size;
+
+		return compareWith(node.op, [=](uint32_t row) { return std::memcmp(values + row * size, constant, size); }, 0, in, count, out);
+	}
+
+	template<class Value, class T>
+	static size_type compareWith(CompareOperator op, Value value, T constant, const uint32_t* in, size_type count, uint32_t* out)
+	{
+		switch(op)
+		{
+			case CompareOperator::equal:
+				return select([=](uint32_t row) { return value(row) == constant; }, in, count, out);
+			case CompareOperator::notEqual:
+				return select([=](uint32_t row) { return value(row) != constant; }, in, count, out);
+			case CompareOperator::less:
+				return select([=](uint32_t row) { return value(row) < constant; }, in, count, out);
+			case CompareOperator::lessOrEqual:
+				return select([=](uint32_t row) { return value(row) <= constant; }, in, count, out);
+			case CompareOperator::greater:
+				return select([=](uint32_t row) { return value(row) > constant; }, in, count, out);
+			default:
+				return select([=](uint32_t row) { return value(row) >= constant; }, in, count, out);
+		}
+	}
+
+	// Every row is written, and kept only if it matches : no branch to mispredict.
+	template<class Matches>
+	static size_type select(Matches matches, const uint32_t* in, size_type count, uint32_t* out) noexcept
+	{
+		size_type selected = 0;
+
+		if(in)
+		{
+			for(size_type i = 0; i < count; ++i)
+			{
+				uint32_t row = in[i];
+				out[selected] = row;
+				selected += matches(row);
+			}
+		}
+		else
+		{
+			for(uint32_t row = 0; row < count; ++row)
+			{
+				out[selected] = row;
+				selected += matches(row);
+			}
+		}
+
+		return selected;
+	}
+
+	std::unique_ptr<BatchOperator> input_;
+	std::vector<Node> nodes_;
+	std::vector<uint32_t> selection_;
+};
+
+// Keeps some of the columns of its input, in the given order. The values are not copied, only their buffers swapped.
+class BatchProject : public BatchOperator
+{
+public:
+	BatchProject(std::unique_ptr<BatchOperator> input, const std::vector<std::string>& columnNames)
+	: input_{std::move(input)}
+	{
+		for(const auto& name : columnNames)
+		{
+			indices_.push_back(Details::findColumn(input_->getColumns(), name));
+			columns_.push_back(input_->getColumns()[indices_.back()]);
+		}
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return columns_;
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!input_->next(inputBatch_)) return false;
+
+		batch.rowCount = inputBatch_.rowCount;
+		batch.isFiltered = inputBatch_.isFiltered;
+		std::swap(batch.selection, inputBatch_.selection);
+		batch.columns.resize(columns_.size());
+
+		for(size_type i = 0; i < indices_.size(); ++i)
+		{
+			// A column kept twice is copied from its first place in the output, its buffer being swapped there already.
+			size_type first = std::find(indices_.begin(), indices_.end(), indices_[i]) - indices_.begin();
+
+			if(first < i) batch.columns[i] = batch.columns[first];
+			else std::swap(batch.columns[i], inputBatch_.columns[indices_[i]]);
+		}
+
+		return true;
+	}
+
+private:
+	std::unique_ptr<BatchOperator> input_;
+	std::vector<size_type> indices_;
+	std::vector<ColumnDescriptor> columns_;
+	ColumnBatch inputBatch_;
+};
+
+enum class AggregateFunction : flag_type
+{
+	count,
+	sum,
+	minimum,
+	maximum,
+	average
+};
+
+struct Aggregate
+{
+	AggregateFunction function;
+	// Empty to count the rows.
+	std::string fieldName;
+};
+
+/* Groups the rows of its input by the values of some columns, and computes aggregates of every group. Without any
+ * group column, the whole input is a single group, and the aggregates are loops over the columns of the batches.
+ * The output columns are the group columns, then the aggregates : counts and sums of integers as integers, the
+ * averages and the sums of floating point numbers as doubles, the minimums and maximums as the column. The groups come
+ * in the order they are first met, once the whole input is read.
+ */
+class BatchAggregate : public BatchOperator
+{
+public:
+	BatchAggregate(std::unique_ptr<BatchOperator> input, const std::vector<std::string>& groupColumnNames, std::vector<Aggregate> aggregates)
+	: input_{std::move(input)},
+	  aggregates_{std::move(aggregates)},
+	  keySize_{0},
+	  emittedGroupCount_{0},
+	  consumed_{false}
+	{
+		const std::vector<ColumnDescriptor>& inputColumns = input_->getColumns();
+
+		for(const auto& name : groupColumnNames)
+		{
+			groupIndices_.push_back(Details::findColumn(inputColumns, name));
+			columns_.push_back(inputColumns[groupIndices_.back()]);
+			keySize_ += getKeyPartSize(columns_.back());
+		}
+
+		for(const auto& aggregate : aggregates_)
+		{
+			bool countsRows = (aggregate.function == AggregateFunction::count) && aggregate.fieldName.empty();
+			size_type index = countsRows ? 0 : Details::findColumn(inputColumns, aggregate.fieldName);
+			ColumnKind kind = countsRows ? ColumnKind::unsignedInteger : inputColumns[index].kind;
+
+			if((kind == ColumnKind::bytes) && (aggregate.function != AggregateFunction::count))
+			{
+				throw QueryException("only the numbers can be summed, averaged, or compared, not " + aggregate.fieldName);
+			}
+
+			aggregateIndices_.push_back(index);
+			aggregateKinds_.push_back(kind);
+			columns_.push_back(describe(aggregate, countsRows ? ColumnDescriptor{"", DataType::INTEGER, sizeof(uint64_t), kind} : inputColumns[index]));
+		}
+
+		// A single group, even for an empty input.
+		if(groupIndices_.empty()) findGroup(std::string{});
+	}
+
+	// The name of the output column of an aggregate, as "sum(BestTime)", or "count(*)".
+	static std::string getColumnName(const Aggregate& aggregate)
+	{
+		static const char* const names[] = {"count", "sum", "min", "max", "avg"};
+
+		return std::string{names[static_cast<size_type>(aggregate.function)]} + "(" + (aggregate.fieldName.empty() ? "*" : aggregate.fieldName) + ")";
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return columns_;
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!consumed_)
+		{
+			while(input_->next(inputBatch_)) consume(inputBatch_);
+			consumed_ = true;
+		}
+
+		if(emittedGroupCount_ == groupKeys_.size()) return false;
+
+		batch.reset(columns_);
+		batch.rowCount = std::min<size_type>(groupKeys_.size() - emittedGroupCount_, size_type{ColumnBatch::capacity});
+
+		for(size_type row = 0; row < batch.rowCount; ++row) emitGroup(batch, row, emittedGroupCount_ + row);
+
+		emittedGroupCount_ += batch.rowCount;
+
+		return true;
+	}
+
+private:
+	struct State
+	{
+		uint64_t count;
+		uint64_t integer;
+		double floating;
+	};
+
+	static ColumnDescriptor describe(const Aggregate& aggregate, const ColumnDescriptor& column)
+	{
+		std::string name = getColumnName(aggregate);
+
+		bool isFloating = (aggregate.function == AggregateFunction::average)
+					   || ((aggregate.function != AggregateFunction::count) && (column.kind == ColumnKind::floatingPoint));
+
+		if((aggregate.function == AggregateFunction::minimum) || (aggregate.function == AggregateFunction::maximum))
+		{
+			return {name, column.type, column.size, column.kind};
+		}
+
+		return isFloating ? ColumnDescriptor{name, DataType::FLOAT, sizeof(double), ColumnKind::floatingPoint}
+						  : ColumnDescriptor{name, DataType::INTEGER, sizeof(uint64_t), ColumnKind::unsignedInteger};
+	}
+
+	static size_type getKeyPartSize(const ColumnDescriptor& column) noexcept
+	{
+		return (column.kind == ColumnKind::bytes) ? column.size : sizeof(uint64_t);
+	}
+
+	size_type findGroup(const std::string& key)
+	{
+		// Looked up first, as emplace would allocate a node for every row.
+		auto group = groups_.find(key);
+		if(group != groups_.end()) return group->second;
+
+		group = groups_.emplace(key, groupKeys_.size()).first;
+		groupKeys_.push_back(&group->first);
+		states_.resize(states_.size() + aggregates_.size(), State{0, 0, 0});
+
+		return group->second;
+	}
+
+	void consume(const ColumnBatch& batch)
+	{
+		size_type count = batch.getSelectedCount();
+		const uint32_t* selection = batch.isFiltered ? batch.selection.data() : nullptr;
+
+		if(groupIndices_.empty())
+		{
+			for(size_type i = 0; i < aggregates_.size(); ++i) accumulate(i, states_[i], batch, selection, count);
+
+			return;
+		}
+
+		groupIds_.resize(count);
+
+		for(size_type i = 0; i < count; ++i)
+		{
+			buildKey(batch, batch.getSelectedRow(i));
+			groupIds_[i] = findGroup(key_);
+		}
+
+		for(size_type i = 0; i < aggregates_.size(); ++i)
+		{
+			for(size_type j = 0; j < count; ++j)
+			{
+				update(i, states_[groupIds_[j] * aggregates_.size() + i], batch, batch.getSelectedRow(j));
+			}
+		}
+	}
+
+	// The aggregate of a single group, a loop by column the compiler can vectorize.
+	void accumulate(size_type index, State& state, const ColumnBatch& batch, const uint32_t* selection, size_type count)
+	{
+		AggregateFunction function = aggregates_[index].function;
+
+		if((function == AggregateFunction::count) || (count == 0))
+		{
+			state.count += count;
+			return;
+		}
+
+		if(aggregateKinds_[index] == ColumnKind::unsignedInteger)
+		{
+			const uint64_t* values = batch.columns[aggregateIndices_[index]].integers.data();
+			state.integer = fold(function, state.count, state.integer, values, selection, count);
+		}
+		else
+		{
+			const double* values = batch.columns[aggregateIndices_[index]].floats.data();
+			state.floating = fold(function, state.count, state.floating, values, selection, count);
+		}
+
+		state.count += count;
+	}
+
+	template<class T>
+	static T fold(AggregateFunction function, uint64_t foldedCount, T folded, const T* values, const uint32_t* selection, size_type count) noexcept
+	{
+		if(function == AggregateFunction::minimum)
+		{
+			T result = (foldedCount > 0) ? folded : value(values, selection, 0);
+			for(size_type i = 0; i < count; ++i) result = std::min(result, value(values, selection, i));
+			return result;
+		}
+
+		if(function == AggregateFunction::maximum)
+		{
+			T result = (foldedCount > 0) ? folded : value(values, selection, 0);
+			for(size_type i = 0; i < count; ++i) result = std::max(result, value(values, selection, i));
+			return result;
+		}
+
+		T sum = 0;
+
+		if(selection)
+		{
+			for(size_type i = 0; i < count; ++i) sum += values[selection[i]];
+		}
+		else
+		{
+			for(size_type i = 0; i < count; ++i) sum += values[i];
+		}
+
+		return folded + sum;
+	}
+
+	template<class T>
+	static T value(const T* values, const uint32_t* selection, size_type index) noexcept
+	{
+		return selection ? values[selection[index]] : values[index];
+	}
+
+	void update(size_type index, State& state, const ColumnBatch& batch, size_type row) noexcept
+	{
+		AggregateFunction function = aggregates_[index].function;
+
+		if(function != AggregateFunction::count)
+		{
+			if(aggregateKinds_[index] == ColumnKind::unsignedInteger)
+			{
+				uint64_t value = batch.columns[aggregateIndices_[index]].integers[row];
+				state.integer = combine(function, state.count, state.integer, value);
+			}
+			else
+			{
+				double value = batch.columns[aggregateIndices_[index]].floats[row];
+				state.floating = combine(function, state.count, state.floating, value);
+			}
+		}
+
+		++state.count;
+	}
+
+	template<class T>
+	static T combine(AggregateFunction function, uint64_t count, T folded, T value) noexcept
+	{
+		if(count == 0) return value;
+		if(function == AggregateFunction::minimum) return std::min(folded, value);
+		if(function == AggregateFunction::maximum) return std::max(folded, value);
+
+		return folded + value;
+	}
+
+	void buildKey(const ColumnBatch& batch, size_type row)
+	{
+		key_.resize(keySize_);
+		char* part = &key_[0];
+
+		for(size_type i = 0; i < groupIndices_.size(); ++i)
+		{
+			const ColumnDescriptor& column = columns_[i];
+			const ColumnVector& values = batch.columns[groupIndices_[i]];
+
+			if(column.kind == ColumnKind::unsignedInteger) std::memcpy(part, &values.integers[row], sizeof(uint64_t));
+			else if(column.kind == ColumnKind::floatingPoint) std::memcpy(part, &values.floats[row], sizeof(double));
+			else std::memcpy(part, &values.bytes[row * column.size], column.size);
+
+			part += getKeyPartSize(column);
+		}
+	}
+
+	void emitGroup(ColumnBatch& batch, size_type row, size_type group) const
+	{
+		const char* part = groupKeys_[group]->data();
+
+		for(size_type i = 0; i < groupIndices_.size(); ++i)
+		{
+			const ColumnDescriptor& column = columns_[i];
+			ColumnVector& values = batch.columns[i];
+
+			if(column.kind == ColumnKind::unsignedInteger) std::memcpy(&values.integers[row], part, sizeof(uint64_t));
+			else if(column.kind == ColumnKind::floatingPoint) std::memcpy(&values.floats[row], part, sizeof(double));
+			else std::memcpy(&values.bytes[row * column.size], part, column.size);
+
+			part += getKeyPartSize(column);
+		}
+
+		for(size_type i = 0; i < aggregates_.size(); ++i)
+		{
+			const State& state = states_[group * aggregates_.size() + i];
+			ColumnVector& values = batch.columns[groupIndices_.size() + i];
+			bool isIntegerInput = (aggregateKinds_[i] == ColumnKind::unsignedInteger);
+
+			switch(aggregates_[i].function)
+			{
+				case AggregateFunction::count:
+					values.integers[row] = state.count;
+					break;
+				case AggregateFunction::average:
+					values.floats[row] = (state.count == 0) ? 0 : (isIntegerInput ? static_cast<double>(state.integer) : state.floating) / state.count;
+					break;
+				default:
+					if(isIntegerInput) values.integers[row] = state.integer;
+					else values.floats[row] = state.floating;
+			}
+		}
+	}
+
+	std::unique_ptr<BatchOperator> input_;
+	std::vector<Aggregate> aggregates_;
+	std::vector<ColumnDescriptor> columns_;
+	std::vector<size_type> groupIndices_;
+	std::vector<size_type> aggregateIndices_;
+	std::vector<ColumnKind> aggregateKinds_;
+	size_type keySize_;
+
+	// The groups, by the bytes of their values, numbered in the order they are met.
+	std::unordered_map<std::string, size_type> groups_;
+	std::vector<const std::string*> groupKeys_;
+	std::vector<State> states_;
+	std::vector<uint32_t> groupIds_;
+	std::string key_;
+
+	ColumnBatch inputBatch_;
+	size_type emittedGroupCount_;
+	bool consumed_;
+};
+
+namespace Details
+{
+
+/* The rows of a whole input, column by column, for the operators which need all of it before their first batch : a
+ * sort, or the side of a join held in memory.
+ */
+class ColumnStore
+{
+public:
+	explicit ColumnStore(const std::vector<ColumnDescriptor>& columns)
+	: columns_(columns),
+	  values_(columns.size()),
+	  rowCount_{0}
+	{}
+
+	size_type getRowCount() const noexcept
+	{
+		return rowCount_;
+	}
+
+	const ColumnVector& getColumn(size_type index) const noexcept
+	{
+		return values_[index];
+	}
+
+	void append(const ColumnBatch& batch, size_type row)
+	{
+		for(size_type i = 0; i < columns_.size(); ++i)
+		{
+			const ColumnVector& from = batch.columns[i];
+			ColumnVector& to = values_[i];
+
+			if(columns_[i].kind == ColumnKind::unsignedInteger) to.integers.push_back(from.integers[row]);
+			else if(columns_[i].kind == ColumnKind::floatingPoint) to.floats.push_back(from.floats[row]);
+			else to.bytes.insert(to.bytes.end(), &from.bytes[row * columns_[i].size], &from.bytes[row * columns_[i].size] + columns_[i].size);
+		}
+
+		++rowCount_;
+	}
+
+	// Writes the stored row to the row of the batch, its columns from firstColumn on.
+	void copyTo(size_type storedRow, ColumnBatch& batch, size_type row, size_type firstColumn = 0) const noexcept
+	{
+		for(size_type i = 0; i < columns_.size(); ++i)
+		{
+			copyValue(columns_[i], values_[i], storedRow, batch.columns[firstColumn + i], row);
+		}
+	}
+
+	static void copyValue(const ColumnDescriptor& column, const ColumnVector& from, size_type fromRow, ColumnVector& to, size_type toRow) noexcept
+	{
+		if(column.kind == ColumnKind::unsignedInteger) to.integers[toRow] = from.integers[fromRow];
+		else if(column.kind == ColumnKind::floatingPoint) to.floats[toRow] = from.floats[fromRow];
+		else std::memcpy(&to.bytes[toRow * column.size], &from.bytes[fromRow * column.size], column.size);
+	}
+
+private:
+	std::vector<ColumnDescriptor> columns_;
+	std::vector<ColumnVector> values_;
+	size_type rowCount_;
+};
+
+}
+
+struct SortKey
+{
+	std::string columnName;
+	bool isDescending;
+};
+
+/* Sorts the whole input by some columns, the first deciding first : the integers and floating point numbers by value
+ * (the NaN last), the strings byte by byte. The rows equal on all the columns keep their order.
+ * With a limit, only the first rows are sorted.
+ */
+class BatchSort : public BatchOperator
+{
+public:
+	BatchSort(std::unique_ptr<BatchOperator> input, const std::vector<SortKey>& keys, optional<size_type> limit = {})
+	: input_{std::move(input)},
+	  store_{input_->getColumns()},
+	  limit_{limit},
+	  emittedRowCount_{0},
+	  consumed_{false}
+	{
+		for(const auto& key : keys)
+		{
+			keyIndices_.push_back(Details::findColumn(input_->getColumns(), key.columnName));
+			isDescending_.push_back(key.isDescending);
+		}
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return input_->getColumns();
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!consumed_)
+		{
+			consume();
+			consumed_ = true;
+		}
+
+		if(emittedRowCount_ == order_.size()) return false;
+
+		batch.reset(getColumns());
+		batch.rowCount = std::min<size_type>(order_.size() - emittedRowCount_, size_type{ColumnBatch::capacity});
+
+		for(size_type row = 0; row < batch.rowCount; ++row) store_.copyTo(order_[emittedRowCount_ + row], batch, row);
+
+		emittedRowCount_ += batch.rowCount;
+
+		return true;
+	}
+
+private:
+	void consume()
+	{
+		while(input_->next(inputBatch_))
+		{
+			for(size_type i = 0; i < inputBatch_.getSelectedCount(); ++i) store_.append(inputBatch_, inputBatch_.getSelectedRow(i));
+		}
+
+		order_.resize(store_.getRowCount());
+		for(size_type i = 0; i < order_.size(); ++i) order_[i] = i;
+
+		// The row index breaks the ties, for the partial sort to be stable too.
+		auto isBefore = [this](size_type lhs, size_type rhs) {
+			int comparison = compareRows(lhs, rhs);
+			return (comparison < 0) || ((comparison == 0) && (lhs < rhs));
+		};
+
+		if(limit_ && (*limit_ < order_.size()))
+		{
+			std::partial_sort(order_.begin(), order_.begin() + *limit_, order_.end(), isBefore);
+			order_.resize(*limit_);
+		}
+		else
+		{
+			std::sort(order_.begin(), order_.end(), isBefore);
+		}
+	}
+
+	int compareRows(size_type lhs, size_type rhs) const noexcept
+	{
+		for(size_type i = 0; i < keyIndices_.size(); ++i)
+		{
+			const ColumnDescriptor& column = getColumns()[keyIndices_[i]];
+			const ColumnVector& values = store_.getColumn(keyIndices_[i]);
+			int comparison = 0;
+
+			if(column.kind == ColumnKind::unsignedInteger)
+			{
+				comparison = (values.integers[lhs] > values.integers[rhs]) - (values.integers[lhs] < values.integers[rhs]);
+			}
+			else if(column.kind == ColumnKind::floatingPoint)
+			{
+				double left = values.floats[lhs];
+				double right = values.floats[rhs];
+				comparison = (left < right) ? -1 : ((right < left) ? 1 : (std::isnan(left) - std::isnan(right)));
+			}
+			else
+			{
+				comparison = std::memcmp(&values.bytes[lhs * column.size], &values.bytes[rhs * column.size], column.size);
+			}
+
+			if(comparison != 0) return isDescending_[i] ? -comparison : comparison;
+		}
+
+		return 0;
+	}
+
+	std::unique_ptr<BatchOperator> input_;
+	std::vector<size_type> keyIndices_;
+	std::vector<bool> isDescending_;
+	Details::ColumnStore store_;
+	optional<size_type> limit_;
+	std::vector<size_type> order_;
+
+	ColumnBatch inputBatch_;
+	size_type emittedRowCount_;
+	bool consumed_;
+};
+
+// Stops after the first rows of its input.
+class BatchLimit : public BatchOperator
+{
+public:
+	BatchLimit(std::unique_ptr<BatchOperator> input, size_type limit)
+	: input_{std::move(input)},
+	  remainingRowCount_{limit}
+	{}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return input_->getColumns();
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if((remainingRowCount_ == 0) || !input_->next(batch)) return false;
+
+		size_type count = std::min(batch.getSelectedCount(), remainingRowCount_);
+
+		if(batch.isFiltered) batch.selection.resize(count);
+		else batch.rowCount = count;
+
+		remainingRowCount_ -= count;
+
+		return true;
+	}
+
+private:
+	std::unique_ptr<BatchOperator> input_;
+	size_type remainingRowCount_;
+};
+
+/* The inner join of two inputs on the equality of a column of each : one side is read whole and hashed by its column,
+ * the rows of the other then look their matches up, batch after batch. The output columns are the columns of the left
+ * input, then those of the right one, whichever is hashed (the smaller one, ideally).
+ * The columns must be both integers, both floating point numbers, or both strings, the null characters ending a string
+ * being ignored.
+ */
+class BatchJoin : public BatchOperator
+{
+public:
+	BatchJoin(std::unique_ptr<BatchOperator> left, std::unique_ptr<BatchOperator> right, const std::string& leftColumnName,
+			  const std::string& rightColumnName, bool isLeftHashed = false)
+	: isLeftHashed_{isLeftHashed},
+	  built_{isLeftHashed ? std::move(left) : std::move(right)},
+	  probe_{isLeftHashed ? std::move(right) : std::move(left)},
+	  store_{built_->getColumns()},
+	  builtKey_{Details::findColumn(built_->getColumns(), isLeftHashed ? leftColumnName : rightColumnName)},
+	  probeKey_{Details::findColumn(probe_->getColumns(), isLeftHashed ? rightColumnName : leftColumnName)},
+	  probeRow_{0},
+	  matchIndex_{0},
+	  matches_{nullptr},
+	  isBuilt_{false},
+	  isProbed_{false}
+	{
+		const ColumnDescriptor& builtColumn = built_->getColumns()[builtKey_];
+		const ColumnDescriptor& probeColumn = probe_->getColumns()[probeKey_];
+
+		// The keys are the raw values, an integer and a floating point number of the same value would not match.
+		if(builtColumn.kind != probeColumn.kind)
+		{
+			throw QueryException("the columns " + leftColumnName + " and " + rightColumnName + " can not be compared");
+		}
+
+		const std::vector<ColumnDescriptor>& leftColumns = isLeftHashed ? built_->getColumns() : probe_->getColumns();
+		const std::vector<ColumnDescriptor>& rightColumns = isLeftHashed ? probe_->getColumns() : built_->getColumns();
+
+		columns_ = leftColumns;
+		columns_.insert(columns_.end(), rightColumns.begin(), rightColumns.end());
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return columns_;
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!isBuilt_)
+		{
+			build();
+			isBuilt_ = true;
+		}
+
+		batch.reset(columns_);
+
+		size_type builtFirstColumn = isLeftHashed_ ? 0 : probe_->getColumns().size();
+		size_type probeFirstColumn = isLeftHashed_ ? built_->getColumns().size() : 0;
+
+		while(!isProbed_ && (batch.rowCount < ColumnBatch::capacity))
+		{
+			if(!matches_)
+			{
+				if(probeRow_ == probeBatch_.getSelectedCount())
+				{
+					isProbed_ = !probe_->next(probeBatch_);
+					if(isProbed_) break;
+
+					probeRow_ = 0;
+					continue;
+				}
+
+				makeKey(probe_->getColumns()[probeKey_], probeBatch_.columns[probeKey_], probeBatch_.getSelectedRow(probeRow_));
+
+				auto match = hashTable_.find(key_);
+				matches_ = (match != hashTable_.end()) ? &match->second : nullptr;
+				matchIndex_ = 0;
+
+				if(!matches_)
+				{
+					++probeRow_;
+					continue;
+				}
+			}
+
+			// The row of the probe side, with each of its matches.
+			size_type row = probeBatch_.getSelectedRow(probeRow_);
+
+			for(; (matchIndex_ < matches_->size()) && (batch.rowCount < ColumnBatch::capacity); ++matchIndex_, ++batch.rowCount)
+			{
+				store_.copyTo((*matches_)[matchIndex_], batch, batch.rowCount, builtFirstColumn);
+
+				for(size_type i = 0; i < probe_->getColumns().size(); ++i)
+				{
+					Details::ColumnStore::copyValue(probe_->getColumns()[i], probeBatch_.columns[i], row, batch.columns[probeFirstColumn + i], batch.rowCount);
+				}
+			}
+
+			if(matchIndex_ == matches_->size())
+			{
+				matches_ = nullptr;
+				++probeRow_;
+			}
+		}
+
+		return batch.rowCount > 0;
+	}
+
+private:
+	void build()
+	{
+		ColumnBatch batch;
+
+		while(built_->next(batch))
+		{
+			for(size_type i = 0; i < batch.getSelectedCount(); ++i)
+			{
+				size_type row = batch.getSelectedRow(i);
+
+				makeKey(built_->getColumns()[builtKey_], batch.columns[builtKey_], row);
+				hashTable_[key_].push_back(store_.getRowCount());
+				store_.append(batch, row);
+			}
+		}
+	}
+
+	// The integers as 64 bits, the floating point numbers as doubles, the strings without their trailing nulls.
+	void makeKey(const ColumnDescriptor& column, const ColumnVector& values, size_type row)
+	{
+		if(column.kind == ColumnKind::unsignedInteger)
+		{
+			key_.assign(reinterpret_cast<const char*>(&values.integers[row]), sizeof(uint64_t));
+		}
+		else if(column.kind == ColumnKind::floatingPoint)
+		{
+			key_.assign(reinterpret_cast<const char*>(&values.floats[row]), sizeof(double));
+		}
+		else
+		{
+			const char* begin = reinterpret_cast<const char*>(&values.bytes[row * column.size]);
+			const char* end = begin + column.size;
+
+			while((end != begin) && (end[-1] == '\0')) --end;
+
+			key_.assign(begin, end);
+		}
+	}
+
+	bool isLeftHashed_;
+	std::unique_ptr<BatchOperator> built_;
+	std::unique_ptr<BatchOperator> probe_;
+	std::vector<ColumnDescriptor> columns_;
+	Details::ColumnStore store_;
+	size_type builtKey_;
+	size_type probeKey_;
+
+	// The rows of the hashed side, by their key.
+	std::unordered_map<std::string, std::vector<size_type>> hashTable_;
+	std::string key_;
+
+	ColumnBatch probeBatch_;
+	size_type probeRow_;
+	size_type matchIndex_;
+	const std::vector<size_type>* matches_;
+	bool isBuilt_;
+	bool isProbed_;
+};
+
+#endif // BATCH_OPERATORS_HXX
@@ -0,0 +1,158 @@
+#ifndef BATCH_SCAN_HXX
+#define BATCH_SCAN_HXX
+
+#include <Configuration.hxx>
+#include <BufferManager.hxx>
+#include <ColumnBatch.hxx>
+#include <DbSystem.hxx>
+#include <DiskPage.hxx>
+#include <Predicate.hxx>
+#include <Schema.hxx>
+#include <SlotBitmap.hxx>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* The leaf of the batch operators : walks the pages of a schema along its chain, and decodes the used slots into
+ * batches, only for the fields asked for. The slots of a batch are found first, through the slot bitmaps, then every
+ * field is decoded for all of them at once (see ColumnDecoder).
+ * A predicate pushed down to the scan is evaluated on the pages (see BoundPredicate::matchSlots) : only the rows
+ * matching it are decoded. Its fields need not be decoded.
+ * The columns are named by their fields, after a prefix, the alias of the schema in a join for instance.
+ * The current page stays pinned, with a shared latch, between two batches, as with a read only DbIterator.
+ */
+template<Endianness endian>
+class BatchScan : public BatchOperator
+{
+public:
+	BatchScan(DbSystem<endian>& system, const std::string& schemaName, const std::vector<std::string>& fieldNames,
+			  const std::string& columnPrefix = {})
+	: system_{system},
+	  schema_{findSchema(system, schemaName)},
+	  pageHandle_{},
+	  nextSlot_{0},
+	  isPageMatched_{false},
+	  started_{false}
+	{
+		for(const auto& fieldName : fieldNames)
+		{
+			optional<FieldRef> field = schema_.findFieldRef(fieldName);
+
+			if(!field) throw QueryException("there is no field " + fieldName + " in " + schema_.getName());
+
+			columns_.push_back({columnPrefix + fieldName, field->type, field->size, getColumnKind(field->type)});
+			offsets_.push_back(field->offset);
+		}
+	}
+
+	// The predicate is on the fields of the schema, and throws a PredicateException if it does not fit it.
+	void pushDown(const Predicate& predicate)
+	{
+		predicate_.reset(new BoundPredicate<endian>{predicate, schema_});
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return columns_;
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(!started_)
+		{
+			auto entry = system_.getCatalogEntry(schema_.getName());
+			if(entry) system_.bufferManager_.adviseScan(entry->firstPageOffset, entry->lastPageOffset);
+
+			pageHandle_ = system_.bufferManager_.template requestFirstPage<PageType::ReadOnly>(schema_.getName());
+			started_ = true;
+		}
+
+		batch.reset(columns_);
+
+		size_type rowSize = schema_.getDataSize();
+		size_type count = 0;
+
+		while(pageHandle_ && (count < ColumnBatch::capacity))
+		{
+			const DiskPage<endian>& page = *pageHandle_.get();
+			const uint8_t* rows = page.getData().begin();
+			size_type slotCount = page.getPageSize();
+
+			// The slots to read : the used ones, or the ones matching the predicate.
+			const uint8_t* slots = page.getSlotBitmap().begin();
+
+			if(predicate_)
+			{
+				if(!isPageMatched_)
+				{
+					mask_.resize(SlotBitmap::getSize(slotCount));
+					predicate_->matchSlots(rows, slots, slotCount, mask_.data());
+					isPageMatched_ = true;
+				}
+
+				slots = mask_.data();
+			}
+
+			for(nextSlot_ = SlotBitmap::findNextUsed(slots, nextSlot_, slotCount); (nextSlot_ < slotCount) && (count < ColumnBatch::capacity);
+				nextSlot_ = SlotBitmap::findNextUsed(slots, nextSlot_ + 1, slotCount))
+			{
+				rows_[count++] = rows + nextSlot_ * rowSize;
+			}
+
+			// The rows must be decoded before the page is unpinned.
+			if(nextSlot_ >= slotCount)
+			{
+				decode(batch, count);
+				pageHandle_ = system_.bufferManager_.template requestNextPage<PageType::ReadOnly>(page);
+				nextSlot_ = 0;
+				isPageMatched_ = false;
+			}
+		}
+
+		decode(batch, count);
+
+		return batch.rowCount > 0;
+	}
+
+private:
+	static const DbSchema& findSchema(const DbSystem<endian>& system, const std::string& schemaName)
+	{
+		auto schemaIndex = system.getSchemaIndex(schemaName);
+		if(!schemaIndex) throw QueryException("there is no schema " + schemaName);
+
+		return *system.getSchema(*schemaIndex);
+	}
+
+	// Decodes the slots found since the last call, the slots of a batch may come from several pages.
+	void decode(ColumnBatch& batch, size_type count)
+	{
+		size_type first = batch.rowCount;
+
+		if(count == first) return;
+
+		for(size_type i = 0; i < columns_.size(); ++i)
+		{
+			ColumnDecoder<endian>::decode(columns_[i], offsets_[i], rows_.data() + first, count - first, batch.columns[i], first);
+		}
+
+		batch.rowCount = count;
+	}
+
+	DbSystem<endian>& system_;
+	const DbSchema& schema_;
+	std::vector<ColumnDescriptor> columns_;
+	std::vector<size_type> offsets_;
+
+	std::unique_ptr<BoundPredicate<endian>> predicate_;
+	std::vector<uint8_t> mask_;
+
+	BufferedPageHandle<endian, PageType::ReadOnly> pageHandle_;
+	size_type nextSlot_;
+	bool isPageMatched_;
+	bool started_;
+	std::array<const uint8_t*, ColumnBatch::capacity> rows_;
+};
+
+#endif // BATCH_SCAN_HXX
@@ -0,0 +1,70 @@
+#ifndef BOUNDED_QUEUE_HXX
+#define BOUNDED_QUEUE_HXX
+
+#include <Configuration.hxx>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/* A queue between the stages of a pipeline, holding at most capacity elements : a stage faster than the next one waits
+ * for it, instead of piling up its work in memory.
+ * Once closed, nothing can be pushed anymore, and the elements left can still be popped : push returns false, so does
+ * pop once the queue is empty. Closing it wakes up every waiting thread.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+	BoundedQueue(size_type capacity)
+	: capacity_{capacity > 0 ? capacity : 1},
+	  closed_{false}
+	{}
+
+	bool push(T element)
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		notFull_.wait(lock, [this]() { return closed_ || (elements_.size() < capacity_); });
+
+		if(closed_) return false;
+
+		elements_.push_back(std::move(element));
+		notEmpty_.notify_one();
+
+		return true;
+	}
+
+	bool pop(T& element)
+	{
+		std::unique_lock<std::mutex> lock{mutex_};
+		notEmpty_.wait(lock, [this]() { return closed_ || !elements_.empty(); });
+
+		if(elements_.empty()) return false;
+
+		element = std::move(elements_.front());
+		elements_.pop_front();
+		notFull_.notify_one();
+
+		return true;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		closed_ = true;
+
+		notFull_.notify_all();
+		notEmpty_.notify_all();
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable notFull_;
+	std::condition_variable notEmpty_;
+	std::deque<T> elements_;
+	size_type capacity_;
+	bool closed_;
+};
+
+#endif // BOUNDED_QUEUE_HXX
@@ -2,17 +2,33 @@
 #define BUFFER_MANAGER_HXX
 
 #include <Configuration.hxx>
+#include <AsyncFileIo.hxx>
 #include <RawDataUtils.hxx>
 #include <DataTypes.hxx>
 #include <DiskPage.hxx>
+#include <FreeSpaceMap.hxx>
+#include <ARCPageReplacePolicy.hxx>
+#include <ClockPageReplacePolicy.hxx>
 #include <LRUPageReplacePolicy.hxx>
+#include <MappedFile.hxx>
+#include <TwoQueuePageReplacePolicy.hxx>
 #include <MetaUtils.hxx>
 #include <PageReader.hxx>
 #include <PageWriter.hxx>
+#include <PageWriteBatch.hxx>
 #include <ResourceHandler.hxx>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 class DoublePageFreeException : public std::exception
@@ -30,9 +46,42 @@ private:
 	const std::string msg_;
 };
 
+class BufferFullException : public std::exception
+{
+public:
+	BufferFullException(const std::string& msg) : msg_{std::string{"Error when fetching disk page in buffer : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
+class ReadOnlyDatabaseException : public std::exception
+{
+public:
+	ReadOnlyDatabaseException(const std::string& msg) : msg_{std::string{"Error when modifying the database : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
 template<Endianness>
 class BufferManager;
 
+/* The frame is pinned by the BufferManager before the handle is built, the handle then holds the latch of the frame :
+ * shared for a read only page, exclusive for a writable one.
+ * The latches are not recursive, so a thread must not hold a writable handle and any other handle on the same page. */
 template<Endianness endian, PageType type>
 class BufferedPageStrategy
 {
@@ -46,9 +95,9 @@ public:
 		friend bool operator!=(HandleType lhs, HandleType rhs);
 	};
 
-	static HandleType construct(decltype(std::declval<HandleType>().manager) manager, decltype(std::declval<HandleType>().pageId) pageId) noexcept 
+	static HandleType construct(decltype(std::declval<HandleType>().manager) manager, decltype(std::declval<HandleType>().pageId) pageId) noexcept
 	{
-		manager->pin(pageId);
+		manager->template lockFrame<type>(pageId);
 		return {manager, pageId};
 	}
 
@@ -56,13 +105,14 @@ public:
 	{
 		if(handle)
 		{
+			handle->manager->template unlockFrame<type>(handle->pageId);
 			handle->manager->unpin(handle->pageId);
 		}
 		else
 		{
 			throw DoublePageFreeException("The handle is no longer valid");
 		}
-	}  
+	}
 };
 
 template<Endianness endian, PageType type>
@@ -88,17 +138,22 @@ struct BufferedPageHandle : public ResourceHandler<BufferedPageStrategy<endian,
 public:
 	using Base::Base;
 
+	// Hides the one of the ResourceHandler, which would give us back a base handle.
+	template<class ... Args>
+	static BufferedPageHandle create(Args&&... args)
+	{
+		return { Base::getConstructor()(std::forward<Args>(args)...) };
+	}
+
 	auto get() noexcept
 	{
-		using ManagerType = std::remove_pointer_t<decltype(Base::get()->manager)>;
-		using PageIndex = typename ManagerType::PageIndex;
 		using DiskPageType = std::conditional_t<type == PageType::ReadOnly, const DiskPage<endian>&, DiskPage<endian>&>;
 
 		if(Base::get())
 		{
 			auto pageId = Base::get()->pageId;
 
-			return optional<DiskPageType>{Base::get()->manager->bufferPool_[pageId].page};
+			return optional<DiskPageType>{Base::get()->manager->getFramePage(pageId)};
 		}
 
 		return optional<DiskPageType>{};
@@ -106,25 +161,63 @@ public:
 
 	auto get() const noexcept
 	{
-		using ManagerType = std::remove_pointer_t<decltype(Base::get()->manager)>;
-		using PageIndex = typename ManagerType::PageIndex;
-
 		if(Base::get())
 		{
 			auto pageId = Base::get()->pageId;
 
-			return optional<const DiskPage<endian>&>{Base::get()->manager->bufferPool_[pageId].page};
+			return optional<const DiskPage<endian>&>{Base::get()->manager->getFramePage(pageId)};
 		}
 
 		return optional<const DiskPage<endian>&>{};
 	}
 };
 
+/* The buffer is a fixed table of frames, each one holding a page and its own reader/writer latch.
+ * The raw pages live in a single arena, allocated at startup and aligned on frameAlignment, one slot of frameSize
+ * bytes by frame. The pages are read straight into their frame and parsed in place (see DiskPage), and the page table
+ * chains the frames themselves, so fetching and evicting pages does not allocate.
+ * The page table, mapping the offsets of the pages to their frame, is split in shards by hashed offset, each shard
+ * having its own mutex, so that threads looking up different pages do not contend.
+ * The pin count of a frame is protected by the mutex of the shard its page belongs to, and the replace policy is
+ * told about the first pin and the last unpin under that same mutex. A frame can then only be taken away from its
+ * page by checking its pin count under the shard mutex, while removing the page from the table.
+ * Unless the policy is concurrent (see PageReplacePolicy::isConcurrent), the calls to the policy are serialized.
+ * The file is read and written with pread and pwrite (see PositionalFile), so the file accesses run concurrently.
+ * They are only serialized by the io mutex with the stream backend, which keeps a position in the file.
+ * The dirty pages are written back by a background writer, whenever the share of dirty frames crosses the high
+ * watermark, so that the evictions mostly find clean frames and the destructor only has a few pages left to write.
+ * The writer gathers up to maxWriteBatch dirty pages in a PageWriteBatch, holding the shared latch of their frames
+ * until the batch is written, and the eviction waits for it on the exclusive latch. A batch is written by increasing
+ * offset, the adjacent pages at once, with a single flush.
+ * The page chains walked through requestNextPage are read ahead by a prefetcher thread, see noteChainStep.
+ * The pages whose offsets are known in advance can be loaded by prefetchPages, with many reads in flight at once, and
+ * the writer has all the writes of its batch in flight at once too (see AsyncFileIo). The mutex of these reads is taken
+ * before any other lock.
+ * Opened read only and mapped (see OpenMode), the file is mapped in memory and the frames hold views on the mapping
+ * instead of copies : there is no arena, no writer and no prefetcher, the system reads the file ahead, as told by
+ * adviseScan and prefetchPages, and the processes mapping the same file share its cache. The writable requests throw.
+ * Opened for direct I/O, the file is read and written bypassing the cache of the system, so the buffer is the only cache
+ * of the pages. The pages must then be aligned (see PageLayout), and are always read and written whole, from the frames.
+ * Lock order : shard mutex, then policy mutex, then io mutex. Two shard mutexes are never held at the same time.
+ */
 template<Endianness endian>
 class BufferManager
 {
 	static constexpr size_type defaultBufferSize = 512;
+	static constexpr size_type defaultShardCount = 16;
+	static constexpr size_type defaultFrameSize = 4096;
+	static constexpr size_type frameAlignment = 4096;
 	static constexpr size_type pageSize = 512;
+	static constexpr double defaultHighWatermark = 0.25;
+	static constexpr double defaultLowWatermark = 0.1;
+	static constexpr std::chrono::milliseconds::rep writerPeriod = 100;
+	static constexpr size_type maxWriteBatch = 64;
+	static constexpr size_type defaultAsyncQueueDepth = 32;
+	static constexpr size_type minReadAheadWindow = 4;
+	static constexpr size_type defaultMaxReadAheadWindow = 64;
+	static constexpr size_type maxReadAheadStreams = 16;
+	static constexpr std::streamoff noOffset = -1;
+	static constexpr bool serializedIo = (defaultIoBackend == IoBackend::stream);
 
 	friend class BufferedPageHandle<endian, PageType::ReadOnly>;
 	friend class BufferedPageHandle<endian, PageType::Writable>;
@@ -133,93 +226,352 @@ class BufferManager
 	using PageIndex = size_type;
 	using DefaultPolicy = LRUPageReplacePolicy<endian>;
 
-	struct DiskPageDescriptor
-	{
-		DiskPageDescriptor(DiskPage<endian>&& page_, std::streamoff offset_)
-		: page{std::move(page_)},
-		  offset{offset_}
-		{
-			std::cout << "Blouh : " << page_.getRawPageSize() << " : " << page.getPageSize() << std::endl;
-		}
+	private:
+	using PendingPage = typename PageWriteBatch<endian>::PendingPage;
+
+	static constexpr PageIndex noFrame = std::numeric_limits<PageIndex>::max();
 
+	struct BufferFrame
+	{
+		// Bound to the slot of the frame in the arena.
 		DiskPage<endian> page;
-		std::streamoff offset;
+
+		// Offset of the page held by the frame, noOffset if none. Only changes while the frame is out of the page table.
+		std::atomic<std::streamoff> offset{noOffset};
+
+		// Both protected by the mutex of the shard of offset, as long as the frame is in the page table.
+		size_type pinCount = 0;
+		PageIndex nextInBucket = noFrame;
+
+		// Set when a writable handle on a modified page is released, cleared once the page is written back.
+		std::atomic<bool> dirty{false};
+
+		std::shared_timed_mutex latch;
+	};
+
+	/* A walk along a page chain. The reader is at the page the stream is mapped to, about ahead pages are read ahead of it,
+	 * and the read ahead goes on at frontier (0 when unknown, noOffset at the end of the chain).
+	 * Shared with the prefetch requests, and protected by the read ahead mutex. */
+	struct ReadAheadStream
+	{
+		size_type window = 0;
+		size_type ahead = 0;
+		std::streamoff frontier = 0;
+	};
+
+	struct PrefetchRequest
+	{
+		std::shared_ptr<ReadAheadStream> stream;
+		std::streamoff from;
+		size_type count;
+	};
+
+	// Hash table of the frames, chained through the frames themselves.
+	struct PageTableShard
+	{
+		std::mutex mutex;
+		std::vector<PageIndex> buckets;
 	};
 
 	public:
 	BufferManager(const std::string& dbFileName)
-	: bufferPool_{},
-	  pinCountList_{},
-	  replacePolicy_{new DefaultPolicy()},
-	  bufferPagePosition_{},
-	  pgReader_{dbFileName},
-	  pgWriter_{dbFileName},
-	  bufferSize_{defaultBufferSize}
-	{
-		bufferPool_.reserve(bufferSize_);
-	}
+	: BufferManager(dbFileName, defaultBufferSize)
+	{}
 
 	BufferManager(const std::string& dbFileName, size_type bufferSize)
-	: bufferPool_{},
-	  pinCountList_{},
-	  replacePolicy_{new DefaultPolicy()},
-	  bufferPagePosition_{},
+	: BufferManager(dbFileName, bufferSize, std::make_unique<DefaultPolicy>(bufferSize))
+	{}
+
+	BufferManager(const std::string& dbFileName, OpenMode mode, PageLayout layout = PageLayout::packed)
+	: BufferManager(dbFileName, defaultBufferSize, std::make_unique<DefaultPolicy>(defaultBufferSize), defaultFrameSize, defaultShardCount, mode, layout)
+	{}
+
+	/* The replace policy is chosen by the user, for instance ClockPageReplacePolicy for read heavy workloads.
+	 * It should be built for bufferSize frames.
+	 * The frame size is rounded up to frameAlignment. A page bigger than a frame still works, but is allocated on its own.
+	 * With an aligned layout, the file must only hold pages of that layout, and the frames are at least as big. */
+	BufferManager(const std::string& dbFileName, size_type bufferSize, std::unique_ptr<PageReplacePolicy<endian>> replacePolicy,
+				  size_type frameSize = defaultFrameSize, size_type shardCount = defaultShardCount, OpenMode mode = OpenMode::readWrite,
+				  PageLayout layout = PageLayout::packed)
+	: arenaStorage_{},
+	  frameSize_{std::max(((frameSize + frameAlignment - 1) / frameAlignment) * frameAlignment, static_cast<size_type>(layout))},
+	  frames_(bufferSize),
+	  freeFrames_{},
+	  shards_(shardCount),
+	  replacePolicy_{std::move(replacePolicy)},
+	  concurrentPolicy_{false},
 	  pgReader_{dbFileName},
-	  pgWriter_{dbFileName},
-	  bufferSize_{bufferSize}
+	  pgWriter_{},
+	  readOnly_{mode == OpenMode::readOnlyMapped},
+	  directIo_{mode == OpenMode::readWriteDirect},
+	  pageLayout_{layout},
+	  freeSpaceMap_{dbFileName + ".fsm"},
+	  bufferSize_{bufferSize},
+	  dirtyCount_{0},
+	  evictionWriteCount_{0},
+	  writtenPageCount_{0},
+	  writeCount_{0},
+	  highWatermark_{static_cast<size_type>(defaultHighWatermark * bufferSize)},
+	  lowWatermark_{static_cast<size_type>(defaultLowWatermark * bufferSize)},
+	  writerHand_{0},
+	  writerBatch_{},
+	  writerLatchedFrames_{},
+	  stopWriter_{false},
+	  maxReadAheadWindow_{std::min(defaultMaxReadAheadWindow, bufferSize / 4)},
+	  prefetchedPageCount_{0},
+	  readAheadStreams_{},
+	  prefetchRequests_{},
+	  stopPrefetcher_{false},
+	  asyncQueueDepth_{defaultAsyncQueueDepth},
+	  writer_{},
+	  prefetcher_{}
 	{
-		bufferPool_.reserve(bufferSize_);
+		Expects(replacePolicy_);
+		Expects(bufferSize_ > 0);
+		Expects(frameSize_ > 0);
+		Expects(!shards_.empty());
+
+		concurrentPolicy_ = replacePolicy_->isConcurrent();
+
+		if(readOnly_)
+		{
+			openMapped(dbFileName);
+			checkLayout();
+			return;
+		}
+
+		pgWriter_.reset(new PageWriter<endian>{dbFileName});
+
+		checkLayout();
+
+		if(directIo_) enableDirectIo();
+
+		size_type arenaSize = frameSize_ * bufferSize_;
+		arenaStorage_.reset(new uint8_t[arenaSize + frameAlignment]);
+
+		void* arenaStart = arenaStorage_.get();
+		std::size_t space = arenaSize + frameAlignment;
+		uint8_t* arena = static_cast<uint8_t*>(std::align(frameAlignment, arenaSize, arenaStart, space));
+
+		for(size_type i = 0; i < bufferSize_; ++i)
+		{
+			frames_[i].page = DiskPage<endian>{i, arena + (i * frameSize_), frameSize_};
+		}
+
+		// About two frames by bucket if the whole buffer was in a single shard, so the chains stay short.
+		for(auto& shard : shards_)
+		{
+			shard.buckets.assign(std::max<size_type>(1, (2 * bufferSize_) / shards_.size()), noFrame);
+		}
+
+		// Handed out from the back, so that the frames are used in order.
+		freeFrames_.reserve(bufferSize_);
+		for(size_type i = bufferSize_; i > 0; --i)
+		{
+			freeFrames_.push_back(i - 1);
+		}
+
+		writer_ = std::thread{&BufferManager::runWriter, this};
+		prefetcher_ = std::thread{&BufferManager::runPrefetcher, this};
 	}
 
+	// Only the pages dirtied since the last pass of the writer are left to write.
 	~BufferManager()
 	{
-		for(auto descriptor : bufferPool_)
+		close();
+	}
+
+	/* Stops the threads of the buffer, and writes the dirty pages : everything is then on disk. Called by the destructor,
+	 * or before, by the owner which commits its metadata once the pages are written. The buffer can not be used after.
+	 */
+	void close()
+	{
+		// Nothing was ever written, nor read ahead, or the writer is already joined.
+		if(isReadOnly() || !writer_.joinable()) return;
+
+		{
+			std::lock_guard<std::mutex> lock{readAheadMutex_};
+			stopPrefetcher_ = true;
+		}
+
+		prefetchCondition_.notify_one();
+		prefetcher_.join();
+
+		{
+			std::lock_guard<std::mutex> lock{writerMutex_};
+			stopWriter_ = true;
+		}
+
+		writerCondition_.notify_one();
+		writer_.join();
+
+		PageWriteBatch<endian> batch;
+
+		for(auto& frame : frames_)
 		{
-			if(descriptor.page.isDirty())
+			if((frame.offset.load() != noOffset) && (frame.dirty.load() || frame.page.isDirty()))
 			{
-				std::cout << "Write " << std::endl;
-				pgWriter_.writePage(descriptor.page, descriptor.offset);
+				batch.add(frame.page, frame.offset.load());
 			}
 		}
+
+		pgWriter_->writeBatch(batch);
 	}
 
 	/* Functions to pin and unpin pages.
-	 * Using simple mutex lock to ensure the thread-safe
-	 * character of this action (these can effectively be called from multiple threads/process).
-     * (Disabled for now)
-     */
-	void pin(PageIndex pageId) noexcept
-	{
-		if(pageId < bufferPool_.size())
-		{
-			/*{
-				std::lock_guard<std::mutex> lock{mut_}; */
-			std::cout << "pin" << std::endl;
-			if(pageId >= pinCountList_.size())
-			{
-				pinCountList_.resize(pageId + 1);
-			}
+	 * The frames returned by the requests are already pinned, pin only adds a pin to a frame the caller
+	 * already holds (through a handle for instance).
+	 */
+	void pin(PageIndex pageId)
+	{
+		BufferFrame& frame = frames_[pageId];
 
-			pinCountList_[pageId] += 1;
-			std::cout << replacePolicy_.get() << std::endl;
-			replacePolicy_->use(bufferPool_[pageId].page);
-			/*}*/
-		}
+		std::lock_guard<std::mutex> lock{getShard(frame.offset.load()).mutex};
+		addPin(pageId);
 	}
 
 	void unpin(PageIndex pageId) noexcept
 	{
-		//std::lock_guard<std::mutex> lock{mut_};
-		std::cout << "unpin" << std::endl;
-		size_type pinCount = pinCountList_[pageId]; 
-		if((pageId < bufferPool_.size()) && (pinCount > 0))
+		BufferFrame& frame = frames_[pageId];
+
+		std::lock_guard<std::mutex> lock{getShard(frame.offset.load()).mutex};
+		if((frame.pinCount > 0) && (--frame.pinCount == 0))
+		{
+			notifyRelease(pageId);
+		}
+	}
+
+	template<PageType type>
+	void lockFrame(PageIndex pageId) noexcept
+	{
+		if(type == PageType::ReadOnly) frames_[pageId].latch.lock_shared();
+		else frames_[pageId].latch.lock();
+	}
+
+	template<PageType type>
+	void unlockFrame(PageIndex pageId) noexcept
+	{
+		if(type == PageType::ReadOnly)
+		{
+			frames_[pageId].latch.unlock_shared();
+		}
+		else
+		{
+			collectDirtyPage(pageId);
+			frames_[pageId].latch.unlock();
+		}
+	}
+
+	/* The background writer starts writing the dirty pages back once more than highWatermark of the frames are dirty,
+	 * and stops when they are under lowWatermark. Both are ratios of the buffer size. */
+	void setFlushWatermarks(double highWatermark, double lowWatermark)
+	{
+		Expects((lowWatermark >= 0) && (lowWatermark <= highWatermark) && (highWatermark <= 1));
+
+		highWatermark_.store(static_cast<size_type>(highWatermark * bufferSize_));
+		lowWatermark_.store(static_cast<size_type>(lowWatermark * bufferSize_));
+		writerCondition_.notify_one();
+	}
+
+	size_type getDirtyPageCount() const noexcept
+	{
+		return dirtyCount_.load();
+	}
+
+	/* The most pages read ahead of a chain walk, 0 to disable the read ahead.
+	 * By default a quarter of the buffer, up to defaultMaxReadAheadWindow, so none for the tiny buffers. */
+	void setMaxReadAheadWindow(size_type window) noexcept
+	{
+		std::lock_guard<std::mutex> lock{readAheadMutex_};
+		maxReadAheadWindow_ = window;
+	}
+
+	size_type getPrefetchedPageCount() const noexcept
+	{
+		return prefetchedPageCount_.load();
+	}
+
+	// The most reads prefetchPages keeps in flight.
+	void setAsyncQueueDepth(size_type depth)
+	{
+		Expects(depth > 0);
+
+		std::lock_guard<std::mutex> lock{asyncReadMutex_};
+		asyncQueueDepth_ = depth;
+#ifdef HAS_POSITIONAL_IO
+		asyncReader_.reset();
+#endif
+	}
+
+	/* Loads the pages at these offsets which are not in the buffer yet, up to the async queue depth of them being read
+	 * at the same time, without waiting for a reader to ask for them. The pages are left unpinned.
+	 * For the scans which know their pages in advance, from the catalog or an index for instance.
+	 * As the read ahead, it is only a hint : it stops when every frame is pinned, and skips the pages it cannot read. */
+	void prefetchPages(const std::vector<std::streamoff>& offsets)
+	{
+		std::lock_guard<std::mutex> lock{asyncReadMutex_};
+
+#ifdef HAS_POSITIONAL_IO
+		// The views are made on demand, only the reads of the mapping are worth starting. Most pages fit a frame.
+		if(readOnly_)
 		{
-			pinCountList_[pageId] -= 1;
+			for(std::streamoff offset : offsets) mappedFile_->advise(offset, frameSize_, MappingAdvice::willNeed);
+			return;
 		}
-		if(pinCountList_[pageId] == 0)
+
+		prefetchPagesAsync(offsets);
+#else
+		try
 		{
-			replacePolicy_->release(bufferPool_[pageId].page);
+			for(std::streamoff offset : offsets)
+			{
+				if(isResident(offset)) continue;
+
+				unpin(loadPage(offset));
+				++prefetchedPageCount_;
+			}
 		}
+		catch(const std::exception&)
+		{}
+#endif
+	}
+
+	/* Tells the system that the pages from the one at first to the one at last are about to be read in order, if the
+	 * file is mapped : it reads them ahead, more and more as the scan goes, and frees them once read. The first pages
+	 * are read in the background right away, as many as the max read ahead window, the whole range would delay the
+	 * first one. Nothing to do otherwise, the chain walks are read ahead by the prefetcher. */
+	void adviseScan(std::streamoff first, std::streamoff last) const noexcept
+	{
+#ifdef HAS_POSITIONAL_IO
+		if(!readOnly_ || (last < first)) return;
+
+		size_type size = static_cast<size_type>(last - first) + frameSize_;
+
+		mappedFile_->advise(first, size, MappingAdvice::sequential);
+		mappedFile_->advise(first, std::min(size, defaultMaxReadAheadWindow * frameSize_), MappingAdvice::willNeed);
+#endif
+	}
+
+	bool isReadOnly() const noexcept
+	{
+		return readOnly_;
+	}
+
+	// The number of dirty pages the evictions had to write themselves, because the background writer was late.
+	size_type getEvictionWriteCount() const noexcept
+	{
+		return evictionWriteCount_.load();
+	}
+
+	// The pages written back, and the writes it took : adjacent pages written in the same batch share a write.
+	size_type getWrittenPageCount() const noexcept
+	{
+		return writtenPageCount_.load();
+	}
+
+	size_type getWriteCount() const noexcept
+	{
+		return writeCount_.load();
 	}
 
 	// Maybe add a setter too ?
@@ -228,123 +580,143 @@ class BufferManager
 		return bufferSize_;
 	}
 
+	size_type getShardCount() const noexcept
+	{
+		return shards_.size();
+	}
+
+	size_type getFrameSize() const noexcept
+	{
+		return frameSize_;
+	}
+
+	// Gives access to the metrics of the policy, like the target size of the ARC recency list.
+	const PageReplacePolicy<endian>& getReplacePolicy() const noexcept
+	{
+		return *replacePolicy_;
+	}
+
 	template<PageType type>
 	BufferedPageHandle<endian, type> requestFreePage(const DbSchema& schema)
 	{
+		using HandleType = BufferedPageHandle<endian, type>;
+
+		checkAccess<type>();
+
+		// The free space map knows every page with a free slot, the first one is our page, unless the map is stale.
+		if(freeSpaceMap_.isValid())
+		{
+			while(auto offset = freeSpaceMap_.findPage(schema.getName()))
+			{
+				auto handle = HandleType::create(this, fixPage(*offset));
+				if(!handle.get()->isFull()) return handle;
+
+				freeSpaceMap_.update(schema.getName(), *offset, false);
+			}
+
+			// Let the system create a new page.
+			return {};
+		}
+
 		// Look if we have any known available page.
-		auto candidatePageOffset = firstAvailablePageOffsetMap_.find(schema.getName());
+		optional<std::streamoff> candidatePageOffset;
+		{
+			std::lock_guard<std::mutex> lock{catalogMutex_};
+			auto it = firstAvailablePageOffsetMap_.find(schema.getName());
 
-		using HandleType = BufferedPageHandle<endian, type>;
-			std::cout << "Watch me " << std::endl;
-		// If we do, then proceed to retrieve it from the buffer or fetch it from the file if it's not in buffer.
-		if(candidatePageOffset != firstAvailablePageOffsetMap_.end())
-		{			std::cout << "Watch me " << std::endl;
-			auto pos = bufferPagePosition_.find(candidatePageOffset->second);
-			
-			if(pos != bufferPagePosition_.end())
+			if(it != firstAvailablePageOffsetMap_.end()) candidatePageOffset = it->second;
+		}
+
+		// If we do, then proceed to retrieve it from the buffer or fetch it from the file if it's not in buffer and not full.
+		if(candidatePageOffset)
+		{
+			auto pageId = pinResident(*candidatePageOffset);
+
+			if(!pageId && !readPageHeader(*candidatePageOffset).isFull())
 			{
-				std::cout << "Alreayd in buffer" << std::endl;
-				DiskPageDescriptor& pageDescriptor = bufferPool_[pos->second];
-				if(!pageDescriptor.page.isFull()) return HandleType::create(this, pos->second);
+				pageId = loadPage(*candidatePageOffset);
 			}
-			else
+
+			if(pageId)
 			{
-				std::cout << "Fetchou" << std::endl;
-				auto newPageDescriptor = fetchNewPageIfFree(candidatePageOffset->second);
-				if(newPageDescriptor)
-				{
-					return HandleType::create(this, newPageDescriptor->page.getIndex());
-				}
+				auto handle = HandleType::create(this, *pageId);
+				if(!handle.get()->isFull()) return handle;
 			}
 		}
+
 		// If no available page is known, then look for a free page in the file.
 		// If we find any, fetch it and return it.
 		// Else, just return nullopt and let the system create a new page if needed.
 		auto offset = lookForFirstFreePage(schema.getName());
 		if(offset)
 		{
-			std::cout << "Watch me " << std::endl;
-			return HandleType::create(this, fetchNewPage(*offset).page.getIndex());
+			return HandleType::create(this, fixPage(*offset));
 		}
-		std::cout << "Hel : " << bufferPool_.size() << std::endl;
-			std::cout << "Watch me " << std::endl;
+
 		return {};
 	}
 
-	// Maybe put private and allow just friend BufferedPageStrategy to use ?
+	// The caller must already hold a pin on the frame.
 	template<PageType type>
-	BufferedPageHandle<endian, type> getPageFromIndex(PageIndex pageId) noexcept
+	BufferedPageHandle<endian, type> getPageFromIndex(PageIndex pageId)
 	{
 		using HandleType = BufferedPageHandle<endian, type>;
-		return HandleType::create(this, bufferPool_[pageId].page.getIndex());
+
+		checkAccess<type>();
+
+		pin(pageId);
+		return HandleType::create(this, pageId);
 	}
 
 	template<PageType type>
 	BufferedPageHandle<endian, type> requestPage(std::streamoff offset)
 	{
-		auto pagePosition = bufferPagePosition_.find(offset);
-
 		using HandleType = BufferedPageHandle<endian, type>;
 
-		if(pagePosition != bufferPagePosition_.end())
-		{
-			return HandleType::create(this, bufferPool_[pagePosition->second].page.getIndex());
-		}
-	
-		return HandleType::create(this, fetchNewPage(offset).page.getIndex());
+		checkAccess<type>();
+
+		return HandleType::create(this, fixPage(offset));
 	}
 
 	template<PageType type>
 	BufferedPageHandle<endian, type> requestFirstPage(const std::string& schemaName)
 	{
-		auto offset = firstPageOffsetMap_.find(schemaName);
-
 		using HandleType = BufferedPageHandle<endian, type>;
 
-		if(offset != firstPageOffsetMap_.end())
-		{
-			auto pagePosition = bufferPagePosition_.find(offset->second);
+		checkAccess<type>();
 
-			if(pagePosition != bufferPagePosition_.end())
-			{
-				return HandleType::create(this, bufferPool_[pagePosition->second].page.getIndex());
-			}
+		auto offset = lookForFirstPage(schemaName);
 
-			return HandleType::create(this, fetchNewPage(offset->second).page.getIndex());
-		}
-		else
+		if(offset)
 		{
-			auto offset = lookForFirstPage(schemaName);
-
-			if(offset)
-			{
-				return HandleType::create(this, fetchNewPage(*offset).page.getIndex());
-			}
+			return HandleType::create(this, fixPage(*offset));
 		}
 
 		return {};
-	
 	}
 
 	template<PageType type>
 	BufferedPageHandle<endian, type> requestNextPage(const DiskPage<endian>& page)
 	{
+		using HandleType = BufferedPageHandle<endian, type>;
+
+		checkAccess<type>();
+
+		std::streamoff nextOffset = page.getNextPageOffset();
+
 		// We do not have a next page, return a void handle.
-		if(page.getNextPageOffset() == 0) return {};
-		auto pagePosition = bufferPagePosition_.find(page.getNextPageOffset());
+		if(nextOffset == 0) return {};
 
-		using HandleType = BufferedPageHandle<endian, type>;
+		auto handle = HandleType::create(this, fixPage(nextOffset));
+		noteChainStep(page, nextOffset, *handle.get());
 
-		if(pagePosition != bufferPagePosition_.end())
-		{
-			return HandleType::create(this, bufferPool_[pagePosition->second].page.getIndex());
-		}
-		return HandleType::create(this, fetchNewPage(page.getNextPageOffset()).page.getIndex());
+		return handle;
 	}
 
 	template<PageType type>
 	optional<std::streamoff> getFirstPageOffset(const DbSchema& schema)
 	{
+		std::lock_guard<std::mutex> lock{catalogMutex_};
 		auto it = firstPageOffsetMap_.find(schema.getName());
 
 		if(it != firstPageOffsetMap_.end())
@@ -353,185 +725,878 @@ class BufferManager
 		}
 		else
 		{
-			
+
 		}
 	}
 
-	// A nullopt in return means that there is no page which contains this type of schema in the DB
-	optional<std::streamoff> lookForFirstPage(const std::string& schemaName)
+	// Rebuilt and saved by the DbSystem, along with its catalog.
+	FreeSpaceMap<endian>& getFreeSpaceMap() noexcept
 	{
-		auto it = firstPageOffsetMap_.find(schemaName);
-
-		if(it != firstPageOffsetMap_.end())
-		{
-			return it->second;
-		}
-		else
-		{
-
-			// If there is no page in file, we have no chance to find what we're looking for
-			pgReader_.rewind();
-			if(pgReader_.eof()) return {};
-
-			std::streamoff offset = 0;
-
-			while(true)
-			{
-			std::cout << offset << std::endl;
-				DiskPageHeader<endian> header = pgReader_.readPageHeader(offset);
+		return freeSpaceMap_;
+	}
 
-				if(header.getSchemaName() == schemaName)
-				{
-					firstPageOffsetMap_.insert({schemaName, offset});
-					return offset;
-				}
-				std::cout << pgReader_.getFileSize() << std::endl;
-				offset += header.getRawPageSize();
-				if((offset + 1) >= pgReader_.getFileSize())
-				{
-					std::cout << "return" << std::endl;
-					return {};
-				}
-			std::cout << "hello" << std::endl;
-			}
-		}
+	// When the first page of the schema is known from elsewhere, like the catalog, so that it is not looked for in the file.
+	void setFirstPageOffset(const std::string& schemaName, std::streamoff offset)
+	{
+		std::lock_guard<std::mutex> lock{catalogMutex_};
+		firstPageOffsetMap_[schemaName] = offset;
 	}
 
-	optional<std::streamoff> lookForLastPage(const std::string& schemaName)
+	// Calls function(offset, header) for every page of the file, in the order of the file.
+	template<class Function>
+	void forEachPageHeader(Function function)
 	{
-		auto firstPageOffset = lookForFirstPage(schemaName);
-		std::cout << "First page offset ? : " << firstPageOffset << std::endl;
-		// If there is no page in file, we have no chance to find what we're looking for
-		if(!firstPageOffset) return {};
+		if(isFileEmpty()) return;
 
-		DiskPageHeader<endian> header = pgReader_.readPageHeader(*firstPageOffset);
-		std::streamoff offset = *firstPageOffset;
+		std::streamoff fileSize = getFileSize();
 
-		while(header.getNextPageOffset() != 0)
+		for(std::streamoff offset = 0; offset < fileSize;)
 		{
-			offset = header.getNextPageOffset();
-			header = pgReader_.readPageHeader(offset);
-		}
+			DiskPageHeader<endian> header = readPageHeader(offset);
 
-		return offset;
+			function(offset, static_cast<const DiskPageHeader<endian>&>(header));
+			offset += header.getRawPageSize();
+		}
 	}
 
-	void flush(PageIndex index)
+	std::streamoff getDatabaseFileSize()
 	{
-		std::cout << "Flush : " << bufferPool_.size() << std::endl;
-		pgWriter_.writePage(bufferPool_[index].page, bufferPool_[index].offset);
+		return getFileSize();
 	}
 
-	/*template<>
-	const DiskPage& requestPage<PageType::NonModifiable>(const std::string& schemaName)
+	/* The new pages are appended through the writer of the buffer too, the only one writing the file : with the direct
+	 * I/O, a buffered write would mix with the direct ones. A single page is written as an evicted one. */
+	void appendPage(const DiskPage<endian>& page, std::streamoff offset)
 	{
-		return requestPageAux(schemaName);
-	}*/
-
-	// TODO : Add a "clearCache" function to remove extraneous pages
+		if(!directIo_)
+		{
+			writePage(page, offset);
+			return;
+		}
 
-	private:
+		PageWriteBatch<endian> batch;
+		batch.add(page, offset);
+		appendBatch(batch);
+	}
 
-	optional<PageIndex> performPageReplace(std::streamoff newPageOffset)
+	/* Written and synced as writeBatch. With the direct I/O, the pages do not live in the aligned frames : they are
+	 * copied in a buffer aligned the same way first. */
+	void appendBatch(PageWriteBatch<endian>& batch)
 	{
-		auto candidatePageId = replacePolicy_->getCandidate();
+		if(!directIo_)
+		{
+			writeBatch(batch);
+			return;
+		}
 
-		std::cout << "Try to replace page" << std::endl;
-		if(candidatePageId)
+		size_type size = 0;
+		batch.forEachPageRun([&size](std::streamoff, range<const PendingPage*> pages)
 		{
-			auto oldPage = bufferPool_[*candidatePageId];
+			for(const PendingPage& page : pages) size += page.size;
+		});
 
-			bufferPagePosition_.erase(oldPage.offset);
+		std::unique_ptr<uint8_t[]> storage{new uint8_t[size + frameAlignment]};
 
-			if(oldPage.page.isDirty())
+		void* bufferStart = storage.get();
+		std::size_t space = size + frameAlignment;
+		uint8_t* buffer = static_cast<uint8_t*>(std::align(frameAlignment, size, bufferStart, space));
+
+		PageWriteBatch<endian> alignedBatch;
+		batch.forEachPageRun([&buffer, &alignedBatch](std::streamoff, range<const PendingPage*> pages)
+		{
+			for(const PendingPage& page : pages)
 			{
-				pgWriter_.writePage(oldPage.page, oldPage.offset);
+				std::copy(page.bytes, page.bytes + page.size, buffer);
+				alignedBatch.add(buffer, page.size, page.offset);
+				buffer += page.size;
 			}
+		});
 
-			bufferPagePosition_.insert({newPageOffset, *candidatePageId});
-			bufferPool_[*candidatePageId] = {pgReader_.readPage(*candidatePageId, newPageOffset), newPageOffset};
-			std::cout << "Replaced page : " << *candidatePageId << std::endl;
-		}
-		
-		return candidatePageId;
+		writeBatch(alignedBatch);
 	}
 
-	// Need optional as return here !
-	DiskPageDescriptor& fetchNewPage(std::streamoff offset)
-	{
-		// If we still have room in buffer, just fetch the page and place it at the end.
-		if(bufferPool_.size() < getBufferSize())
+	// A nullopt in return means that there is no page which contains this type of schema in the DB
+	optional<std::streamoff> lookForFirstPage(const std::string& schemaName)
+	{
 		{
-			std::cout << "Still have room in buffer : " << offset << std::endl;
-			bufferPool_.emplace_back(pgReader_.readPage(bufferPool_.size(), offset), offset);
-			bufferPagePosition_[offset] = bufferPool_.size() - 1;
-			std::cout << bufferPool_.back().page.getRawPageSize() << std::endl;
-			return bufferPool_.back();
+			std::lock_guard<std::mutex> lock{catalogMutex_};
+			auto it = firstPageOffsetMap_.find(schemaName);
+
+			if(it != firstPageOffsetMap_.end()) return it->second;
 		}
-		else
+
+		// If there is no page in file, we have no chance to find what we're looking for
+		if(isFileEmpty()) return {};
+
+		std::streamoff offset = 0;
+		std::streamoff fileSize = getFileSize();
+
+		while(true)
 		{
-			// Else, try to perform a page replace. If it fails, just extend the buffer and put it at the end.
-			std::cout << "No more room in buffer" << std::endl;			
-			auto replacedPageId = performPageReplace(offset);
-			if(replacedPageId)
+			DiskPageHeader<endian> header = readPageHeader(offset);
+
+			if(header.getSchemaName() == schemaName)
 			{
-				std::cout << "REPLAAAAAAAAAAAAAAAAAAAACE: : " << offset << std::endl;
-				return bufferPool_[*replacedPageId];
+				std::lock_guard<std::mutex> lock{catalogMutex_};
+				firstPageOffsetMap_.insert({schemaName, offset});
+				return offset;
 			}
-			else
+			offset += header.getRawPageSize();
+			if((offset + 1) >= fileSize)
 			{
-				std::cout << "Extends buffer" << std::endl;
-				bufferPool_.emplace_back(pgReader_.readPage(bufferPool_.size(), offset), offset);
-				bufferPagePosition_[offset] = bufferPool_.size() - 1;
-				return bufferPool_.back();
+				return {};
 			}
 		}
+	}
+
+	optional<std::streamoff> lookForLastPage(const std::string& schemaName)
+	{
+		auto firstPageOffset = lookForFirstPage(schemaName);
+		// If there is no page in file, we have no chance to find what we're looking for
+		if(!firstPageOffset) return {};
+
+		DiskPageHeader<endian> header = readPageHeader(*firstPageOffset);
+		std::streamoff offset = *firstPageOffset;
+
+		while(header.getNextPageOffset() != 0)
+		{
+			offset = header.getNextPageOffset();
+			header = readPageHeader(offset);
+		}
+
+		return offset;
+	}
+
+	// The caller must hold a handle on the page.
+	void flush(PageIndex index)
+	{
+		checkAccess<PageType::Writable>();
+
+		BufferFrame& frame = frames_[index];
+
+		writePage(frame.page, frame.offset.load());
+
+		// Only a writable handle can have modified the page, and it holds the exclusive latch.
+		if(frame.page.isDirty()) frame.page.markClean();
+		if(frame.dirty.exchange(false)) --dirtyCount_;
+	}
+
+	/*template<>
+	const DiskPage& requestPage<PageType::NonModifiable>(const std::string& schemaName)
+	{
+		return requestPageAux(schemaName);
+	}*/
+
+	// TODO : Add a "clearCache" function to remove extraneous pages
+
+	private:
+
+	DiskPage<endian>& getFramePage(PageIndex pageId) noexcept
+	{
+		return frames_[pageId].page;
+	}
+
+	template<PageType type>
+	void checkAccess() const
+	{
+		if((type == PageType::Writable) && readOnly_)
+		{
+			throw ReadOnlyDatabaseException("the database is opened read only");
+		}
+	}
+
+	// An aligned file only holds whole pages of its layout, so they all start on a page boundary.
+	void checkLayout()
+	{
+		if(directIo_ && (pageLayout_ == PageLayout::packed))
+		{
+			throw PageLayoutException("the direct I/O needs the pages aligned on the blocks of the device");
+		}
+
+		if((pageLayout_ != PageLayout::packed) && ((getFileSize() % static_cast<std::streamoff>(pageLayout_)) != 0))
+		{
+			throw PageLayoutException("the database file is not made of aligned pages");
+		}
+	}
+
+	// The frames are aligned on frameAlignment, and at least as big as the pages, so the pages are read straight in them.
+	void enableDirectIo()
+	{
+#ifdef HAS_POSITIONAL_IO
+		pgReader_.setDirectIo(true);
+		pgWriter_->setDirectIo(true);
+#else
+		throw std::ios_base::failure("Error : direct I/O is not available on this system.");
+#endif
+	}
+
+	// The frames are only views on the mapping, bound to nothing until a page is loaded.
+	void openMapped(const std::string& dbFileName)
+	{
+#ifdef HAS_POSITIONAL_IO
+		mappedFile_.reset(new MappedFile{dbFileName});
+
+		for(size_type i = 0; i < bufferSize_; ++i)
+		{
+			frames_[i].page = DiskPage<endian>{i, nullptr, 0};
+		}
+
+		for(auto& shard : shards_)
+		{
+			shard.buckets.assign(std::max<size_type>(1, (2 * bufferSize_) / shards_.size()), noFrame);
+		}
+
+		freeFrames_.reserve(bufferSize_);
+		for(size_type i = bufferSize_; i > 0; --i)
+		{
+			freeFrames_.push_back(i - 1);
+		}
+#else
+		throw std::ios_base::failure(std::string("Error : the file ") + dbFileName + " cannot be mapped on this system.");
+#endif
+	}
+
+	// The offsets are multiples of the page size, mix the bits before picking the shard and the bucket (Fibonacci hashing).
+	static uint64_t hashOffset(std::streamoff offset) noexcept
+	{
+		return (static_cast<uint64_t>(offset) * 0x9E3779B97F4A7C15ull) >> 32;
+	}
+
+	PageTableShard& getShard(std::streamoff offset) noexcept
+	{
+		return shards_[hashOffset(offset) % shards_.size()];
+	}
+
+	PageIndex& getBucket(PageTableShard& shard, std::streamoff offset) noexcept
+	{
+		return shard.buckets[(hashOffset(offset) / shards_.size()) % shard.buckets.size()];
+	}
+
+	// The mutex of the shard must be held for the three functions below.
+	optional<PageIndex> findFrame(PageTableShard& shard, std::streamoff offset) noexcept
+	{
+		for(PageIndex pageId = getBucket(shard, offset); pageId != noFrame; pageId = frames_[pageId].nextInBucket)
+		{
+			if(frames_[pageId].offset.load(std::memory_order_relaxed) == offset) return pageId;
+		}
+
+		return {};
+	}
+
+	void insertFrame(PageTableShard& shard, PageIndex pageId) noexcept
+	{
+		PageIndex& head = getBucket(shard, frames_[pageId].offset.load(std::memory_order_relaxed));
+
+		frames_[pageId].nextInBucket = head;
+		head = pageId;
+	}
+
+	void eraseFrame(PageTableShard& shard, PageIndex pageId) noexcept
+	{
+		PageIndex* link = &getBucket(shard, frames_[pageId].offset.load(std::memory_order_relaxed));
+
+		while(*link != pageId)
+		{
+			link = &frames_[*link].nextInBucket;
+		}
+
+		*link = frames_[pageId].nextInBucket;
+		frames_[pageId].nextInBucket = noFrame;
+	}
+
+	// Returns the frame holding the page at this offset, pinned, loading the page if needed.
+	PageIndex fixPage(std::streamoff offset)
+	{
+		auto pageId = pinResident(offset);
+
+		return pageId ? *pageId : loadPage(offset);
+	}
+
+	optional<PageIndex> pinResident(std::streamoff offset)
+	{
+		PageTableShard& shard = getShard(offset);
+
+		std::lock_guard<std::mutex> lock{shard.mutex};
+		auto pageId = findFrame(shard, offset);
+
+		if(pageId) addPin(*pageId);
+
+		return pageId;
+	}
+
+	// The mutex of the shard of the frame must be held.
+	void addPin(PageIndex pageId)
+	{
+		if(frames_[pageId].pinCount++ == 0)
+		{
+			notifyUse(pageId);
+		}
+	}
+
+	bool isResident(std::streamoff offset)
+	{
+		PageTableShard& shard = getShard(offset);
+
+		std::lock_guard<std::mutex> lock{shard.mutex};
+		return static_cast<bool>(findFrame(shard, offset));
+	}
+
+	PageIndex loadPage(std::streamoff offset)
+	{
+		PageIndex pageId = acquireFrame();
+
+		// Nobody else can reach the frame until it is in the page table, no need for the latch.
+		try
+		{
+			readPage(frames_[pageId].page, offset);
+		}
+		catch(...)
+		{
+			giveBackFrame(pageId);
+			throw;
+		}
+
+		return publishPage(pageId, offset);
+	}
+
+	/* Puts the frame, out of the page table with a single pin, and holding the page read at offset, in the page table.
+	 * Returns the frame of the page, pinned : another one if the page was loaded by another thread in the meantime. */
+	PageIndex publishPage(PageIndex pageId, std::streamoff offset)
+	{
+		BufferFrame& frame = frames_[pageId];
+		PageTableShard& shard = getShard(offset);
+		std::unique_lock<std::mutex> lock{shard.mutex};
+		auto loadedPageId = findFrame(shard, offset);
+
+		// Another thread loaded the same page in the meantime : use its frame, and give ours back.
+		if(loadedPageId)
+		{
+			addPin(*loadedPageId);
+			lock.unlock();
+			giveBackFrame(pageId);
+
+			return *loadedPageId;
+		}
+
+		frame.offset.store(offset);
+		insertFrame(shard, pageId);
+		notifyLoaded(pageId, offset);
+		notifyUse(pageId);
+
+		return pageId;
+	}
+
+	// Returns a frame out of the page table, with a single pin, which the caller owns.
+	PageIndex acquireFrame()
+	{
+		while(true)
+		{
+			optional<PageIndex> candidatePageId;
+
+			{
+				std::lock_guard<std::mutex> lock{policyMutex_};
+
+				if(!freeFrames_.empty())
+				{
+					PageIndex pageId = freeFrames_.back();
+
+					freeFrames_.pop_back();
+					frames_[pageId].pinCount = 1;
+
+					return pageId;
+				}
+
+				candidatePageId = replacePolicy_->getCandidate();
+			}
+
+			if(!candidatePageId)
+			{
+				throw BufferFullException("every frame of the buffer is pinned");
+			}
+
+			if(evict(*candidatePageId))
+			{
+				return *candidatePageId;
+			}
+		}
+	}
+
+	// Takes the frame away from its page if nobody uses it, writing the page back if it is dirty.
+	bool evict(PageIndex pageId)
+	{
+		BufferFrame& frame = frames_[pageId];
+		std::streamoff offset = frame.offset.load();
+
+		if(offset == noOffset) return false;
+
+		{
+			PageTableShard& shard = getShard(offset);
+
+			std::lock_guard<std::mutex> lock{shard.mutex};
+			auto mappedPageId = findFrame(shard, offset);
+
+			// The frame may have been pinned, or taken by another thread, since the policy chose it.
+			if(!mappedPageId || (*mappedPageId != pageId) || (frame.pinCount > 0)) return false;
+
+			eraseFrame(shard, pageId);
+			frame.offset.store(noOffset);
+			frame.pinCount = 1;
+		}
+
+		// The background writer may be writing the page back right now, wait for it.
+		frame.latch.lock();
+		bool dirty = frame.dirty.exchange(false);
+		frame.latch.unlock();
+
+		if(dirty)
+		{
+			--dirtyCount_;
+			++evictionWriteCount_;
+
+			PageWriteBatch<endian> batch;
+			batch.add(frame.page, offset);
+			writeBatch(batch);
+		}
+
+		std::lock_guard<std::mutex> lock{policyMutex_};
+		replacePolicy_->pageEvicted(frame.page, offset);
+
+		return true;
+	}
+
+	/* The exclusive latch of the frame must be held. Moves the dirty flag of the page to the frame, for the writer,
+	 * and tells the free space map whether the page still has a free slot. */
+	void collectDirtyPage(PageIndex pageId) noexcept
+	{
+		BufferFrame& frame = frames_[pageId];
+
+		if(!frame.page.isDirty()) return;
+
+		frame.page.markClean();
+
+		// Rows may have been added or removed.
+		freeSpaceMap_.update(frame.page.getSchemaName(), frame.offset.load(), !frame.page.isFull());
+
+		if(!frame.dirty.exchange(true) && (++dirtyCount_ > highWatermark_.load()))
+		{
+			writerCondition_.notify_one();
+		}
+	}
+
+	void runWriter()
+	{
+		std::unique_lock<std::mutex> lock{writerMutex_};
+
+		while(!stopWriter_)
+		{
+			// The period only catches the notifications lost between the check of the watermark and the wait.
+			writerCondition_.wait_for(lock, std::chrono::milliseconds{writerPeriod}, [this]() {
+				return stopWriter_ || (dirtyCount_.load() > highWatermark_.load());
+			});
+
+			if(stopWriter_) break;
+
+			lock.unlock();
+			writeBackDirtyPages(lowWatermark_.load());
+			lock.lock();
+		}
+	}
 
-		// Should return nulllopt
-		return bufferPool_.back();
+	// Sweeps the frames at most once, from where the previous pass stopped, until there are no more than target dirty pages.
+	void writeBackDirtyPages(size_type target)
+	{
+		for(size_type i = 0; (i < bufferSize_) && (dirtyCount_.load() > target); ++i)
+		{
+			addToWriterBatch(writerHand_);
+			writerHand_ = (writerHand_ + 1) % bufferSize_;
+
+			if(writerLatchedFrames_.size() == maxWriteBatch) writeWriterBatch();
+		}
+
+		writeWriterBatch();
 	}
 
-	optional<DiskPageDescriptor&> fetchNewPageIfFree(std::streamoff offset)
+	// Adds the frame to the batch of the writer, if it is dirty, keeping its shared latch until the batch is written.
+	void addToWriterBatch(PageIndex pageId)
 	{
-		if((bufferPool_.size() < getBufferSize()) && !pgReader_.readPageHeader(offset).isFull())
+		BufferFrame& frame = frames_[pageId];
+
+		// A frame held by a writable handle will be dirty again when released, no need to wait for it.
+		if(!frame.dirty.load() || !frame.latch.try_lock_shared()) return;
+
+		// Under the latch, the frame cannot be evicted, and its offset is noOffset only while it is being evicted or loaded.
+		std::streamoff offset = frame.offset.load();
+
+		if((offset != noOffset) && frame.dirty.exchange(false))
 		{
-			bufferPool_.emplace_back(pgReader_.readPage(bufferPool_.size(), offset), offset);
-			bufferPagePosition_[offset] = bufferPool_.size() - 1;
-			return bufferPool_.back();
+			--dirtyCount_;
+			writerBatch_.add(frame.page, offset);
+			writerLatchedFrames_.push_back(pageId);
 		}
 		else
 		{
-			auto replacedPageId = performPageReplace(offset);
-			if(replacedPageId && !bufferPool_[*replacedPageId].page.isFull())
+			frame.latch.unlock_shared();
+		}
+	}
+
+	void writeWriterBatch()
+	{
+		if(!writerBatch_.empty())
+		{
+#ifdef HAS_POSITIONAL_IO
+			if(!writerIo_) writerIo_.reset(new AsyncFileIo{pgWriter_->getDescriptor(), maxWriteBatch});
+
+			writeCount_ += pgWriter_->writeBatch(writerBatch_, *writerIo_);
+			writtenPageCount_ += writerBatch_.getPageCount();
+#else
+			writeBatch(writerBatch_);
+#endif
+		}
+
+		for(PageIndex pageId : writerLatchedFrames_)
+		{
+			frames_[pageId].latch.unlock_shared();
+		}
+
+		writerBatch_.clear();
+		writerLatchedFrames_.clear();
+	}
+
+	/* Called when the reader of a chain moved from the page to the next one, which it holds.
+	 * The second step along the same chain starts a read ahead of minReadAheadWindow pages, and the window doubles
+	 * every time the reader gets halfway through the pages read ahead, up to the max window. */
+	void noteChainStep(const DiskPage<endian>& page, std::streamoff nextOffset, const DiskPage<endian>& nextPage)
+	{
+		// Only the pages of the buffer have an offset we know. A mapped file is read ahead by the system.
+		if(readOnly_ || (page.getIndex() >= bufferSize_) || (&frames_[page.getIndex()].page != &page)) return;
+
+		std::streamoff offset = frames_[page.getIndex()].offset.load();
+		std::streamoff afterNextOffset = nextPage.getNextPageOffset();
+
+		std::unique_lock<std::mutex> lock{readAheadMutex_};
+
+		if(maxReadAheadWindow_ == 0) return;
+
+		auto it = readAheadStreams_.find(offset);
+
+		if(it == readAheadStreams_.end())
+		{
+			// Forget an arbitrary stream, most likely the one of an abandoned walk.
+			if(readAheadStreams_.size() >= maxReadAheadStreams) readAheadStreams_.erase(readAheadStreams_.begin());
+
+			readAheadStreams_[nextOffset] = std::make_shared<ReadAheadStream>();
+			return;
+		}
+
+		std::shared_ptr<ReadAheadStream> stream = std::move(it->second);
+		readAheadStreams_.erase(it);
+		readAheadStreams_[nextOffset] = stream;
+
+		if(stream->ahead > 0) --stream->ahead;
+
+		// Nothing left to read ahead, or enough pages already ahead of the reader.
+		if((stream->frontier == noOffset) || (afterNextOffset == 0) || (stream->ahead > stream->window / 2)) return;
+
+		// Go on from the last page read ahead, unless the reader caught up with it.
+		std::streamoff from = ((stream->ahead > 0) && (stream->frontier != 0)) ? stream->frontier : afterNextOffset;
+
+		stream->window = std::min(maxReadAheadWindow_, (stream->window == 0) ? minReadAheadWindow : 2 * stream->window);
+		prefetchRequests_.push_back({stream, from, stream->window - stream->ahead});
+		stream->ahead = stream->window;
+
+		lock.unlock();
+		prefetchCondition_.notify_one();
+	}
+
+	void runPrefetcher()
+	{
+		std::unique_lock<std::mutex> lock{readAheadMutex_};
+
+		while(true)
+		{
+			prefetchCondition_.wait(lock, [this]() { return stopPrefetcher_ || !prefetchRequests_.empty(); });
+
+			if(stopPrefetcher_) break;
+
+			PrefetchRequest request = std::move(prefetchRequests_.front());
+			prefetchRequests_.pop_front();
+
+			lock.unlock();
+			std::streamoff frontier = prefetch(request.from, request.count);
+			lock.lock();
+
+			request.stream->frontier = frontier;
+		}
+	}
+
+	/* Loads count pages of a chain, from the one at offset. Returns the offset of the page following the last one loaded,
+	 * noOffset if the chain ended. */
+	std::streamoff prefetch(std::streamoff offset, size_type count)
+	{
+		// The read ahead is only a hint : if the buffer is full, or the file cannot be read, the reader will see it.
+		try
+		{
+			for(size_type i = 0; i < count; ++i)
 			{
-				return bufferPool_[*replacedPageId];
+				auto pageId = pinResident(offset);
+
+				if(!pageId)
+				{
+					pageId = loadPage(offset);
+					++prefetchedPageCount_;
+				}
+
+				offset = BufferedPageHandle<endian, PageType::ReadOnly>::create(this, *pageId).get()->getNextPageOffset();
+
+				if(offset == 0) return noOffset;
 			}
 		}
+		catch(const std::exception&)
+		{}
 
-		return {};
+		return offset;
 	}
 
-	optional<std::streamoff> lookForFirstFreePage(const std::string& schemaName)
+#ifdef HAS_POSITIONAL_IO
+	// The async reader mutex must be held.
+	void prefetchPagesAsync(const std::vector<std::streamoff>& offsets)
 	{
-		auto it = firstPageOffsetMap_.find(schemaName);
+		if(!asyncReader_) asyncReader_.reset(new AsyncFileIo{pgReader_.getDescriptor(), asyncQueueDepth_});
 
-		if(it == firstPageOffsetMap_.end())
+		// The frames being read, by tag.
+		std::unordered_map<PageIndex, std::streamoff> pendingOffsets;
+		std::vector<AsyncIoCompletion> completions;
+		auto next = offsets.begin();
+
+		try
 		{
-			if(lookForFirstPage(schemaName))
+			while(next != offsets.end())
 			{
-				it = firstPageOffsetMap_.find(schemaName);
+				// Fill the queue, then hand all the reads to the system at once.
+				while((next != offsets.end()) && (asyncReader_->getPendingCount() < asyncReader_->getQueueDepth()))
+				{
+					std::streamoff offset = *next++;
+
+					if(isResident(offset)) continue;
+
+					PageIndex pageId = acquireFrame();
+
+					asyncReader_->prepareRead(frames_[pageId].page.prepare(frameSize_), frameSize_, offset, pageId);
+					pendingOffsets[pageId] = offset;
+				}
+
+				completions.clear();
+				asyncReader_->wait(completions);
+
+				for(const AsyncIoCompletion& completion : completions)
+				{
+					completePrefetch(completion, pendingOffsets);
+				}
 			}
-			else
+		}
+		catch(const std::exception&)
+		{}
+
+		// Even if the buffer is full, the frames in flight belong to the reads until they complete.
+		completions.clear();
+		asyncReader_->wait(completions, asyncReader_->getPendingCount());
+
+		for(const AsyncIoCompletion& completion : completions)
+		{
+			completePrefetch(completion, pendingOffsets);
+		}
+	}
+
+	void completePrefetch(const AsyncIoCompletion& completion, std::unordered_map<PageIndex, std::streamoff>& pendingOffsets) noexcept
+	{
+		PageIndex pageId = completion.tag;
+		DiskPage<endian>& page = frames_[pageId].page;
+		std::streamoff offset = pendingOffsets[pageId];
+
+		pendingOffsets.erase(pageId);
+
+		try
+		{
+			if(completion.result <= 0) throw std::ios_base::failure("Failed to read the page");
+
+			page.load();
+
+			// A page bigger than a frame, or a short read : read the page the usual way.
+			if((page.getRawPageSize() > frameSize_) || (completion.result < static_cast<int64_t>(page.getRawPageSize())))
 			{
-				return {};
+				readPage(page, offset);
 			}
+
+			unpin(publishPage(pageId, offset));
+			++prefetchedPageCount_;
+		}
+		catch(const std::exception&)
+		{
+			giveBackFrame(pageId);
 		}
+	}
+#endif
+
+	void giveBackFrame(PageIndex pageId)
+	{
+		BufferFrame& frame = frames_[pageId];
+
+		frame.pinCount = 0;
+
+		std::lock_guard<std::mutex> lock{policyMutex_};
+		freeFrames_.push_back(pageId);
+	}
+
+	void notifyUse(PageIndex pageId)
+	{
+		if(concurrentPolicy_)
+		{
+			replacePolicy_->use(getFramePage(pageId));
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock{policyMutex_};
+		replacePolicy_->use(getFramePage(pageId));
+	}
+
+	void notifyRelease(PageIndex pageId) noexcept
+	{
+		if(concurrentPolicy_)
+		{
+			replacePolicy_->release(getFramePage(pageId));
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock{policyMutex_};
+		replacePolicy_->release(getFramePage(pageId));
+	}
+
+	void notifyLoaded(PageIndex pageId, std::streamoff offset)
+	{
+		std::lock_guard<std::mutex> lock{policyMutex_};
+		replacePolicy_->pageLoaded(getFramePage(pageId), offset);
+	}
+
+	std::unique_lock<std::mutex> lockIo()
+	{
+		return serializedIo ? std::unique_lock<std::mutex>{ioMutex_} : std::unique_lock<std::mutex>{};
+	}
+
+	void readPage(DiskPage<endian>& page, std::streamoff offset)
+	{
+#ifdef HAS_POSITIONAL_IO
+		if(readOnly_)
+		{
+			const uint8_t* rawPage = getMappedPage(offset);
+			page.view(rawPage, mappedFile_->getSize() - offset);
+
+			if(page.getRawPageSize() > (mappedFile_->getSize() - offset)) throw std::ios_base::failure(mappedEndOfFileError());
+			return;
+		}
+
+		// The raw page size cannot be read on its own, only whole blocks : read the whole page.
+		if(directIo_)
+		{
+			size_type rawPageSize = static_cast<size_type>(pageLayout_);
+
+			pgReader_.read(page.prepare(rawPageSize), rawPageSize, offset);
+			page.load();
+
+			if(page.getRawPageSize() != rawPageSize) throw PageLayoutException("a page of the file is not of the layout");
+			return;
+		}
+#endif
+
+		auto lock = lockIo();
+		pgReader_.readPage(page, offset);
+	}
+
+	DiskPageHeader<endian> readPageHeader(std::streamoff offset)
+	{
+#ifdef HAS_POSITIONAL_IO
+		if(readOnly_)
+		{
+			const uint8_t* rawPage = getMappedPage(offset);
+			return {rawPage, mappedFile_->getData() + mappedFile_->getSize()};
+		}
+
+		// Read the first block of the page, the headers are much smaller, in an aligned buffer.
+		if(directIo_)
+		{
+			std::unique_ptr<uint8_t[]> storage{new uint8_t[2 * frameAlignment]};
+
+			void* blockStart = storage.get();
+			std::size_t space = 2 * frameAlignment;
+			uint8_t* block = static_cast<uint8_t*>(std::align(frameAlignment, frameAlignment, blockStart, space));
+
+			pgReader_.read(block, frameAlignment, offset);
+			return {block, block + frameAlignment};
+		}
+#endif
+
+		auto lock = lockIo();
+		return pgReader_.readPageHeader(offset);
+	}
+
+#ifdef HAS_POSITIONAL_IO
+	// Checks that at least the fixed part of the header of the page at offset is in the mapping.
+	const uint8_t* getMappedPage(std::streamoff offset) const
+	{
+		static constexpr size_type fixedHeaderSize = sizeof(std::streamoff) + 2 * sizeof(size_type) + sizeof(uint32_t);
+
+		if((offset < 0) || ((static_cast<size_type>(offset) + fixedHeaderSize) > mappedFile_->getSize()))
+		{
+			throw std::ios_base::failure(mappedEndOfFileError());
+		}
+
+		return mappedFile_->getData() + offset;
+	}
+
+	std::string mappedEndOfFileError() const
+	{
+		return std::string{"Error : attempting to read beyond the end of the file '"} + mappedFile_->getCurrentFileName() + "'.";
+	}
+#endif
+
+	void writePage(const DiskPage<endian>& page, std::streamoff offset)
+	{
+		auto lock = lockIo();
+		pgWriter_->writePage(page, offset);
+
+		++writtenPageCount_;
+		++writeCount_;
+	}
+
+	void writeBatch(PageWriteBatch<endian>& batch)
+	{
+		auto lock = lockIo();
+		writeCount_ += pgWriter_->writeBatch(batch);
+		writtenPageCount_ += batch.getPageCount();
+	}
+
+	bool isFileEmpty()
+	{
+		return getFileSize() == 0;
+	}
+
+	std::streamoff getFileSize()
+	{
+#ifdef HAS_POSITIONAL_IO
+		if(readOnly_) return static_cast<std::streamoff>(mappedFile_->getSize());
+#endif
+
+		auto lock = lockIo();
+		return pgReader_.getFileSize();
+	}
+
+	optional<std::streamoff> lookForFirstFreePage(const std::string& schemaName)
+	{
+		auto firstPageOffset = lookForFirstPage(schemaName);
 
 		// If there is no page, no point in searching in file
-		if(it == firstPageOffsetMap_.end()) return {};
+		if(!firstPageOffset) return {};
 
-		auto offset = it->second;
-		std::cout << "Look for first free page" << std::endl;
+		auto offset = *firstPageOffset;
 
 		bool isFull;
 		std::string pageSchemaName;
@@ -539,27 +1604,28 @@ class BufferManager
 
 		while(true)
 		{
-			auto pagePositionInBuffer = bufferPagePosition_.find(offset);
+			auto pageId = pinResident(offset);
 
-			if(pagePositionInBuffer != bufferPagePosition_.end())
+			if(pageId)
 			{
-				const DiskPage<endian>& page = bufferPool_[pagePositionInBuffer->second].page;
+				auto handle = BufferedPageHandle<endian, PageType::ReadOnly>::create(this, *pageId);
+				const DiskPage<endian>& page = *handle.get();
 				isFull = page.isFull();
 				pageSchemaName = page.getSchemaName();
 				nextPageOffset = page.getNextPageOffset();
 			}
 			else
 			{
-				DiskPageHeader<endian> header = pgReader_.readPageHeader(offset);
+				DiskPageHeader<endian> header = readPageHeader(offset);
 				isFull = header.isFull();
 				pageSchemaName = header.getSchemaName();
 				nextPageOffset = header.getNextPageOffset();
-				std::cout << header.getFreeSlotCount() << std::endl;
 			}
-				std::cout << " d : " << nextPageOffset << " : " << isFull << std::endl;
+
 			if((pageSchemaName == schemaName) && !isFull)
 			{
-				firstAvailablePageOffsetMap_.insert({schemaName, offset});
+				std::lock_guard<std::mutex> lock{catalogMutex_};
+				firstAvailablePageOffsetMap_[schemaName] = offset;
 				return offset;
 			}
 			else if(nextPageOffset == 0)
@@ -571,10 +1637,16 @@ class BufferManager
 		}
 	}
 
-	std::vector<DiskPageDescriptor> bufferPool_;
-	std::vector<size_type> pinCountList_;
+	std::unique_ptr<uint8_t[]> arenaStorage_;
+	size_type frameSize_;
+
+	// Never resized, the frames and the shards are shared between threads.
+	std::vector<BufferFrame> frames_;
+	std::vector<PageIndex> freeFrames_;
+	std::vector<PageTableShard> shards_;
+
 	std::unique_ptr<PageReplacePolicy<endian>> replacePolicy_;
-	std::unordered_map<std::streamoff, size_type> bufferPagePosition_;
+	bool concurrentPolicy_;
 
 	/* The page at the offset contained in this map may or may not be full, they are the last "non-full" page that we're aware of.
 	 * However, they may be no such page, in which case firstAvailablePageOffset_.find(schemaName) will return the "end" iterator */
@@ -582,9 +1654,99 @@ class BufferManager
 	std::unordered_map<std::string, std::streamoff> firstPageOffsetMap_;
 
 	PageReader<endian> pgReader_;
-	PageWriter<endian> pgWriter_;
+
+	// Not opened if the file is mapped read only.
+	std::unique_ptr<PageWriter<endian>> pgWriter_;
+	bool readOnly_;
+	bool directIo_;
+	PageLayout pageLayout_;
+#ifdef HAS_POSITIONAL_IO
+	// Only opened if the file is mapped read only, never changes then.
+	std::unique_ptr<MappedFile> mappedFile_;
+#endif
+
+	FreeSpaceMap<endian> freeSpaceMap_;
+
+	// Protects the free frames list and the replace policy.
+	std::mutex policyMutex_;
+	// Protects the two offset maps above.
+	std::mutex catalogMutex_;
+	// Protects the page reader and writer, if serializedIo.
+	std::mutex ioMutex_;
 
 	size_type bufferSize_;
+
+	std::atomic<size_type> dirtyCount_;
+	std::atomic<size_type> evictionWriteCount_;
+	std::atomic<size_type> writtenPageCount_;
+	std::atomic<size_type> writeCount_;
+
+	// In frames, see setFlushWatermarks.
+	std::atomic<size_type> highWatermark_;
+	std::atomic<size_type> lowWatermark_;
+
+	// Only used by the writer thread.
+	PageIndex writerHand_;
+	PageWriteBatch<endian> writerBatch_;
+	std::vector<PageIndex> writerLatchedFrames_;
+#ifdef HAS_POSITIONAL_IO
+	std::unique_ptr<AsyncFileIo> writerIo_;
+#endif
+
+	bool stopWriter_;
+	std::mutex writerMutex_;
+	std::condition_variable writerCondition_;
+
+	size_type maxReadAheadWindow_;
+	std::atomic<size_type> prefetchedPageCount_;
+
+	// Mapped to the offset of the page the reader is at. All the read ahead state is protected by the mutex.
+	std::unordered_map<std::streamoff, std::shared_ptr<ReadAheadStream>> readAheadStreams_;
+	std::deque<PrefetchRequest> prefetchRequests_;
+	bool stopPrefetcher_;
+	std::mutex readAheadMutex_;
+	std::condition_variable prefetchCondition_;
+
+	// Protects the async reader, built on the first use.
+	size_type asyncQueueDepth_;
+#ifdef HAS_POSITIONAL_IO
+	std::unique_ptr<AsyncFileIo> asyncReader_;
+#endif
+	std::mutex asyncReadMutex_;
+
+	// Started last, once everything they use is built.
+	std::thread writer_;
+	std::thread prefetcher_;
 };
 
+template<Endianness endian>
+constexpr std::streamoff BufferManager<endian>::noOffset;
+
+template<Endianness endian>
+constexpr bool BufferManager<endian>::serializedIo;
+
+template<Endianness endian>
+constexpr typename BufferManager<endian>::PageIndex BufferManager<endian>::noFrame;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::defaultBufferSize;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::frameAlignment;
+
+template<Endianness endian>
+constexpr std::chrono::milliseconds::rep BufferManager<endian>::writerPeriod;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::maxWriteBatch;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::defaultAsyncQueueDepth;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::minReadAheadWindow;
+
+template<Endianness endian>
+constexpr size_type BufferManager<endian>::defaultMaxReadAheadWindow;
+
 #endif // BUFFER_MANAGER_HXX
@@ -0,0 +1,174 @@
+#ifndef BULK_LOADER_HXX
+#define BULK_LOADER_HXX
+
+#include <Configuration.hxx>
+#include <BufferManager.hxx>
+#include <DbEntry.hxx>
+#include <DbSystem.hxx>
+#include <DiskPage.hxx>
+#include <PageWriteBatch.hxx>
+#include <Range.hxx>
+#include <Schema.hxx>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Loads many rows of a schema at once, without going through the free pages nor the buffer : the rows fill whole pages
+ * in memory, and every batchPageCount pages, the batch is appended to the file in a single sequential write, by the
+ * writer of the buffer, its pages already chained together. The batch is then linked at the end of the chain of the schema, which is the only page
+ * written again, once by batch, and the catalog is committed.
+ * The rows are only visible, and durable, once their batch is written : see flush, and finish. The destructor finishes
+ * too, but can not report a failure : call finish to know that the last rows are written. A batch which fails to be
+ * written is dropped, the next flush does not write it again.
+ * Nothing else can add to the database while the loader is alive, and the thread owning the loader must not call
+ * DbSystem::add itself.
+ */
+template<Endianness endian>
+class BulkLoader
+{
+public:
+	static constexpr size_type defaultBatchPageCount = 256;
+
+	BulkLoader(DbSystem<endian>& system, const std::string& schemaName, size_type batchPageCount = defaultBatchPageCount)
+	: system_{system},
+	  addLock_{system.addMutex_},
+	  schema_{*system.getSchema(*system.getSchemaIndex(schemaName))},
+	  batchPageCount_{batchPageCount > 0 ? batchPageCount : 1},
+	  batchRowCount_{0},
+	  rowCount_{0},
+	  finished_{false}
+	{
+		if(system_.bufferManager_.isReadOnly())
+		{
+			throw ReadOnlyDatabaseException("the database is opened read only");
+		}
+
+		pages_.reserve(batchPageCount_);
+	}
+
+	BulkLoader(const BulkLoader&) = delete;
+	BulkLoader& operator=(const BulkLoader&) = delete;
+
+	~BulkLoader()
+	{
+		try
+		{
+			finish();
+		}
+		catch(...)
+		{}
+	}
+
+	void add(const DbEntry<endian>& entry)
+	{
+		Ensures(entry.getSchema().getName() == schema_.getName());
+
+		add(range<const uint8_t*>{entry.getRawData().data(), entry.getRawData().data() + entry.getRawData().size()});
+	}
+
+	void add(const DbEntryView<endian>& entry)
+	{
+		Ensures(entry.getSchema().getName() == schema_.getName());
+
+		add(entry.getRawData());
+	}
+
+	// The raw row must be laid out as the rows of the schema.
+	void add(range<const uint8_t*> rawData)
+	{
+		Expects(rawData.size() == schema_.getDataSize());
+
+		if(pages_.empty() || pages_.back().isFull())
+		{
+			if(pages_.size() == batchPageCount_) flush();
+
+			pages_.push_back(system_.makePage(schema_));
+		}
+
+		pages_.back().add(rawData);
+		++batchRowCount_;
+	}
+
+	// Writes and links the pages filled so far, the last one even if it is not full.
+	void flush()
+	{
+		if(pages_.empty()) return;
+
+		std::streamoff firstOffset = system_.bufferManager_.getDatabaseFileSize();
+		std::streamoff offset = firstOffset;
+		PageWriteBatch<endian> batch;
+
+		for(size_type i = 0; i < pages_.size(); ++i)
+		{
+			std::streamoff nextOffset = offset + pages_[i].getRawPageSize();
+
+			pages_[i].setNextPageOffset((i + 1 < pages_.size()) ? nextOffset : 0);
+			batch.add(pages_[i], offset);
+
+			offset = nextOffset;
+		}
+
+		std::streamoff lastOffset = offset - pages_.back().getRawPageSize();
+
+		try
+		{
+			system_.bufferManager_.appendBatch(batch);
+			system_.linkNewPages(schema_.getName(), firstOffset, lastOffset, pages_.size(), offset);
+		}
+		catch(...)
+		{
+			pages_.clear();
+			batchRowCount_ = 0;
+			throw;
+		}
+
+		system_.changeRowCount(schema_.getName(), batchRowCount_);
+
+		// Only the pages linked to the chain of the schema can be handed out to the inserts.
+		offset = firstOffset;
+
+		for(const DiskPage<endian>& page : pages_)
+		{
+			system_.bufferManager_.getFreeSpaceMap().update(schema_.getName(), offset, !page.isFull());
+			offset += page.getRawPageSize();
+		}
+
+		rowCount_ += batchRowCount_;
+		batchRowCount_ = 0;
+		pages_.clear();
+	}
+
+	// Writes the last pages, and lets the other writers in.
+	void finish()
+	{
+		if(finished_) return;
+
+		flush();
+
+		finished_ = true;
+		addLock_.unlock();
+	}
+
+	// The rows written so far.
+	size_type getRowCount() const noexcept
+	{
+		return rowCount_;
+	}
+
+private:
+	DbSystem<endian>& system_;
+	std::unique_lock<std::mutex> addLock_;
+	const DbSchema& schema_;
+
+	std::vector<DiskPage<endian>> pages_;
+	size_type batchPageCount_;
+	size_type batchRowCount_;
+	size_type rowCount_;
+	bool finished_;
+};
+
+template<Endianness endian>
+constexpr size_type BulkLoader<endian>::defaultBatchPageCount;
+
+#endif // BULK_LOADER_HXX
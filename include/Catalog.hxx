@@ -0,0 +1,272 @@
+#ifndef CATALOG_HXX
+#define CATALOG_HXX
+
+#include <Configuration.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Optional.hxx>
+#include <RecordCodec.hxx>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+class CatalogOverflowException : public std::exception
+{
+public:
+	CatalogOverflowException(const std::string& msg) : msg_{std::string{"Error when storing the catalog : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
+// Where the pages of a schema are, and how many rows they hold.
+struct CatalogEntry
+{
+	std::streamoff firstPageOffset;
+	std::streamoff lastPageOffset;
+	size_type pageCount;
+	size_type rowCount;
+};
+
+/* The superblock of the database : for each schema, the ends of its page chain and its sizes, so that opening the
+ * database does not have to scan the file.
+ * It is stored in its own file, next to the database, in two slots of slotSize bytes at fixed offsets.
+ * A commit writes the whole catalog in the slot which does not hold the current version, with a greater sequence
+ * number and a checksum, so a commit interrupted half way leaves the previous version intact. On load, the valid slot
+ * with the greatest sequence number wins.
+ * The size of the database file is stored too : a catalog which does not match the file is stale, and must be rebuilt.
+ * So is a catalog which was not committed clean : the row counts, and the free space map, are only committed when the
+ * database is closed, a crash in between leaves them behind the pages. See DbSystem.
+ * Slot layout : magic (8), sequence (8), database file size (8), clean flag (8), entry count (8), then for each entry
+ * the schema name and its '\0', the first and last page offsets (8 each), the page count and the row count (8 each),
+ * and at last the checksum (8) of everything before it.
+ */
+template<Endianness endian>
+class Catalog
+{
+	static constexpr uint64_t magic = 0x324C544143424D44; // "DMBCATL2" in little endian.
+	static constexpr size_type slotSize = 16384;
+	static constexpr size_type slotCount = 2;
+	static constexpr size_type valueSize = RecordCodec<endian>::valueSize;
+
+	using Codec = RecordCodec<endian>;
+
+	public:
+	Catalog(const std::string& fileName)
+	: fileName_{fileName},
+	  entries_{},
+	  databaseFileSize_{0},
+	  sequence_{0},
+	  currentSlot_{0},
+	  valid_{false},
+	  clean_{false}
+	{
+		load();
+	}
+
+	// Whether a committed version of the catalog was found.
+	bool isValid() const noexcept
+	{
+		return valid_;
+	}
+
+	// Whether the version loaded was committed when the database was closed.
+	bool isClean() const noexcept
+	{
+		return clean_;
+	}
+
+	std::streamoff getDatabaseFileSize() const noexcept
+	{
+		return databaseFileSize_;
+	}
+
+	void setDatabaseFileSize(std::streamoff size) noexcept
+	{
+		databaseFileSize_ = size;
+	}
+
+	optional<const CatalogEntry&> getEntry(const std::string& schemaName) const noexcept
+	{
+		auto it = entries_.find(schemaName);
+
+		if(it == entries_.end()) return {};
+
+		return it->second;
+	}
+
+	const std::map<std::string, CatalogEntry>& getEntries() const noexcept
+	{
+		return entries_;
+	}
+
+	void setEntry(const std::string& schemaName, const CatalogEntry& entry)
+	{
+		entries_[schemaName] = entry;
+	}
+
+	void clear() noexcept
+	{
+		entries_.clear();
+		databaseFileSize_ = 0;
+	}
+
+	// Makes the current state of the catalog the one loaded next time, all at once. Only the last commit, when the
+	// database is closed, is clean.
+	void commit(bool clean = false)
+	{
+		std::vector<uint8_t> slot = serialize(sequence_ + 1, clean);
+
+		if(slot.size() > slotSize)
+		{
+			throw CatalogOverflowException("too many schemas, the catalog does not fit in " + std::to_string(slotSize) + " bytes");
+		}
+
+		size_type nextSlot = valid_ ? (currentSlot_ + 1) % slotCount : 0;
+
+		// The writer expects an existing file, it is only created by the first commit.
+		std::ofstream{fileName_, std::ios::binary | std::ios::app};
+
+		FileValueWriter<endian> writer{fileName_, std::ios_base::out | std::ios_base::in | std::ios::binary};
+		writer.write(slot, nextSlot * slotSize);
+		writer.flush();
+
+		++sequence_;
+		currentSlot_ = nextSlot;
+		valid_ = true;
+		clean_ = clean;
+	}
+
+	private:
+
+	void load()
+	{
+		// A missing catalog is rebuilt : nothing is written next to a read only database.
+		if(!std::ifstream{fileName_, std::ios::binary}) return;
+
+		FileValueReader<endian> reader{fileName_};
+		std::streamoff fileSize = reader.getFileSize();
+
+		for(size_type i = 0; i < slotCount; ++i)
+		{
+			std::streamoff slotOffset = i * slotSize;
+
+			if(slotOffset + static_cast<std::streamoff>(5 * valueSize) > fileSize) break;
+
+			std::vector<uint8_t> slot;
+			reader.read(slot, std::min<std::streamoff>(slotSize, fileSize - slotOffset), slotOffset);
+
+			uint64_t slotSequence;
+			if(parseHeader(slot, slotSequence) && (!valid_ || (slotSequence > sequence_)))
+			{
+				if(deserialize(slot))
+				{
+					sequence_ = slotSequence;
+					currentSlot_ = i;
+					valid_ = true;
+				}
+			}
+		}
+	}
+
+	static bool parseHeader(const std::vector<uint8_t>& slot, uint64_t& sequence) noexcept
+	{
+		if((slot.size() < 5 * valueSize) || (Codec::readValue(slot, 0) != magic)) return false;
+
+		sequence = Codec::readValue(slot, valueSize);
+		return true;
+	}
+
+	std::vector<uint8_t> serialize(uint64_t sequence, bool clean) const
+	{
+		std::vector<uint8_t> slot;
+
+		Codec::appendValue(slot, magic);
+		Codec::appendValue(slot, sequence);
+		Codec::appendValue(slot, databaseFileSize_);
+		Codec::appendValue(slot, clean ? 1 : 0);
+		Codec::appendValue(slot, entries_.size());
+
+		for(const auto& entry : entries_)
+		{
+			Codec::appendString(slot, entry.first);
+			Codec::appendValue(slot, entry.second.firstPageOffset);
+			Codec::appendValue(slot, entry.second.lastPageOffset);
+			Codec::appendValue(slot, entry.second.pageCount);
+			Codec::appendValue(slot, entry.second.rowCount);
+		}
+
+		Codec::appendChecksum(slot);
+
+		return slot;
+	}
+
+	// Only fills the catalog if the whole slot is valid.
+	bool deserialize(const std::vector<uint8_t>& slot)
+	{
+		std::map<std::string, CatalogEntry> entries;
+		size_type position = 2 * valueSize;
+
+		std::streamoff databaseFileSize = Codec::readValue(slot, position);
+		bool clean = Codec::readValue(slot, position + valueSize) != 0;
+		size_type entryCount = Codec::readValue(slot, position + 2 * valueSize);
+		position += 3 * valueSize;
+
+		for(size_type i = 0; i < entryCount; ++i)
+		{
+			auto schemaName = Codec::readString(slot, position);
+
+			if(!schemaName || (position + 4 * valueSize > slot.size())) return false;
+
+			CatalogEntry entry;
+			entry.firstPageOffset = Codec::readValue(slot, position);
+			entry.lastPageOffset = Codec::readValue(slot, position + valueSize);
+			entry.pageCount = Codec::readValue(slot, position + 2 * valueSize);
+			entry.rowCount = Codec::readValue(slot, position + 3 * valueSize);
+			position += 4 * valueSize;
+
+			entries.insert({*schemaName, entry});
+		}
+
+		if(!Codec::checkChecksum(slot, position)) return false;
+
+		entries_ = std::move(entries);
+		databaseFileSize_ = databaseFileSize;
+		clean_ = clean;
+
+		return true;
+	}
+
+	std::string fileName_;
+	std::map<std::string, CatalogEntry> entries_;
+	std::streamoff databaseFileSize_;
+
+	uint64_t sequence_;
+	size_type currentSlot_;
+	bool valid_;
+	bool clean_;
+};
+
+template<Endianness endian>
+constexpr uint64_t Catalog<endian>::magic;
+
+template<Endianness endian>
+constexpr size_type Catalog<endian>::slotSize;
+
+template<Endianness endian>
+constexpr size_type Catalog<endian>::slotCount;
+
+template<Endianness endian>
+constexpr size_type Catalog<endian>::valueSize;
+
+#endif // CATALOG_HXX
@@ -0,0 +1,127 @@
+#ifndef CLOCK_PAGE_REPLACE_POLICY_HXX
+#define CLOCK_PAGE_REPLACE_POLICY_HXX
+
+#include <Configuration.hxx>
+#include <Optional.hxx>
+#include <PageReplacePolicy.hxx>
+
+#include <atomic>
+#include <vector>
+
+/* CLOCK (second chance) replace policy.
+ * Each frame only owns a small state word : whether the frame holds a page at all, whether it is pinned, and
+ * its reference bit. The frames are seen as a circular buffer, over which a hand sweeps when we need a candidate.
+ * A referenced frame gets its bit cleared and a second chance, the first unpinned and unreferenced frame is the candidate.
+ * use and release are a single atomic store on the state word, no list to maintain and no lock needed on the hit path.
+ * Only frames beyond the initial page count require the state table to grow, which is not safe to do concurrently.
+ */
+template<Endianness endian>
+class ClockPageReplacePolicy : public PageReplacePolicy<endian>
+{
+	public:
+	using PageIndex = typename PageReplacePolicy<endian>::PageIndex;
+
+	private:
+	using FrameState = uint8_t;
+
+	static constexpr FrameState presentBit = 1 << 0;
+	static constexpr FrameState referencedBit = 1 << 1;
+	static constexpr FrameState pinnedBit = 1 << 2;
+
+	public:
+	ClockPageReplacePolicy()
+	: ClockPageReplacePolicy(0)
+	{}
+
+	ClockPageReplacePolicy(size_type totalPageCount)
+	: frames_(totalPageCount),
+	  hand_{0}
+	{}
+
+	ClockPageReplacePolicy(const ClockPageReplacePolicy& other) = delete;
+	ClockPageReplacePolicy& operator=(const ClockPageReplacePolicy& other) = delete;
+
+	virtual void use(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		frames_[pageId].store(presentBit | referencedBit | pinnedBit, std::memory_order_relaxed);
+	}
+
+	virtual void release(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		frames_[pageId].store(presentBit | referencedBit, std::memory_order_relaxed);
+	}
+
+	virtual optional<PageIndex> getCandidate() override
+	{
+		const size_type frameCount = frames_.size();
+
+		// Two full turns are enough : the first one clears every reference bit, the second one finds the candidate.
+		for(size_type step = 0; step < 2 * frameCount; ++step)
+		{
+			PageIndex pageId = hand_;
+			hand_ = (hand_ + 1) % frameCount;
+
+			auto& frame = frames_[pageId];
+			FrameState state = frame.load(std::memory_order_relaxed);
+
+			if(!(state & presentBit) || (state & pinnedBit)) continue;
+
+			if(state & referencedBit)
+			{
+				// If the frame was pinned in the meantime, the exchange fails and the frame keeps its state.
+				frame.compare_exchange_strong(state, presentBit, std::memory_order_relaxed);
+				continue;
+			}
+
+			return pageId;
+		}
+
+		return {};
+	}
+
+	// As long as the policy was built for every frame of the buffer.
+	virtual bool isConcurrent() const noexcept override
+	{
+		return true;
+	}
+
+	bool isReferenced(PageIndex pageId) const noexcept
+	{
+		return (pageId < frames_.size()) && (frames_[pageId].load(std::memory_order_relaxed) & referencedBit);
+	}
+
+	private:
+
+	void reserve(PageIndex pageId)
+	{
+		if(pageId < frames_.size()) return;
+
+		std::vector<std::atomic<FrameState>> newFrames(pageId + 1);
+		for(size_type i = 0; i < frames_.size(); ++i)
+		{
+			newFrames[i].store(frames_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		frames_.swap(newFrames);
+	}
+
+	std::vector<std::atomic<FrameState>> frames_;
+	PageIndex hand_;
+};
+
+template<Endianness endian>
+constexpr typename ClockPageReplacePolicy<endian>::FrameState ClockPageReplacePolicy<endian>::presentBit;
+
+template<Endianness endian>
+constexpr typename ClockPageReplacePolicy<endian>::FrameState ClockPageReplacePolicy<endian>::referencedBit;
+
+template<Endianness endian>
+constexpr typename ClockPageReplacePolicy<endian>::FrameState ClockPageReplacePolicy<endian>::pinnedBit;
+
+#endif // CLOCK_PAGE_REPLACE_POLICY_HXX
@@ -0,0 +1,190 @@
+#ifndef COLUMN_BATCH_HXX
+#define COLUMN_BATCH_HXX
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+class QueryException : public std::exception
+{
+public:
+	QueryException(const std::string& msg) : msg_{std::string{"Error when building the query : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
+/* The columns of a batch hold the values of a field for up to ColumnBatch::capacity rows, decoded once from the rows :
+ * the integers, the dates (as year, month then day) and the booleans as unsigned integers, the floating point numbers
+ * as doubles, and the strings as they are in the rows, size bytes by value.
+ */
+enum class ColumnKind : flag_type
+{
+	unsignedInteger,
+	floatingPoint,
+	bytes
+};
+
+inline ColumnKind getColumnKind(DataType type) noexcept
+{
+	if((type == DataType::INTEGER) || (type == DataType::DATE) || (type == DataType::BOOLEAN)) return ColumnKind::unsignedInteger;
+	if((type == DataType::FLOAT) || (type == DataType::TIME)) return ColumnKind::floatingPoint;
+
+	return ColumnKind::bytes;
+}
+
+struct ColumnDescriptor
+{
+	std::string name;
+	// The type and size of the field the values come from.
+	DataType type;
+	size_type size;
+	ColumnKind kind;
+};
+
+// Only the vector of the kind of the column is used.
+struct ColumnVector
+{
+	std::vector<uint64_t> integers;
+	std::vector<double> floats;
+	std::vector<uint8_t> bytes;
+};
+
+/* The unit the batch operators exchange. The rows still selected are either all the rows, or, once filtered, the rows
+ * of the selection vector, by increasing index : a filter only shrinks the selection, the values are not moved.
+ */
+struct ColumnBatch
+{
+	static constexpr size_type capacity = 1024;
+
+	size_type getSelectedCount() const noexcept
+	{
+		return isFiltered ? selection.size() : rowCount;
+	}
+
+	size_type getSelectedRow(size_type index) const noexcept
+	{
+		return isFiltered ? selection[index] : index;
+	}
+
+	// Room for capacity rows in every column, the buffers are kept from a batch to the next.
+	void reset(const std::vector<ColumnDescriptor>& descriptors)
+	{
+		rowCount = 0;
+		isFiltered = false;
+		selection.clear();
+		columns.resize(descriptors.size());
+
+		for(size_type i = 0; i < descriptors.size(); ++i)
+		{
+			if(descriptors[i].kind == ColumnKind::unsignedInteger) columns[i].integers.resize(capacity);
+			else if(descriptors[i].kind == ColumnKind::floatingPoint) columns[i].floats.resize(capacity);
+			else columns[i].bytes.resize(capacity * descriptors[i].size);
+		}
+	}
+
+	size_type rowCount = 0;
+	bool isFiltered = false;
+	std::vector<uint32_t> selection;
+	std::vector<ColumnVector> columns;
+};
+
+/* Decodes a field of count rows into a column, from the row first of the column on : a loop by column rather than by
+ * row. The fields of the common sizes are loaded whole, which the compiler turns into plain loads, or a gather.
+ */
+template<Endianness endian>
+class ColumnDecoder
+{
+public:
+	static void decode(const ColumnDescriptor& column, size_type offset, const uint8_t* const* rows, size_type count, ColumnVector& out,
+					   size_type first = 0)
+	{
+		if(column.kind == ColumnKind::bytes)
+		{
+			for(size_type i = 0; i < count; ++i) std::memcpy(&out.bytes[(first + i) * column.size], rows[i] + offset, column.size);
+		}
+		else if(column.kind == ColumnKind::floatingPoint)
+		{
+			if(column.size == sizeof(float)) decodeAs<float>(rows, offset, count, out.floats.data() + first);
+			else decodeAs<double>(rows, offset, count, out.floats.data() + first);
+		}
+		else if(column.type == DataType::DATE)
+		{
+			for(size_type i = 0; i < count; ++i)
+			{
+				const uint8_t* field = rows[i] + offset;
+				out.integers[first + i] = (Utils::RawDataConverter<endian>::rawDataToInteger(field + 2, field + 4) << 16) | (field[1] << 8) | field[0];
+			}
+		}
+		else if(column.type == DataType::BOOLEAN)
+		{
+			for(size_type i = 0; i < count; ++i) out.integers[first + i] = (rows[i][offset] != 0);
+		}
+		else
+		{
+			switch(column.size)
+			{
+				case sizeof(uint8_t):
+					decodeAs<uint8_t>(rows, offset, count, out.integers.data() + first);
+					break;
+				case sizeof(uint16_t):
+					decodeAs<uint16_t>(rows, offset, count, out.integers.data() + first);
+					break;
+				case sizeof(uint32_t):
+					decodeAs<uint32_t>(rows, offset, count, out.integers.data() + first);
+					break;
+				case sizeof(uint64_t):
+					decodeAs<uint64_t>(rows, offset, count, out.integers.data() + first);
+					break;
+				default:
+					for(size_type i = 0; i < count; ++i)
+					{
+						const uint8_t* field = rows[i] + offset;
+						out.integers[first + i] = static_cast<uint64_t>(Utils::RawDataConverter<endian>::rawDataToStreamoff(field, field + column.size));
+					}
+			}
+		}
+	}
+
+private:
+	// The rows are written with the byte order of the host when it is little endian, as everywhere else in the database.
+	template<class T, class Out>
+	static void decodeAs(const uint8_t* const* rows, size_type offset, size_type count, Out* out) noexcept
+	{
+		for(size_type i = 0; i < count; ++i)
+		{
+			T value;
+			std::memcpy(&value, rows[i] + offset, sizeof(T));
+
+			if(endian == Endianness::big) Utils::rawDataSwitchEndianness(reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(T));
+
+			out[i] = value;
+		}
+	}
+};
+
+// An operator pulls the batches of its input, and fills the batch given by its caller, until it returns false.
+class BatchOperator
+{
+public:
+	virtual ~BatchOperator() = default;
+
+	virtual const std::vector<ColumnDescriptor>& getColumns() const noexcept = 0;
+
+	// The batch may have no row selected, the operator is done only once it returns false.
+	virtual bool next(ColumnBatch& batch) = 0;
+};
+
+#endif // COLUMN_BATCH_HXX
@@ -23,3 +23,38 @@ enum class PageType : uint8_t
 	Writable
 };
 
+// How the pages are read from, and written to, the database file (see PageReader and PageWriter).
+enum class IoBackend : flag_type
+{
+	stream,
+	positional
+};
+
+/* How a database is opened : read and written through the buffer, read and written through the buffer bypassing the
+ * cache of the system (direct I/O, which needs an aligned PageLayout), or mapped in memory and only read (see MappedFile). */
+enum class OpenMode : flag_type
+{
+	readWrite,
+	readWriteDirect,
+	readOnlyMapped
+};
+
+/* The raw size of the pages of a database file. Packed, a page is as big as its header and slots make it, and the pages
+ * follow each other wherever they end. Aligned, every page is padded to the same power of two size, holding as many
+ * slots as fit, so the pages start on the blocks of the device. Each value is the size of the aligned pages. */
+enum class PageLayout : size_type
+{
+	packed = 0,
+	aligned4K = 4096,
+	aligned8K = 8192,
+	aligned16K = 16384
+};
+
+// The positional backend needs pread and pwrite.
+#if (OS == LINUX) || (OS == MACOSX)
+#	define HAS_POSITIONAL_IO
+constexpr IoBackend defaultIoBackend = IoBackend::positional;
+#else
+constexpr IoBackend defaultIoBackend = IoBackend::stream;
+#endif
+
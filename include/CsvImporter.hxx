@@ -0,0 +1,280 @@
+#ifndef CSV_IMPORTER_HXX
+#define CSV_IMPORTER_HXX
+
+#include <Configuration.hxx>
+#include <BoundedQueue.hxx>
+#include <BulkLoader.hxx>
+#include <CsvRowEncoder.hxx>
+#include <DbSystem.hxx>
+#include <Range.hxx>
+#include <Schema.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CsvImportOptions
+{
+	char delimiter = ',';
+	bool hasHeader = false;
+	// The parsing threads, the file is read, and the rows written, by two other threads.
+	size_type threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	size_type chunkSize = 1 << 22;
+	// The chunks waiting between two stages, by queue.
+	size_type queueDepth = 8;
+};
+
+/* Loads a CSV file into the rows of a schema, in three stages running at the same time : a thread reads the file by
+ * chunks of whole lines, threadCount threads encode the chunks into rows, and the calling thread writes them, in the
+ * order of the file, through a BulkLoader. The stages are linked by bounded queues, and the number of chunks between the
+ * reader and the writer is bounded too, so the slowest stage, which should be the disk, sets the pace, and the memory
+ * used does not depend on the size of the file.
+ * A line break always ends a line, even in a quoted field. On the first invalid line, the import stops and throws,
+ * giving the line : the rows before it may already be written, they are kept.
+ */
+template<Endianness endian>
+class CsvImporter
+{
+public:
+	CsvImporter(DbSystem<endian>& system, const std::string& schemaName, CsvImportOptions options = {})
+	: system_{system},
+	  schemaName_{schemaName},
+	  schema_{*system.getSchema(*system.getSchemaIndex(schemaName))},
+	  options_{options}
+	{
+		options_.threadCount = std::max<size_type>(options_.threadCount, 1);
+		options_.chunkSize = std::max<size_type>(options_.chunkSize, 1);
+	}
+
+	// Returns the number of rows imported.
+	size_type import(const std::string& fileName)
+	{
+		std::ifstream file{fileName, std::ios::binary};
+
+		if(!file) throw CsvImportException("can not open " + fileName);
+
+		return import(file);
+	}
+
+	size_type import(std::istream& input)
+	{
+		Pipeline pipeline{options_.queueDepth, options_.threadCount};
+		std::vector<std::thread> threads;
+
+		threads.emplace_back([this, &pipeline, &input]() { pipeline.run([&]() { read(pipeline, input); }); });
+
+		for(size_type i = 0; i < options_.threadCount; ++i)
+		{
+			threads.emplace_back([this, &pipeline]() {
+				pipeline.run([&]() { parse(pipeline); });
+
+				if(++pipeline.finishedParsers == options_.threadCount) pipeline.rows.close();
+			});
+		}
+
+		size_type rowCount = 0;
+		pipeline.run([&]() { rowCount = write(pipeline); });
+
+		for(auto& thread : threads) thread.join();
+
+		if(pipeline.failure) std::rethrow_exception(pipeline.failure);
+
+		return rowCount;
+	}
+
+private:
+	struct Chunk
+	{
+		size_type sequence;
+		size_type firstLine;
+		std::string text;
+	};
+
+	struct ParsedChunk
+	{
+		size_type sequence;
+		size_type rowCount;
+		std::vector<uint8_t> rows;
+	};
+
+	struct Pipeline
+	{
+		/* A chunk is in flight from its read to its write. Without a limit, the chunks parsed after one still being parsed
+		 * would pile up while waiting for their turn to be written : there are at most as many as fit in the queues and
+		 * the parsers. */
+		Pipeline(size_type queueDepth, size_type threadCount)
+		: chunks{queueDepth},
+		  rows{queueDepth},
+		  inFlight{2 * queueDepth + threadCount},
+		  finishedParsers{0}
+		{}
+
+		// The first failure of a stage stops the others.
+		template<class Stage>
+		void run(Stage stage)
+		{
+			try
+			{
+				stage();
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock{failureMutex};
+
+				if(!failure) failure = std::current_exception();
+
+				chunks.close();
+				rows.close();
+				inFlight.close();
+			}
+		}
+
+		BoundedQueue<Chunk> chunks;
+		BoundedQueue<ParsedChunk> rows;
+		// One token by chunk in flight, pushed by the reader before the chunk, popped by the writer after it.
+		BoundedQueue<bool> inFlight;
+		std::atomic<size_type> finishedParsers;
+		std::mutex failureMutex;
+		std::exception_ptr failure;
+	};
+
+	// Cuts the input after the last line break of every chunkSize bytes, the end of the line goes to the next chunk.
+	void read(Pipeline& pipeline, std::istream& input)
+	{
+		std::string carry;
+		size_type sequence = 0;
+		size_type line = 1;
+		bool skipHeader = options_.hasHeader;
+
+		while(true)
+		{
+			std::string text = std::move(carry);
+			size_type carrySize = text.size();
+
+			text.resize(carrySize + options_.chunkSize);
+			input.read(&text[carrySize], options_.chunkSize);
+			text.resize(carrySize + input.gcount());
+
+			if(input.bad()) throw CsvImportException("can not read the file");
+
+			bool last = (input.gcount() == 0) || input.eof();
+			size_type lineEnd = last ? text.size() : text.rfind('\n');
+
+			if(lineEnd == std::string::npos)
+			{
+				// No line break yet, the line goes on in the next chunk.
+				carry = std::move(text);
+				continue;
+			}
+
+			if(!last)
+			{
+				++lineEnd;
+				carry.assign(text, lineEnd, std::string::npos);
+				text.resize(lineEnd);
+			}
+
+			size_type firstLine = line;
+			line += std::count(text.begin(), text.end(), '\n');
+
+			if(skipHeader && !text.empty())
+			{
+				size_type headerEnd = text.find('\n');
+
+				text.erase(0, (headerEnd == std::string::npos) ? text.size() : headerEnd + 1);
+				++firstLine;
+				skipHeader = false;
+			}
+
+			if(!pipeline.inFlight.push(true) || !pipeline.chunks.push(Chunk{sequence++, firstLine, std::move(text)}) || last) break;
+		}
+
+		pipeline.chunks.close();
+	}
+
+	void parse(Pipeline& pipeline)
+	{
+		CsvRowEncoder<endian> encoder{schema_, options_.delimiter};
+		size_type rowSize = schema_.getDataSize();
+		Chunk chunk;
+
+		while(pipeline.chunks.pop(chunk))
+		{
+			ParsedChunk parsed{chunk.sequence, 0, {}};
+			const char* it = chunk.text.data();
+			const char* end = it + chunk.text.size();
+			size_type line = chunk.firstLine;
+
+			for(; it != end; ++line)
+			{
+				const char* lineEnd = std::find(it, end, '\n');
+
+				if((lineEnd != it) && !((lineEnd - it == 1) && (*it == '\r')))
+				{
+					parsed.rows.resize(parsed.rows.size() + rowSize);
+
+					try
+					{
+						encoder.encode(it, lineEnd, parsed.rows.data() + parsed.rowCount * rowSize);
+					}
+					catch(const CsvImportException& e)
+					{
+						throw CsvImportException("line " + std::to_string(line), e);
+					}
+
+					++parsed.rowCount;
+				}
+
+				it = (lineEnd == end) ? end : lineEnd + 1;
+			}
+
+			if(!pipeline.rows.push(std::move(parsed))) return;
+		}
+	}
+
+	// The chunks are parsed in any order, they are written in the order of the file.
+	size_type write(Pipeline& pipeline)
+	{
+		BulkLoader<endian> loader{system_, schemaName_};
+		std::map<size_type, ParsedChunk> pending;
+		size_type nextSequence = 0;
+		size_type rowSize = schema_.getDataSize();
+		ParsedChunk parsed;
+		bool token;
+
+		while(pipeline.rows.pop(parsed))
+		{
+			pending.emplace(parsed.sequence, std::move(parsed));
+
+			for(auto it = pending.begin(); (it != pending.end()) && (it->first == nextSequence); it = pending.erase(it))
+			{
+				const uint8_t* row = it->second.rows.data();
+
+				for(size_type i = 0; i < it->second.rowCount; ++i, row += rowSize)
+				{
+					loader.add(range<const uint8_t*>{row, row + rowSize});
+				}
+
+				++nextSequence;
+				pipeline.inFlight.pop(token);
+			}
+		}
+
+		loader.finish();
+
+		return loader.getRowCount();
+	}
+
+	DbSystem<endian>& system_;
+	std::string schemaName_;
+	const DbSchema& schema_;
+	CsvImportOptions options_;
+};
+
+#endif // CSV_IMPORTER_HXX
@@ -0,0 +1,256 @@
+#ifndef CSV_ROW_ENCODER_HXX
+#define CSV_ROW_ENCODER_HXX
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Range.hxx>
+#include <Schema.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+class CsvImportException : public std::exception
+{
+public:
+	CsvImportException(const std::string& msg) : msg_{std::string{"Error when importing the CSV file : "} + msg}, reason_{msg}
+	{}
+
+	// The same error, with where it happened.
+	CsvImportException(const std::string& context, const CsvImportException& cause) : CsvImportException{context + ", " + cause.reason_}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+	// The error alone, without the message of the import.
+	const std::string& getReason() const noexcept
+	{
+		return reason_;
+	}
+
+private:
+	const std::string msg_;
+	const std::string reason_;
+};
+
+/* Encodes the lines of a CSV file into rows laid out as the rows of the schema, one field of the line by field of the
+ * schema, in the same order. A field may be quoted, a quote in a quoted field is then doubled.
+ * The strings are padded with null characters, the integers are unsigned, the dates are written day/month/year and the
+ * booleans as 1, 0, true or false.
+ */
+template<Endianness endian>
+class CsvRowEncoder
+{
+public:
+	CsvRowEncoder(const DbSchema& schema, char delimiter = ',')
+	: schema_{schema},
+	  delimiter_{delimiter}
+	{}
+
+	// The row must have the size of the rows of the schema. The line does not include its line break.
+	void encode(const char* begin, const char* end, uint8_t* row)
+	{
+		if((begin != end) && (end[-1] == '\r')) --end;
+
+		const char* it = begin;
+
+		for(size_type i = 0; i < schema_.getFieldCount(); ++i)
+		{
+			if(i > 0)
+			{
+				if((it == end) || (*it != delimiter_))
+				{
+					throw CsvImportException("expected " + std::to_string(schema_.getFieldCount()) + " fields, got " + std::to_string(i));
+				}
+
+				++it;
+			}
+
+			const FieldRef& field = schema_.getFieldRef(i);
+			range<const char*> value = nextField(it, end);
+
+			try
+			{
+				encodeField(field, value, row + field.offset);
+			}
+			catch(const CsvImportException& e)
+			{
+				throw CsvImportException("in the field " + schema_[i].name, e);
+			}
+		}
+
+		if(it != end)
+		{
+			throw CsvImportException("more than " + std::to_string(schema_.getFieldCount()) + " fields");
+		}
+	}
+
+	// A single value, unquoted, written at out as the field of a row.
+	void encodeField(const FieldRef& field, range<const char*> value, uint8_t* out)
+	{
+		DataType type = field.type;
+
+		if((type == DataType::CHARACTER) || (type == DataType::BINARY))
+		{
+			if(value.size() > field.size)
+			{
+				throw CsvImportException("the value is longer than the " + std::to_string(field.size) + " bytes of the field");
+			}
+
+			std::copy(value.begin(), value.end(), out);
+			std::fill(out + value.size(), out + field.size, 0);
+		}
+		else if(type == DataType::INTEGER)
+		{
+			uint64_t maximum = (field.size >= sizeof(uint64_t)) ? ~uint64_t{0} : ((uint64_t{1} << (8 * field.size)) - 1);
+
+			encodeInteger(parseInteger(value.begin(), value.end(), maximum), field.size, out);
+		}
+		else if((type == DataType::FLOAT) || (type == DataType::TIME))
+		{
+			encodeFloat(value, field.size, out);
+		}
+		else if(type == DataType::DATE)
+		{
+			encodeDate(value, out);
+		}
+		else if(type == DataType::BOOLEAN)
+		{
+			encodeBoolean(value, out);
+		}
+		else
+		{
+			throw CsvImportException("the type of the field can not be imported");
+		}
+	}
+
+private:
+	// Moves it to the delimiter following the field, or the end of the line.
+	range<const char*> nextField(const char*& it, const char* end)
+	{
+		if((it == end) || (*it != '"'))
+		{
+			const char* fieldBegin = it;
+			it = std::find(it, end, delimiter_);
+
+			return {fieldBegin, it};
+		}
+
+		unquoted_.clear();
+		++it;
+
+		while(true)
+		{
+			const char* quote = std::find(it, end, '"');
+
+			if(quote == end) throw CsvImportException("a quoted field is not closed");
+
+			unquoted_.append(it, quote);
+			it = quote + 1;
+
+			if((it == end) || (*it != '"')) break;
+
+			// A doubled quote.
+			unquoted_ += '"';
+			++it;
+		}
+
+		return {unquoted_.data(), unquoted_.data() + unquoted_.size()};
+	}
+
+	static uint64_t parseInteger(const char* begin, const char* end, uint64_t maximum)
+	{
+		if(begin == end) throw CsvImportException("an integer is empty");
+
+		uint64_t value = 0;
+
+		for(const char* it = begin; it != end; ++it)
+		{
+			if((*it < '0') || (*it > '9')) throw CsvImportException("'" + std::string{begin, end} + "' is not an unsigned integer");
+
+			uint64_t digit = *it - '0';
+
+			if(value > (maximum - digit) / 10) throw CsvImportException(std::string{begin, end} + " does not fit in the field");
+
+			value = value * 10 + digit;
+		}
+
+		return value;
+	}
+
+	// The integers of any size up to 64 bits, as rawDataToInteger reads them back.
+	static void encodeInteger(uint64_t value, size_type size, uint8_t* out)
+	{
+		Utils::RawDataAdaptator<uint64_t, sizeof(uint64_t), endian> adapt{value};
+		auto first = (endian == Endianness::little) ? adapt.bytes.begin() : adapt.bytes.end() - size;
+
+		std::copy(first, first + size, out);
+	}
+
+	void encodeFloat(range<const char*> value, size_type size, uint8_t* out)
+	{
+		// strtod needs a null terminated string.
+		number_.assign(value.begin(), value.end());
+
+		char* numberEnd = nullptr;
+		errno = 0;
+		double number = std::strtod(number_.c_str(), &numberEnd);
+
+		if(number_.empty() || (numberEnd != number_.c_str() + number_.size()) || (errno == ERANGE))
+		{
+			throw CsvImportException("'" + number_ + "' is not a floating point number");
+		}
+
+		if(size == sizeof(float))
+		{
+			Utils::RawDataAdaptator<float, sizeof(float), endian> adapt{static_cast<float>(number)};
+			std::copy(adapt.bytes.begin(), adapt.bytes.end(), out);
+		}
+		else if(size == sizeof(double))
+		{
+			Utils::RawDataAdaptator<double, sizeof(double), endian> adapt{number};
+			std::copy(adapt.bytes.begin(), adapt.bytes.end(), out);
+		}
+		else
+		{
+			throw CsvImportException("the floating point field has neither the size of a float nor of a double");
+		}
+	}
+
+	// A byte for the day, one for the month, and two for the year.
+	void encodeDate(range<const char*> value, uint8_t* out)
+	{
+		const char* daySeparator = std::find(value.begin(), value.end(), '/');
+		const char* monthSeparator = (daySeparator == value.end()) ? value.end() : std::find(daySeparator + 1, value.end(), '/');
+
+		if(monthSeparator == value.end()) throw CsvImportException("'" + std::string{value.begin(), value.end()} + "' is not a day/month/year date");
+
+		out[0] = static_cast<uint8_t>(parseInteger(value.begin(), daySeparator, 31));
+		out[1] = static_cast<uint8_t>(parseInteger(daySeparator + 1, monthSeparator, 12));
+
+		Utils::RawDataAdaptator<uint16_t, sizeof(uint16_t), endian> year{static_cast<uint16_t>(parseInteger(monthSeparator + 1, value.end(), 0xFFFF))};
+		std::copy(year.bytes.begin(), year.bytes.end(), out + 2);
+	}
+
+	static void encodeBoolean(range<const char*> value, uint8_t* out)
+	{
+		std::string str{value.begin(), value.end()};
+
+		if((str == "1") || (str == "true")) *out = 1;
+		else if((str == "0") || (str == "false")) *out = 0;
+		else throw CsvImportException("'" + str + "' is not a boolean");
+	}
+
+	const DbSchema& schema_;
+	char delimiter_;
+	std::string unquoted_;
+	std::string number_;
+};
+
+#endif // CSV_ROW_ENCODER_HXX
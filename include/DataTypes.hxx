@@ -36,7 +36,7 @@ class DataTypeDescriptor
 	  type_{other.type_}
 	{}
 
-	std::string toString()
+	std::string toString() const
 	{
 		std::string result;
 
@@ -66,23 +66,30 @@ class DataTypeDescriptor
 
 	size_type getSize() const noexcept
 	{
-		size_t result = modifier_;
+		return getSize(type_, modifier_);
+	}
+
+	// Also usable at compile time, for the typed schemas.
+	static constexpr size_type getSize(DataType type, size_type modifier) noexcept
+	{
+		size_type result = modifier;
 
-		if((type_ == DataType::FLOAT) || (type_ == DataType::TIME))
+		if((type == DataType::FLOAT) || (type == DataType::TIME))
 		{ 
-			result =  4 * ceil(static_cast<float>(modifier_)/24);
+			// 4 bytes by 24 bits of precision, rounded up.
+			result = 4 * ((modifier + 23) / 24);
 		}
-		else if(type_ == DataType::DATE) 
+		else if(type == DataType::DATE) 
 		{	
 			result = dateTypeSize;
 		}
-		else if(type_ == DataType::BOOLEAN) 
+		else if(type == DataType::BOOLEAN) 
 		{
 			result = booleanTypeSize;
 		}
-		else if(type_ == DataType::INTEGER)
+		else if(type == DataType::INTEGER)
 		{
-			result = modifier_ != 0 ? (modifier_ / 8) : 8; 
+			result = modifier != 0 ? (modifier / 8) : 8; 
 		}
 
 		return result;
@@ -3,7 +3,10 @@
 
 #include <Schema.hxx>
 #include <Configuration.hxx>
+#include <Range.hxx>
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 namespace {
@@ -46,45 +49,41 @@ protected:
 
 }
 
-/* WARNING : The DbSchema must be persistent, should it be destroyed at on point, the DbEntry would become unusable */
 template<Endianness endian>
-class DbEntry
+class DbEntry;
+
+/* A row read in place, straight from the bytes of its slot : nothing is copied, nor allocated, to read it.
+ * WARNING : The view does not own the bytes, it is only valid as long as they are (for a row of a page, as long as the
+ * page is pinned, by the handle of an iterator for instance). As for the DbEntry, the DbSchema must be persistent.
+ * Copy it into a DbEntry to keep the row, or to change it.
+ */
+template<Endianness endian>
+class DbEntryView
 {
 private:
 	template<class T, class = void>
 	struct Getter;
 
-	template<class T, class = void>
-	struct Setter;
-
 public:
-
-	/*template<class T>
-	DbEntry(const DbSchema& schema, std::vector<T>& data) 
+	DbEntryView(const DbSchema& schema, const uint8_t* data) noexcept
 	: schema_{schema},
-	  storage_(data.begin(), data.end())
-	{}*/
-
-	template<class T>
-	DbEntry(const DbSchema& schema, const std::vector<T>& data) 
-	: schema_{schema},
-	  storage_(data.begin(), data.end())
+	  data_{data}
 	{}
 
 	std::string toString() const noexcept
 	{
 		std::string result;
-		auto it = this->storage_.begin();
-		
+		const uint8_t* it = data_;
+
 		for(size_type i = 0; i < schema_.getFieldCount(); ++i)
 		{
-			auto fieldDescriptor = schema_[i];
+			const auto& fieldDescriptor = schema_[i];
 			auto typeDescriptor = fieldDescriptor.type;
 			result += fieldDescriptor.name + " : ";
 			result += Utils::RawDataStringizer<endian>::stringize(it, it + typeDescriptor.getSize(), typeDescriptor.getType());
 			result += '\n';
 			it += typeDescriptor.getSize();
-		}	
+		}
 
 		return result;
 	}
@@ -102,7 +101,81 @@ public:
 	template<class T>
 	T getAs(size_type index) const
 	{
-		return Getter<T>::get(*this, index);
+		return getAs<T>(schema_.getFieldRef(index));
+	}
+
+	// The field must have been resolved from the schema of the row.
+	template<class T>
+	T getAs(const FieldRef& field) const
+	{
+		return Getter<T>::get(data_ + field.offset, field.size);
+	}
+
+	range<const uint8_t*> getRawData() const noexcept
+	{
+		return {data_, data_ + schema_.getDataSize()};
+	}
+
+	const DbSchema& getSchema() const noexcept
+	{
+		return schema_;
+	}
+
+private:
+
+	const DbSchema& schema_;
+	const uint8_t* data_;
+};
+
+/* WARNING : The DbSchema must be persistent, should it be destroyed at on point, the DbEntry would become unusable */
+template<Endianness endian>
+class DbEntry
+{
+private:
+	template<class T, class = void>
+	struct Setter;
+
+public:
+
+	/*template<class T>
+	DbEntry(const DbSchema& schema, std::vector<T>& data) 
+	: schema_{schema},
+	  storage_(data.begin(), data.end())
+	{}*/
+
+	template<class T>
+	DbEntry(const DbSchema& schema, const std::vector<T>& data) 
+	: schema_{schema},
+	  storage_(data.begin(), data.end())
+	{}
+
+	// A copy of the row, which may then be changed and written back.
+	explicit DbEntry(const DbEntryView<endian>& view)
+	: schema_{view.getSchema()},
+	  storage_(view.getRawData().begin(), view.getRawData().end())
+	{}
+
+	std::string toString() const noexcept
+	{
+		return getView().toString();
+	}
+
+	template<class T>
+	T getAs(const std::string& fieldName) const
+	{
+		return getView().template getAs<T>(fieldName);
+	}
+
+	template<class T>
+	T getAs(size_type index) const
+	{
+		return getView().template getAs<T>(index);
+	}
+
+	template<class T>
+	T getAs(const FieldRef& field) const
+	{
+		return getView().template getAs<T>(field);
 	}
 
 	// TODO : Add type check and row existence check
@@ -134,6 +207,12 @@ public:
 		return schema_;
 	}
 
+	// Only valid until the entry is destroyed or its raw data resized.
+	DbEntryView<endian> getView() const noexcept
+	{
+		return {schema_, storage_.data()};
+	}
+
 	private:
 
 	const DbSchema& schema_;
@@ -144,61 +223,44 @@ public:
 
 template<Endianness endian>
 template<class T>
-struct DbEntry<endian>::Getter<T, Meta::void_t<std::enable_if_t<std::is_integral<T>::value>>>
+struct DbEntryView<endian>::Getter<T, Meta::void_t<std::enable_if_t<std::is_integral<T>::value>>>
 {
-	static T get(const DbEntry<endian>& entry, size_type index)
+	static T get(const uint8_t* field, size_type size)
 	{
-		auto field = entry.getSchema()[index];
-		size_type fieldOffset = entry.getSchema().getFieldOffset(index);
-
-		return Utils::RawDataConverter<endian>::rawDataToInteger(entry.getRawData().begin() + fieldOffset, entry.getRawData().begin() + fieldOffset + field.type.getSize());
+		return Utils::RawDataConverter<endian>::rawDataToInteger(field, field + size);
 	}
 };
 
 template<Endianness endian>
 template<class Dummy>
-struct DbEntry<endian>::Getter<float, Dummy>
+struct DbEntryView<endian>::Getter<float, Dummy>
 {
-	static float get(const DbEntry<endian>& entry, size_type index)
+	static float get(const uint8_t* field, size_type size)
 	{
-		auto field = entry.getSchema()[index];
-		size_type fieldOffset = entry.getSchema().getFieldOffset(index);	
-
-		return Utils::RawDataConverter<endian>::rawDataToFloat(entry.getRawData().begin() + fieldOffset, entry.getawData().begin() +  fieldOffset + field.type.getSize());
+		return Utils::RawDataConverter<endian>::rawDataToFloat(field, field + size);
 	}
 };
 
 template<Endianness endian>
 template<class Dummy>
-struct DbEntry<endian>::Getter<double, Dummy>
+struct DbEntryView<endian>::Getter<double, Dummy>
 {
-	static double get(const DbEntry<endian>& entry, size_type index)
+	static double get(const uint8_t* field, size_type size)
 	{
-		auto field = entry.getSchema()[index];
-		size_type fieldOffset = entry.getSchema().getFieldOffset(index);	
-
-		return Utils::RawDataConverter<endian>::rawDataToDouble(entry.getRawData().begin() + fieldOffset, entry.getRawData().begin() + fieldOffset + field.type.getSize());
+		return Utils::RawDataConverter<endian>::rawDataToDouble(field, field + size);
 	}
 };
 
 template<Endianness endian>
 template<class Dummy>
-struct DbEntry<endian>::Getter<std::string, Dummy>
+struct DbEntryView<endian>::Getter<std::string, Dummy>
 {
-	static std::string get(const DbEntry<endian>& entry, size_type index)
+	static std::string get(const uint8_t* field, size_type size)
 	{
-		auto field = entry.getSchema()[index];
-		size_type fieldOffset = entry.getSchema().getFieldOffset(index);
+		// Up to the first null character, if any.
+		const uint8_t* end = std::find(field, field + size, '\0');
 
-		std::string tmp{entry.getRawData().begin() + fieldOffset, entry.getRawData().begin() + fieldOffset + field.type.getSize()};
-		auto it = tmp.find_first_of('\0');
-
-		if(it != std::string::npos)
-		{
-			tmp = tmp.substr(0, it);
-		}
-
-		return tmp;
+		return {field, end};
 	}
 };
 
@@ -206,7 +268,7 @@ template<Endianness endian>
 template<class T, class Dummy>
 struct DbEntry<endian>::Setter
 {
-	static void set(std::vector<uint8_t>& storage, const DbSchema& schema, size_type index, std::string value)
+	static void set(std::vector<uint8_t>& storage, const DbSchema& schema, size_type index, T value)
 	{
 		Utils::RawDataAdaptator<T, sizeof(T), endian> adapt{value};
 		size_type offset = schema.getFieldOffset(index);
@@ -55,7 +55,6 @@ class DbSchemaSerializer// : public DbSchemaSerializerBase<endian>
 		}
 
 		Utils::RawDataAdaptator<decltype(offset), sizeof(decltype(totalSize)), endian> schemaSize = totalSize - sizeof(size_type);
-		std::cout << sizeof(decltype(totalSize)) << std::endl;
 		std::copy(schemaSize.bytes.begin(), schemaSize.bytes.end(), result.begin());
 	
 		return result;
@@ -6,8 +6,13 @@
 #include <FileValueReader.hxx>
 #include <Optional.hxx>
 #include <BufferManager.hxx>
-#include <PageWriter.hxx>
+#include <Catalog.hxx>
+#include <Predicate.hxx>
+#include <gsl/gsl_assert.h>
 
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -16,11 +21,23 @@ template<Endianness endian>
 class DbSystem;
 
 template<Endianness endian>
+class BulkLoader;
+
+template<Endianness endian>
+class BatchScan;
+
+/* Walks the rows of a schema, page after page along its chain. A read only iterator only takes shared latches on the
+ * pages, and is the only one available when the database is opened read only.
+ * The rows are views on the bytes of the current page, which stays pinned as long as the iterator is on it : a scan
+ * allocates nothing by row. */
+template<Endianness endian, PageType type = PageType::Writable>
 class DbIterator
 {
 
 friend class DbSystem<endian>;
 
+using PageReference = std::conditional_t<type == PageType::ReadOnly, const DiskPage<endian>&, DiskPage<endian>&>;
+
 public:
 	DbIterator(BufferManager<endian>& bufferManager, const DbSchema& schema)
 	: bufferManager_{bufferManager},
@@ -28,17 +45,17 @@ public:
 	  pageHandle_{},
 	  currentEntryIndex_{0}
 	{
-		pageHandle_ = bufferManager_.template requestFirstPage<PageType::Writable>(schema.getName());
+		pageHandle_ = bufferManager_.template requestFirstPage<type>(schema.getName());
+		moveToUsedSlot();
 	}
 
-	DbEntry<endian> operator*() noexcept
+	// The row is read in place, in the pinned page : the view is only valid until the iterator moves.
+	DbEntryView<endian> operator*() const noexcept
 	{
-		auto dataStart = pageHandle_.get()->getData().begin() + (currentEntryIndex_ * schema_.getDataSize());
-		std::vector<uint8_t> tmp(dataStart, dataStart + schema_.getDataSize());
-		return {schema_, tmp};
+		return {schema_, pageHandle_.get()->getData().begin() + (currentEntryIndex_ * schema_.getDataSize())};
 	}
 
-	DiskPage<endian>& getPage() noexcept
+	PageReference getPage() noexcept
 	{
 		return *pageHandle_.get();
 	}
@@ -52,22 +69,14 @@ public:
 	{
 		if(pageHandle_)
 		{
-			do
-			{
-				++currentEntryIndex_;
-			
-				if(currentEntryIndex_ >= pageHandle_.get()->getPageSize())
-				{
-					pageHandle_ = bufferManager_.template requestNextPage<PageType::Writable>(*pageHandle_.get());
-					currentEntryIndex_ = 0;
-				}
-			} while(pageHandle_ && pageHandle_.get()->isFree(currentEntryIndex_));
+			++currentEntryIndex_;
+			moveToUsedSlot();
 		}
 
 		return *this;
 	}
 
-	bool operator==(const DbIterator<endian>& other)
+	bool operator==(const DbIterator<endian, type>& other)
 	{
 		return ((&bufferManager_ == &other.bufferManager_)
 			&& (&schema_ == &other.schema_)
@@ -75,13 +84,27 @@ public:
 			&& (currentEntryIndex_ == other.currentEntryIndex_));
 	}
 
-	bool operator!=(const DbIterator<endian>& other)
+	bool operator!=(const DbIterator<endian, type>& other)
 	{
 		return !(*this == other);
 	}
 
 private:
 
+	// Moves to the first used slot from the current one on, through the slot bitmaps, a word of slots at a time.
+	void moveToUsedSlot()
+	{
+		while(pageHandle_)
+		{
+			currentEntryIndex_ = pageHandle_.get()->findNextUsedIndex(currentEntryIndex_);
+
+			if(currentEntryIndex_ < pageHandle_.get()->getPageSize()) return;
+
+			pageHandle_ = bufferManager_.template requestNextPage<type>(*pageHandle_.get());
+			currentEntryIndex_ = 0;
+		}
+	}
+
 	// The "end" constructor, used by the DbSystem to create the end iterator
 	DbIterator(BufferManager<endian>& bufferManager, const DbSchema& schema, bool)
 	: bufferManager_{bufferManager},
@@ -92,13 +115,16 @@ private:
 
 	BufferManager<endian>& bufferManager_;
 	const DbSchema& schema_;
-	BufferedPageHandle<endian, PageType::Writable> pageHandle_;
+	BufferedPageHandle<endian, type> pageHandle_;
 	size_type currentEntryIndex_;
 };
 
 template<Endianness endian>
 class DbSystem
 {
+	friend class BulkLoader<endian>;
+	friend class BatchScan<endian>;
+
 	static constexpr size_type defaultPageSize = 512;
 
 	public:
@@ -107,33 +133,62 @@ class DbSystem
 	  schemaFile_{schemaFile},
 	  bufferManager_{dbFile},
 	  pageSize_{pageSize},
-	  lastOffsetMap_{}
+	  pageLayout_{PageLayout::packed},
+	  lastOffsetMap_{},
+	  catalog_{getCatalogFileName(dbFile)}
 	{
-		FileValueReader<endian> schemaReader{schemaFile};
-		schemaReader.rewind();
-		while(!schemaReader.eof())
-		{
-			size_type serialDataSize = schemaReader.readValue(8);
+		loadSchemas();
+	}
 
-			std::vector<uint8_t> serialData(serialDataSize);
-			schemaReader.read(serialData, serialDataSize);
+	DbSystem(std::string dbFile, std::string schemaFile, size_type pageSize, size_type bufferSize, std::unique_ptr<PageReplacePolicy<endian>> replacePolicy)
+	: dbFile_{dbFile},
+	  schemaFile_{schemaFile},
+	  bufferManager_{dbFile, bufferSize, std::move(replacePolicy)},
+	  pageSize_{pageSize},
+	  pageLayout_{PageLayout::packed},
+	  lastOffsetMap_{},
+	  catalog_{getCatalogFileName(dbFile)}
+	{
+		loadSchemas();
+	}
 
-			schemaList_.push_back(DbSchemaSerializer<endian>::deserialize(serialData));
-			schemaMapping_[schemaList_.back().getName()] = schemaList_.size() - 1;
-		}
-		std::cout << schemaList_.size() << std::endl;
-		for(const DbSchema& schema : schemaList_)
-		{
-			auto offset = bufferManager_.lookForLastPage(schema.getName());
-			if(offset)
-			{
-				lastOffsetMap_.insert({schema.getName(), *offset});
-			}
-		}
+	/* Opened read only and mapped (see OpenMode and BufferManager), the pages are read straight from the mapping of the
+	 * file, and nothing is ever written : not the pages, nor the catalog, nor the schemas. Only the read only iterators
+	 * can be used, the modifications throw a ReadOnlyDatabaseException.
+	 * With an aligned layout, the new pages are padded to the size of the layout, with as many slots as fit, instead of
+	 * the page size. The layout is chosen when the file is created, and the direct I/O needs one. */
+	DbSystem(std::string dbFile, std::string schemaFile, OpenMode mode, PageLayout layout = PageLayout::packed)
+	: dbFile_{dbFile},
+	  schemaFile_{schemaFile},
+	  bufferManager_{dbFile, mode, layout},
+	  pageSize_{defaultPageSize},
+	  pageLayout_{layout},
+	  lastOffsetMap_{},
+	  catalog_{getCatalogFileName(dbFile)}
+	{
+		loadSchemas();
+	}
+
+	static std::unique_ptr<DbSystem> openReadOnlyMapped(std::string dbFile, std::string schemaFile, PageLayout layout = PageLayout::packed)
+	{
+		return std::make_unique<DbSystem>(dbFile, schemaFile, OpenMode::readOnlyMapped, layout);
 	}
 
 	~DbSystem()
 	{
+		if(bufferManager_.isReadOnly()) return;
+
+		/* The row counts and the free space map are only committed here, once the pages are written, the page chains are
+		 * committed as soon as they change. The catalog is committed clean last : until then, the metadata is rebuilt
+		 * when the database is opened again. */
+		bufferManager_.close();
+		bufferManager_.getFreeSpaceMap().commit(bufferManager_.getDatabaseFileSize());
+
+		{
+			std::lock_guard<std::mutex> lock{catalogMutex_};
+			catalog_.commit(true);
+		}
+
 		FileValueWriter<endian> schemaWriter{schemaFile_};
 
 		for(auto& schema : schemaList_)
@@ -169,41 +224,61 @@ class DbSystem
 
 	void add(const DbEntry<endian>& entry)
 	{
+		std::lock_guard<std::mutex> lock{addMutex_};
+
 		// Make sure that the entry has a valid schema ?
 		auto freePageHandle = bufferManager_.template requestFreePage<PageType::Writable>(entry.getSchema());
-		if(freePageHandle.get())
-		{
-			freePageHandle.get()->add(entry);
-		}
-		else
+		if(!freePageHandle.get() || !freePageHandle.get()->add(entry))
 		{
+			// The last page of the schema may be the one we hold, and the latches are not recursive.
+			freePageHandle.reset({});
 			addNewPage(entry);
 		}
+
+		changeRowCount(entry.getSchema().getName(), 1);
+	}
+
+	// The catalog entry of the schema, if it has any page.
+	optional<CatalogEntry> getCatalogEntry(const std::string& schemaName)
+	{
+		std::lock_guard<std::mutex> lock{catalogMutex_};
+		auto entry = catalog_.getEntry(schemaName);
+
+		if(!entry) return {};
+
+		return *entry;
 	}
 
-	DbIterator<endian> getIterator(const std::string& schemaName) noexcept
+	template<PageType type = PageType::Writable>
+	DbIterator<endian, type> getIterator(const std::string& schemaName)
 	{
 		auto schemaIndex = getSchemaIndex(schemaName);
+
+		// The pages of a schema mostly follow each other in the file, let the system read them ahead if it can.
+		auto entry = getCatalogEntry(schemaName);
+		if(entry) bufferManager_.adviseScan(entry->firstPageOffset, entry->lastPageOffset);
+
 		return {bufferManager_, *getSchema(*schemaIndex)};
 	}
 
-	DbIterator<endian> endIterator(const std::string& schemaName) noexcept
+	template<PageType type = PageType::Writable>
+	DbIterator<endian, type> endIterator(const std::string& schemaName) noexcept
 	{
 		auto schemaIndex = getSchemaIndex(schemaName);
 		return {bufferManager_, *getSchema(*schemaIndex), true}; 
 	}
 
+	// Only the rows to update are copied.
 	template<class T>
-	void updateWhen(const std::string& schemaName, const std::string& updatedField, T value, std::function<bool(DbEntry<endian>&)> pred)
+	void updateWhen(const std::string& schemaName, const std::string& updatedField, T value, std::function<bool(const DbEntryView<endian>&)> pred)
 	{
 		auto it = getIterator(schemaName);
 
 		while(it != endIterator(schemaName))
 		{
-			auto entry = *it;
-
-			if(pred(entry))
+			if(pred(*it))
 			{
+				DbEntry<endian> entry{*it};
 				entry.template setAs<T>(updatedField, value);
 				it.getPage().replace(it.getCurrentIndex(), entry);
 			}
@@ -212,59 +287,297 @@ class DbSystem
 		}
 	}
 
-	void removeWhen(const std::string& schemaName, std::function<bool(DbEntry<endian>&)> pred)
+	void removeWhen(const std::string& schemaName, std::function<bool(const DbEntryView<endian>&)> pred)
 	{
 		auto it = getIterator(schemaName);
 
 		while(it != endIterator(schemaName))
 		{
-			auto entry =  *it;
-			std::cout << "Extra" << std::endl;
+			auto entry = *it;
 			if(pred(entry))
 			{
-				std::cout << entry.toString() << std::endl;
 				it.getPage().remove(it.getCurrentIndex());
+				changeRowCount(schemaName, -1);
 			}
 			++it;
-
-			std::cout << "Nul" << std::endl;
 		}
 	}
 
+	/* The predicate is evaluated in place, on the rows in the pages, a page at a time (see BoundPredicate::matchSlots) :
+	 * the rows which do not match are never copied, and the pages without any match are not written back.
+	 * The value is written as is : a string must fit the field, any other value must have its size.
+	 * The count of updated rows is returned. */
+	template<class T>
+	size_type updateWhen(const std::string& schemaName, const std::string& updatedField, T value, const Predicate& pred)
+	{
+		const DbSchema& schema = *getSchema(*getSchemaIndex(schemaName));
+		FieldRef field = *schema.findFieldRef(updatedField);
+
+		Expects(fitsField(value, field.size));
+
+		// The new value is written once, then copied in every matching row.
+		DbEntry<endian> updated{schema, std::vector<uint8_t>(schema.getDataSize())};
+		updated.template setAs<T>(field.index, value);
+
+		return updateWhen(schemaName, {field}, updated.getRawData(), pred);
+	}
+
+	// The updated fields are copied from values, laid out as a row of the schema.
+	size_type updateWhen(const std::string& schemaName, const std::vector<FieldRef>& updatedFields, const std::vector<uint8_t>& values,
+						 const Predicate& pred)
+	{
+		const DbSchema& schema = *getSchema(*getSchemaIndex(schemaName));
+		std::vector<uint8_t> row(schema.getDataSize());
+		size_type updatedCount = 0;
+
+		scanWhere(schema, pred, [&](DiskPage<endian>& page, size_type index, const uint8_t* rawRow) {
+			std::copy(rawRow, rawRow + row.size(), row.begin());
+
+			for(const auto& field : updatedFields)
+			{
+				std::copy(values.begin() + field.offset, values.begin() + field.offset + field.size, row.begin() + field.offset);
+			}
+
+			page.replace(index, range<const uint8_t*>{row.data(), row.data() + row.size()});
+			++updatedCount;
+		});
+
+		return updatedCount;
+	}
+
+	// The count of removed rows is returned.
+	size_type removeWhen(const std::string& schemaName, const Predicate& pred)
+	{
+		const DbSchema& schema = *getSchema(*getSchemaIndex(schemaName));
+		int64_t removedCount = 0;
+
+		scanWhere(schema, pred, [&removedCount](DiskPage<endian>& page, size_type index, const uint8_t*) {
+			page.remove(index);
+			++removedCount;
+		});
+
+		if(removedCount > 0) changeRowCount(schemaName, -removedCount);
+
+		return static_cast<size_type>(removedCount);
+	}
+
 	private:
 
-	void addNewPage(const DbEntry<endian>& entry)
+	static bool fitsField(const std::string& value, size_type fieldSize) noexcept
+	{
+		return value.size() <= fieldSize;
+	}
+
+	static bool fitsField(const char* value, size_type fieldSize) noexcept
+	{
+		return std::strlen(value) <= fieldSize;
+	}
+
+	template<class T>
+	static bool fitsField(const T&, size_type fieldSize) noexcept
+	{
+		return sizeof(T) == fieldSize;
+	}
+
+	// Calls action with the page, the slot and the bytes of every row matching the predicate, page after page.
+	template<class Action>
+	void scanWhere(const DbSchema& schema, const Predicate& pred, Action action)
+	{
+		BoundPredicate<endian> boundPredicate{pred, schema};
+		size_type rowSize = schema.getDataSize();
+
+		auto entry = getCatalogEntry(schema.getName());
+		if(entry) bufferManager_.adviseScan(entry->firstPageOffset, entry->lastPageOffset);
+
+		auto pageHandle = bufferManager_.template requestFirstPage<PageType::Writable>(schema.getName());
+		std::vector<uint8_t> mask;
+
+		while(pageHandle)
+		{
+			DiskPage<endian>& page = *pageHandle.get();
+			const uint8_t* rows = page.getData().begin();
+			size_type slotCount = page.getPageSize();
+
+			// The predicate is evaluated for the whole page first, the action may then change the slots.
+			mask.resize(SlotBitmap::getSize(slotCount));
+			boundPredicate.matchSlots(rows, page.getSlotBitmap().begin(), slotCount, mask.data());
+
+			for(size_type index = SlotBitmap::findNextUsed(mask.data(), 0, slotCount); index < slotCount;
+				index = SlotBitmap::findNextUsed(mask.data(), index + 1, slotCount))
+			{
+				action(page, index, rows + index * rowSize);
+			}
+
+			pageHandle = bufferManager_.template requestNextPage<PageType::Writable>(page);
+		}
+	}
+
+	void loadSchemas()
+	{
+		FileValueReader<endian> schemaReader{schemaFile_};
+		schemaReader.rewind();
+		while(!schemaReader.eof())
+		{
+			size_type serialDataSize = schemaReader.readValue(8);
+
+			std::vector<uint8_t> serialData(serialDataSize);
+			schemaReader.read(serialData, serialDataSize);
+
+			schemaList_.push_back(DbSchemaSerializer<endian>::deserialize(serialData));
+			schemaMapping_[schemaList_.back().getName()] = schemaList_.size() - 1;
+		}
+
+		/* A catalog or a free space map older than the file, or missing, is rebuilt with a single pass over the file. So
+		 * are both when the database was not closed : the row counts and the free pages may be behind the file. */
+		const FreeSpaceMap<endian>& freeSpaceMap = bufferManager_.getFreeSpaceMap();
+		std::streamoff fileSize = bufferManager_.getDatabaseFileSize();
+
+		if(!catalog_.isValid() || !catalog_.isClean() || (catalog_.getDatabaseFileSize() != fileSize)
+		|| !freeSpaceMap.isValid() || (freeSpaceMap.getDatabaseFileSize() != fileSize))
+		{
+			rebuildMetadata();
+		}
+		else if(!bufferManager_.isReadOnly())
+		{
+			// Until it is closed, the database is not clean anymore.
+			catalog_.commit();
+		}
+
+		for(const auto& entry : catalog_.getEntries())
+		{
+			bufferManager_.setFirstPageOffset(entry.first, entry.second.firstPageOffset);
+			lastOffsetMap_.insert({entry.first, entry.second.lastPageOffset});
+		}
+	}
+
+	static std::string getCatalogFileName(const std::string& dbFile)
+	{
+		return dbFile + ".cat";
+	}
+
+	// Rebuilds the catalog and the free space map. The pages of a schema are appended to the file in the order of their chain.
+	void rebuildMetadata()
+	{
+		catalog_.clear();
+
+		FreeSpaceMap<endian>& freeSpaceMap = bufferManager_.getFreeSpaceMap();
+		freeSpaceMap.clear();
+
+		std::unordered_map<std::string, CatalogEntry> entries;
+
+		bufferManager_.forEachPageHeader([&entries, &freeSpaceMap](std::streamoff offset, const DiskPageHeader<endian>& header) {
+			auto it = entries.find(header.getSchemaName());
+
+			if(it == entries.end())
+			{
+				it = entries.insert({header.getSchemaName(), CatalogEntry{offset, offset, 0, 0}}).first;
+			}
+
+			it->second.lastPageOffset = offset;
+			++it->second.pageCount;
+			it->second.rowCount += header.getPageSize() - header.getFreeSlotCount();
+
+			if(!header.isFull()) freeSpaceMap.update(header.getSchemaName(), offset, true);
+		});
+
+		for(const auto& entry : entries)
+		{
+			catalog_.setEntry(entry.first, entry.second);
+		}
+
+		std::streamoff fileSize = bufferManager_.getDatabaseFileSize();
+
+		catalog_.setDatabaseFileSize(fileSize);
+		freeSpaceMap.setValid(fileSize);
+
+		// Opened read only, the rebuilt metadata only lives as long as the DbSystem.
+		if(bufferManager_.isReadOnly()) return;
+
+		catalog_.commit();
+		freeSpaceMap.commit(fileSize);
+	}
+
+	void changeRowCount(const std::string& schemaName, int64_t delta)
 	{
+		std::lock_guard<std::mutex> lock{catalogMutex_};
+		auto entry = catalog_.getEntry(schemaName);
 
-		DiskPage<endian> newPage{0, entry.getSchema(), pageSize_};
-		PageWriter<endian> pgWriter{dbFile_};
+		if(entry)
+		{
+			CatalogEntry newEntry = *entry;
+			newEntry.rowCount += delta;
+			catalog_.setEntry(schemaName, newEntry);
+		}
+	}
 
-		std::streamoff newOffset = pgWriter.getFileSize();
+	// A new, empty page of the schema : as many slots as the page size, or as fit in the layout.
+	DiskPage<endian> makePage(const DbSchema& schema) const
+	{
+		return (pageLayout_ == PageLayout::packed) ? DiskPage<endian>{0, schema, pageSize_}
+												   : DiskPage<endian>{0, schema, pageLayout_};
+	}
+
+	void addNewPage(const DbEntry<endian>& entry)
+	{
+		DiskPage<endian> newPage = makePage(entry.getSchema());
+		std::streamoff newOffset = bufferManager_.getDatabaseFileSize();
 
 		newPage.add(entry);
-		pgWriter.appendPage(newPage);
+		bufferManager_.appendPage(newPage, newOffset);
 
-		auto lastPageOffset = lastOffsetMap_.find(entry.getSchema().getName());
+		bufferManager_.getFreeSpaceMap().update(entry.getSchema().getName(), newOffset, !newPage.isFull());
+		linkNewPages(entry.getSchema().getName(), newOffset, newOffset, 1, newOffset + newPage.getRawPageSize());
+	}
+
+	/* Links a run of pages just appended to the file, already chained together, at the end of the chain of the schema.
+	 * Only the last page of the chain is written again. The pages and the link to them are then on disk, and the catalog
+	 * can point to them. */
+	void linkNewPages(const std::string& schemaName, std::streamoff firstOffset, std::streamoff lastOffset, size_type pageCount,
+					  std::streamoff fileSize)
+	{
+		auto lastPageOffset = lastOffsetMap_.find(schemaName);
 
 		if(lastPageOffset != lastOffsetMap_.end())
 		{
 			auto lastPageHandle = bufferManager_.template requestPage<PageType::Writable>(lastPageOffset->second);
-			lastPageHandle.get()->setNextPageOffset(newOffset);
+			lastPageHandle.get()->setNextPageOffset(firstOffset);
 			bufferManager_.flush(lastPageHandle.get()->getIndex());
 
-			lastOffsetMap_[entry.getSchema().getName()] = newOffset;
+			lastPageOffset->second = lastOffset;
+		}
+		else
+		{
+			bufferManager_.setFirstPageOffset(schemaName, firstOffset);
+			lastOffsetMap_.insert({schemaName, lastOffset});
 		}
 
-		lastOffsetMap_.insert({entry.getSchema().getName(), newOffset});
+		std::lock_guard<std::mutex> lock{catalogMutex_};
+		auto catalogEntry = catalog_.getEntry(schemaName);
+		CatalogEntry newEntry = catalogEntry ? *catalogEntry : CatalogEntry{firstOffset, firstOffset, 0, 0};
+
+		newEntry.lastPageOffset = lastOffset;
+		newEntry.pageCount += pageCount;
 
+		catalog_.setEntry(schemaName, newEntry);
+		catalog_.setDatabaseFileSize(fileSize);
+		catalog_.commit();
 	}
 
 	std::vector<DbSchema> schemaList_;
 	std::unordered_map<std::string, size_type> schemaMapping_;
 	BufferManager<endian> bufferManager_;
 	size_type pageSize_;
+	PageLayout pageLayout_;
 	std::unordered_map<std::string, std::streamoff> lastOffsetMap_;
 
+	Catalog<endian> catalog_;
+
+	// The buffer manager can be shared between threads, but the pages are appended to the file by one thread at a time.
+	std::mutex addMutex_;
+
+	// Protects the catalog. Nothing else is ever waited for while holding it.
+	std::mutex catalogMutex_;
+
 	std::string dbFile_;
 	std::string schemaFile_;
 };
@@ -4,49 +4,86 @@
 #include <RawDataUtils.hxx>
 #include <Optional.hxx>
 #include <Configuration.hxx>
+#include <Range.hxx>
+#include <SlotBitmap.hxx>
 
 #include <gsl/gsl_assert.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <string>
 #include <vector>
 
+class PageLayoutException : public std::exception
+{
+public:
+	PageLayoutException(const std::string& msg) : msg_{std::string{"Error with the layout of the pages : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
+class PageFormatException : public std::exception
+{
+public:
+	PageFormatException(const std::string& msg) : msg_{std::string{"Error when reading a page : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
 /* Header format :
  * nextPageOffset (sizeof(std::streamoff) bytes)
  * rawPageSize (sizeof(size_type) bytes)
  * headerSize (sizeof(uint32_t) bytes)
  * pageSize (sizeof(size_type) bytes)
  * schemaName (variant)
+ * formatVersion (sizeof(uint32_t) bytes)
  * freeSlotCount (sizeof(size_type) bytes)
- * frameIndicators (pageSize bytes);
+ * slotBitmap (one bit by slot, in whole 64 bits words, see SlotBitmap);
  * 
- * This utilitarian class is loading everything but the frameIndicators, which are only
+ * This utilitarian class is loading everything but the slot bitmap, which is only
  * interesting if we effectively load the page inside the main memory.
  * This class is mainly used to check if a page is full before even loading it fully into the main memory.
+ * The format version is the same in every page : a page without it was written in another format, which is refused.
  */
 template<Endianness endian>
 class DiskPageHeader
 {
 	public:
-	DiskPageHeader(const std::vector<uint8_t>& data)
-	{
-		auto it = data.begin();
-
-		nextPageOffset_ = Utils::RawDataConverter<endian>::rawDataToStreamoff(it, it + sizeof(decltype(nextPageOffset_)));
-		it += sizeof(decltype(nextPageOffset_));
-
-		rawPageSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(rawPageSize_)));
-		it += sizeof(decltype(rawPageSize_));
-
-		headerSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(headerSize_)));
-		it += sizeof(decltype(headerSize_));
-
-		pageSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(pageSize_)));
-		it += sizeof(decltype(pageSize_));
+	// "PAG2" in little endian : the second format, where the slots are a bitmap. The first one had no version.
+	static constexpr uint32_t formatVersion = 0x32474150;
+
+	DiskPageHeader()
+	: nextPageOffset_{0},
+	  pageSize_{0},
+	  rawPageSize_{0},
+	  headerSize_{0},
+	  schemaName_{},
+	  freeSlotCount_{0}
+	{}
 
-		schemaName_ = std::string{it, std::find(it, data.end(), '\0')};
-		it += schemaName_.size() + 1;
+	DiskPageHeader(const std::vector<uint8_t>& data)
+	: DiskPageHeader(data.begin(), data.end())
+	{}
 
-		freeSlotCount_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(freeSlotCount_)));
+	template<class Iterator>
+	DiskPageHeader(Iterator begin, Iterator end)
+	{
+		parse(begin, end);
 	}
 
 	DiskPageHeader(std::streamoff nextPageOffset, size_type elemSize, size_type pageSize, const std::string& schemaName, size_type freeSlotCount)
@@ -57,7 +94,7 @@ class DiskPageHeader
 	  schemaName_{schemaName},
 	  freeSlotCount_{freeSlotCount}
 	{
-		rawPageSize_ = getSize() + (elemSize * pageSize) + pageSize;
+		rawPageSize_ = getSize() + (elemSize * pageSize) + SlotBitmap::getSize(pageSize);
 		headerSize_ = getSize();
 	}
 
@@ -70,6 +107,40 @@ class DiskPageHeader
 	  freeSlotCount_{other.freeSlotCount_}
 	{}
 
+	/* Reads the header from the raw page. Meant to be called again on the same object when a buffer frame gets a new page :
+	 * the schema name keeps its storage, so it does not allocate in the steady state. */
+	template<class Iterator>
+	void parse(Iterator begin, Iterator end)
+	{
+		auto it = begin;
+
+		nextPageOffset_ = Utils::RawDataConverter<endian>::rawDataToStreamoff(it, it + sizeof(decltype(nextPageOffset_)));
+		it += sizeof(decltype(nextPageOffset_));
+
+		rawPageSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(rawPageSize_)));
+		it += sizeof(decltype(rawPageSize_));
+
+		headerSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(headerSize_)));
+		it += sizeof(decltype(headerSize_));
+
+		pageSize_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(pageSize_)));
+		it += sizeof(decltype(pageSize_));
+
+		auto nameEnd = std::find(it, end, '\0');
+		schemaName_.assign(it, nameEnd);
+		it = nameEnd + 1;
+
+		if((end - it < static_cast<std::ptrdiff_t>(sizeof(formatVersion)))
+		|| (Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(formatVersion)) != formatVersion))
+		{
+			throw PageFormatException("the page of the schema " + schemaName_ + " is not in the format of this version, "
+									  "the database has to be created again");
+		}
+		it += sizeof(formatVersion);
+
+		freeSlotCount_ = Utils::RawDataConverter<endian>::rawDataToInteger(it, it + sizeof(decltype(freeSlotCount_)));
+	}
+
 	size_type getPageSize() const noexcept
 	{
 		return pageSize_;
@@ -110,6 +181,14 @@ class DiskPageHeader
 		return headerSize_;
 	}
 
+	// Pads the page up to rawPageSize bytes, for the aligned layouts (see PageLayout).
+	void padTo(size_type rawPageSize) noexcept
+	{
+		Ensures(rawPageSize >= rawPageSize_);
+
+		rawPageSize_ = rawPageSize;
+	}
+
 	void decreaseFreeSlotCount(size_type val) noexcept
 	{
 		Ensures(freeSlotCount_ >= val);
@@ -146,6 +225,7 @@ class DiskPageHeader
 			  + sizeof(decltype(rawPageSize_))
 			  + sizeof(decltype(headerSize_))
 			  + schemaName_.size()
+			  + sizeof(formatVersion)
 			  + sizeof(decltype(freeSlotCount_)) + 1);  // Count the null terminator.
 		//return (3 * sizeof(size_type)) + sizeof(uint32_t) + sizeof(std::streamoff) + schemaName_.size() + 1;
 	}
@@ -173,34 +253,188 @@ class DiskPageHeader
 	size_type freeSlotCount_;
 };
 
+/* A page is kept in its raw, on disk, format (see DiskPageHeader for the layout) : the header, then the bitmap of the used
+ * slots, then the slots. The header fields are also parsed into a DiskPageHeader, and every change is applied to both.
+ * Writing the page back is then a plain copy of its raw bytes.
+ * The raw bytes either belong to the page, or live in a frame of the buffer arena. In that case, the page is read straight
+ * into the frame and parsed in place, without any allocation. A page too big for its frame is kept aside, in its own storage.
+ * The raw bytes can also be a view on memory the page does not own, like a mapping of the database file (see view).
+ */
 template<Endianness endian>
 class DiskPage
 {
 	public:
 	using PageIndex = size_type;
 
+	private:
+	static constexpr size_type nextPageOffsetPosition = 0;
+
 	public:
+	DiskPage()
+	: DiskPage(0, nullptr, 0)
+	{}
+
+	/* A page living in a frame of the buffer. It stays empty until a raw page is read in the frame and load() is called. */
+	DiskPage(PageIndex index, uint8_t* frame, size_type frameCapacity)
+	: header_{},
+	  index_{index},
+	  dirtyFlag_{false},
+	  frame_{frame},
+	  frameCapacity_{frameCapacity},
+	  ownedBytes_{},
+	  bytes_{frame},
+	  viewSize_{0}
+	{}
 
 	/* For data, we assume that the DbSystem gave us the full page, no more, no less */
-	DiskPage(PageIndex index, const std::vector<uint8_t>& data) 
-	: header_{data},
+	DiskPage(PageIndex index, const std::vector<uint8_t>& data)
+	: header_{},
 	  index_{index},
-	  dirtyFlag_{false}
+	  dirtyFlag_{false},
+	  frame_{nullptr},
+	  frameCapacity_{0},
+	  ownedBytes_{data},
+	  bytes_{ownedBytes_.data()},
+	  viewSize_{0}
 	{
-		auto it = data.begin() + header_.getSize();
-		frameIndicators_ = std::vector<bool>{it, it + header_.getPageSize()};
-		it += header_.getPageSize();
-
-		data_ = std::vector<uint8_t>{it, data.end()};
+		load();
 	}
 
 	DiskPage(PageIndex index, const DbSchema& schema, size_type pageSize)
 	: header_{0, schema.getDataSize(), pageSize, schema.getName(), pageSize},
 	  index_{index},
 	  dirtyFlag_{false},
-	  frameIndicators_(pageSize, false),
-	  data_(pageSize * schema.getDataSize(), 0) 
+	  frame_{nullptr},
+	  frameCapacity_{0},
+	  ownedBytes_(header_.getRawPageSize(), 0),
+	  bytes_{ownedBytes_.data()},
+	  viewSize_{0}
+	{
+		storeHeader();
+	}
+
+	// A page of an aligned layout, padded to the size of the layout, with as many slots as fit (see getFittingSlotCount).
+	DiskPage(PageIndex index, const DbSchema& schema, PageLayout layout)
+	: DiskPage(index, schema, getFittingSlotCount(schema, layout))
+	{
+		header_.padTo(static_cast<size_type>(layout));
+		ownedBytes_.resize(header_.getRawPageSize(), 0);
+		bytes_ = ownedBytes_.data();
+
+		storeHeader();
+	}
+
+	// The most slots of the schema a page of the aligned layout can hold.
+	static size_type getFittingSlotCount(const DbSchema& schema, PageLayout layout)
+	{
+		Expects(layout != PageLayout::packed);
+
+		size_type headerSize = DiskPageHeader<endian>{0, schema.getDataSize(), 0, schema.getName(), 0}.getSize();
+		size_type rawPageSize = static_cast<size_type>(layout);
+
+		if(rawPageSize < (headerSize + SlotBitmap::getSize(1) + schema.getDataSize()))
+		{
+			throw PageLayoutException("the rows of the schema " + schema.getName() + " do not fit in a page");
+		}
+
+		// One bit and the data by slot, the bitmap being made of whole words.
+		size_type slotCount = ((rawPageSize - headerSize) * 8) / ((schema.getDataSize() * 8) + 1);
+
+		while((headerSize + SlotBitmap::getSize(slotCount) + (slotCount * schema.getDataSize())) > rawPageSize) --slotCount;
+
+		return slotCount;
+	}
+
+	// A copy always owns its bytes, even if the original lives in a frame.
+	DiskPage(const DiskPage& other)
+	: header_{other.header_},
+	  index_{other.index_},
+	  dirtyFlag_{other.dirtyFlag_},
+	  frame_{nullptr},
+	  frameCapacity_{0},
+	  ownedBytes_(other.bytes_, other.bytes_ + other.getRawPageSize()),
+	  bytes_{ownedBytes_.data()},
+	  viewSize_{0}
+	{}
+
+	DiskPage(DiskPage&& other) noexcept
+	: header_{other.header_},
+	  index_{other.index_},
+	  dirtyFlag_{other.dirtyFlag_},
+	  frame_{other.frame_},
+	  frameCapacity_{other.frameCapacity_},
+	  ownedBytes_{std::move(other.ownedBytes_)},
+	  bytes_{other.bytes_},
+	  viewSize_{other.viewSize_}
+	{
+		other.frame_ = nullptr;
+		other.frameCapacity_ = 0;
+		other.bytes_ = nullptr;
+		other.viewSize_ = 0;
+	}
+
+	DiskPage& operator=(DiskPage other) noexcept
+	{
+		swap(other);
+
+		return *this;
+	}
+
+	void swap(DiskPage& other) noexcept
+	{
+		using std::swap;
+
+		swap(header_, other.header_);
+		swap(index_, other.index_);
+		swap(dirtyFlag_, other.dirtyFlag_);
+		swap(frame_, other.frame_);
+		swap(frameCapacity_, other.frameCapacity_);
+		swap(ownedBytes_, other.ownedBytes_);
+		swap(bytes_, other.bytes_);
+		swap(viewSize_, other.viewSize_);
+	}
+
+	/* Returns where a raw page of this size must be read to : the frame if the page fits in it,
+	 * the own storage of the page otherwise. The page must then be loaded. */
+	uint8_t* prepare(size_type rawPageSize)
+	{
+		if(rawPageSize <= frameCapacity_)
+		{
+			bytes_ = frame_;
+		}
+		else
+		{
+			ownedBytes_.resize(rawPageSize);
+			bytes_ = ownedBytes_.data();
+		}
+
+		return bytes_;
+	}
+
+	// Parses the header of the raw page in place.
+	void load()
+	{
+		header_.parse(bytes_, bytes_ + getStorageSize());
+		dirtyFlag_ = false;
+	}
+
+	/* Points the page to a raw page it does not own, of at most size bytes, and parses it in place.
+	 * The bytes must outlive the page, or the next prepare. The page is only meant to be read : the bytes may be read only. */
+	void view(const uint8_t* bytes, size_type size)
+	{
+		bytes_ = const_cast<uint8_t*>(bytes);
+		viewSize_ = size;
+		load();
+	}
+
+	bool isInFrame() const noexcept
 	{
+		return (bytes_ != nullptr) && (bytes_ == frame_);
+	}
+
+	size_type getFrameCapacity() const noexcept
+	{
+		return frameCapacity_;
 	}
 
 	size_type getPageSize() const noexcept
@@ -215,7 +449,7 @@ class DiskPage
 
 	void setNextPageOffset(std::streamoff offset) noexcept
 	{
-		header_.setNextPageOffset(offset);
+		linkTo(offset);
 		markDirty();
 	}
 
@@ -254,46 +488,76 @@ class DiskPage
 		return dirtyFlag_;
 	}
 
+	// Once the page has been written back, or once its owner took note of the modifications.
+	void markClean() noexcept
+	{
+		dirtyFlag_ = false;
+	}
+
 	bool isFull() const noexcept
 	{
 		return header_.isFull();
 	}
 
-	const std::vector<bool>& getFrameIndicators() const noexcept
+	// One bit by slot, set if the slot is used (see SlotBitmap).
+	range<const uint8_t*> getSlotBitmap() const noexcept
 	{
-		return frameIndicators_;
+		const uint8_t* bitmap = bytes_ + getHeaderSize();
+
+		return {bitmap, bitmap + SlotBitmap::getSize(getPageSize())};
+	}
+
+	range<const uint8_t*> getData() const noexcept
+	{
+		return {bytes_ + getDataPosition(), bytes_ + getRawPageSize()};
 	}
 
-	const std::vector<uint8_t>& getData() const noexcept
+	// The whole page, as written on disk.
+	range<const uint8_t*> getRawData() const noexcept
 	{
-		return data_;
+		return {bytes_, bytes_ + getRawPageSize()};
 	}
 
 	void remove(size_type index) noexcept
 	{
-		if(frameIndicators_[index] != false)
+		if(!isFree(index))
 		{
 			markDirty();
 			header_.incrementFreeSlotCount();
-			frameIndicators_[index] = false;
+			storeFreeSlotCount();
+			SlotBitmap::reset(bytes_ + getHeaderSize(), index);
 		}
 	}
 
 	bool isFree(size_type index) const noexcept
 	{
-		return !frameIndicators_[index];
+		return !SlotBitmap::test(bytes_ + getHeaderSize(), index);
+	}
+
+	// The first used slot from index on, the page size if there is none.
+	size_type findNextUsedIndex(size_type index) const noexcept
+	{
+		return SlotBitmap::findNextUsed(bytes_ + getHeaderSize(), index, getPageSize());
 	}
 
 	bool add(const DbEntry<endian>& entry) noexcept
+	{
+		Ensures(entry.getSchema().getName() == getSchemaName());
+
+		return add(range<const uint8_t*>{entry.getRawData().data(), entry.getRawData().data() + entry.getRawData().size()});
+	}
+
+	// The raw row is copied as is, it must be a row of the schema of the page.
+	bool add(range<const uint8_t*> rawData) noexcept
 	{
 		auto freeIndex = findFreeIndex();
-		std::cout << "add : " << getIndex() << " : " << getFreeSlotCount() << std::endl;
+
 		if(freeIndex)
 		{
-			replace(*freeIndex, entry);
-			markDirty();
-			frameIndicators_[*freeIndex] = true;
+			replace(*freeIndex, rawData);
+			SlotBitmap::set(bytes_ + getHeaderSize(), *freeIndex);
 			header_.decrementFreeSlotCount();
+			storeFreeSlotCount();
 
 			return true;
 		}
@@ -306,28 +570,83 @@ class DiskPage
 		Ensures(entry.getSchema().getName() == getSchemaName());
 
 		auto rawData = entry.getRawData();
-		std::copy(rawData.begin(), rawData.end(), data_.begin() + (index * rawData.size()));
-		//std::cout << "SSSSS : " << data_.size()  << " : " << rawData.size() << " : " << (index * rawData.size()) << std::endl;
-		/*std::cout << "DDD " << rawData.size() << std::endl;
-		for(auto d : rawData)
-		{ std::cout << (int)d << " ";}*/
+		replace(index, range<const uint8_t*>{rawData.data(), rawData.data() + rawData.size()});
+	}
+
+	void replace(size_type index, range<const uint8_t*> rawData) noexcept
+	{
+		std::copy(rawData.begin(), rawData.end(), bytes_ + getDataPosition() + (index * rawData.size()));
 		markDirty();
 	}
 
 	void linkTo(std::streamoff offset) noexcept
 	{
 		header_.setNextPageOffset(offset);
+		storeValue<std::streamoff>(nextPageOffsetPosition, offset);
 	}
 
 	private:
 
+	size_type getStorageSize() const noexcept
+	{
+		if(bytes_ == frame_) return frameCapacity_;
+
+		return (bytes_ == ownedBytes_.data()) ? ownedBytes_.size() : viewSize_;
+	}
+
+	size_type getDataPosition() const noexcept
+	{
+		return getHeaderSize() + SlotBitmap::getSize(getPageSize());
+	}
+
+	template<class T>
+	void storeValue(size_type position, T value) noexcept
+	{
+		Utils::RawDataAdaptator<T, sizeof(T), endian> valueData{value};
+		std::copy(valueData.bytes.begin(), valueData.bytes.end(), bytes_ + position);
+	}
+
+	void storeFreeSlotCount() noexcept
+	{
+		storeValue<size_type>(getHeaderSize() - sizeof(size_type), header_.getFreeSlotCount());
+	}
+
+	// Writes the whole header in the raw page, the same way PageSerializer does.
+	void storeHeader() noexcept
+	{
+		size_type position = nextPageOffsetPosition;
+
+		storeValue<std::streamoff>(position, header_.getNextPageOffset());
+		position += sizeof(std::streamoff);
+
+		storeValue<size_type>(position, header_.getRawPageSize());
+		position += sizeof(size_type);
+
+		storeValue<uint32_t>(position, header_.getHeaderSize());
+		position += sizeof(uint32_t);
+
+		storeValue<size_type>(position, header_.getPageSize());
+		position += sizeof(size_type);
+
+		std::copy(getSchemaName().begin(), getSchemaName().end(), bytes_ + position);
+		position += getSchemaName().size();
+		bytes_[position++] = '\0';
+
+		storeValue<uint32_t>(position, DiskPageHeader<endian>::formatVersion);
+		position += sizeof(uint32_t);
+
+		storeValue<size_type>(position, header_.getFreeSlotCount());
+	}
+
 	optional<size_type> findFreeIndex() const noexcept
 	{
-		for(size_type i = 0; i < frameIndicators_.size(); ++i)
-		{
-			if(isFree(i)){ return i; }
-		}
-		return {};
+		if(isFull()) return {};
+
+		size_type index = SlotBitmap::findFirstFree(bytes_ + getHeaderSize(), getPageSize());
+
+		if(index == getPageSize()) return {};
+
+		return index;
 	}
 
 	void markDirty() noexcept
@@ -338,8 +657,28 @@ class DiskPage
 	DiskPageHeader<endian> header_;
 	PageIndex index_;
 	bool dirtyFlag_;
-	std::vector<bool> frameIndicators_;
-	std::vector<uint8_t> data_;
+
+	// The frame of the buffer the page belongs to, if any.
+	uint8_t* frame_;
+	size_type frameCapacity_;
+
+	std::vector<uint8_t> ownedBytes_;
+
+	// The raw page, either in the frame, in ownedBytes_, or viewed (of viewSize_ bytes).
+	uint8_t* bytes_;
+	size_type viewSize_;
 };
 
+template<Endianness endian>
+constexpr uint32_t DiskPageHeader<endian>::formatVersion;
+
+template<Endianness endian>
+constexpr size_type DiskPage<endian>::nextPageOffsetPosition;
+
+template<Endianness endian>
+void swap(DiskPage<endian>& lhs, DiskPage<endian>& rhs) noexcept
+{
+	lhs.swap(rhs);
+}
+
 #endif // DISK_PAGE_HXX
@@ -0,0 +1,381 @@
+#ifndef FIELD_COMPARE_HXX
+#define FIELD_COMPARE_HXX
+
+#include <Configuration.hxx>
+#include <SlotBitmap.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if ((COMPILER == GCC_COMPILER) || (COMPILER == CLANG_COMPILER)) && (defined(__x86_64__) || defined(__i386__))
+#	define FIELD_COMPARE_X86
+#	define FIELD_COMPARE_SSE42 __attribute__((target("sse4.2")))
+#	define FIELD_COMPARE_AVX2 __attribute__((target("avx2")))
+#	include <immintrin.h>
+#endif
+
+/* Compares a field of count rows, the first at fields then one every stride bytes, to a range of values, several rows
+ * at a time : the result is a bitmap of the rows in the range (or out of it when negated), laid out as a slot bitmap
+ * (see SlotBitmap), which can then be intersected with the slots used in the page.
+ * The kernels use the widest instructions the processor has, AVX2 (the fields are gathered, eight or four by
+ * instruction) or SSE 4.2, picked once at run time, as the database is not built for a specific processor, and fall
+ * back to plain loops elsewhere.
+ * The integers are unsigned, of 1 to 8 bytes, and the floating point numbers floats or doubles, little endian, as the
+ * fields of a little endian file. An integer is loaded as the 4 or 8 bytes ending with it : the 7 bytes before the
+ * first field must be readable, as they are in a page, whose rows come after its header and its slot bitmap.
+ */
+class FieldCompare
+{
+	static constexpr size_type wordBits = 64;
+
+public:
+	enum class InstructionSet : flag_type
+	{
+		scalar,
+		sse42,
+		avx2
+	};
+
+	// The widest instruction set of the processor the kernels can use.
+	static InstructionSet getInstructionSet() noexcept
+	{
+		static const InstructionSet instructionSet = detectInstructionSet();
+		return instructionSet;
+	}
+
+	// The range is [low, high], empty if low > high. The instruction set must be supported by the processor.
+	static void compareIntegers(const uint8_t* fields, size_type size, size_type stride, size_type count, uint64_t low, uint64_t high,
+								bool negate, uint8_t* mask, InstructionSet instructionSet = getInstructionSet()) noexcept
+	{
+		static constexpr uint64_t max32 = UINT32_MAX;
+
+		if(low > high)
+		{
+			clearMask(count, mask);
+		}
+		else if(size <= sizeof(uint32_t))
+		{
+			if(low > max32) clearMask(count, mask);
+			else run(Integer32Matcher{static_cast<uint32_t>(low), static_cast<uint32_t>(std::min(high, max32) - low), 8 * (4 - size), stride},
+					 fields + size - sizeof(uint32_t), stride, count, mask, instructionSet);
+		}
+		else
+		{
+			run(Integer64Matcher{low, high - low, 8 * (8 - size), stride}, fields + size - sizeof(uint64_t), stride, count, mask, instructionSet);
+		}
+
+		if(negate) negateMask(count, mask);
+	}
+
+	// T is float or double. The range is [low, high], a NaN is in no range.
+	template<class T>
+	static void compareFloatingPoints(const uint8_t* fields, size_type stride, size_type count, T low, T high, bool negate, uint8_t* mask,
+									  InstructionSet instructionSet = getInstructionSet()) noexcept
+	{
+		run(FloatingPointMatcher<T>{low, high, stride}, fields, stride, count, mask, instructionSet);
+
+		if(negate) negateMask(count, mask);
+	}
+
+private:
+	static InstructionSet detectInstructionSet() noexcept
+	{
+#ifdef FIELD_COMPARE_X86
+		__builtin_cpu_init();
+
+		if(__builtin_cpu_supports("avx2")) return InstructionSet::avx2;
+		if(__builtin_cpu_supports("sse4.2")) return InstructionSet::sse42;
+#endif
+
+		return InstructionSet::scalar;
+	}
+
+	static void clearMask(size_type count, uint8_t* mask) noexcept
+	{
+		std::memset(mask, 0, SlotBitmap::getSize(count));
+	}
+
+	// Only the bits of the count rows are set.
+	static void negateMask(size_type count, uint8_t* mask) noexcept
+	{
+		size_type wordCount = SlotBitmap::getSize(count) / sizeof(uint64_t);
+
+		for(size_type i = 0; i < wordCount; ++i)
+		{
+			size_type bitCount = std::min<size_type>(count - i * wordBits, size_type{wordBits});
+			uint64_t bits = (bitCount == wordBits) ? ~uint64_t{0} : ((uint64_t{1} << bitCount) - 1);
+
+			SlotBitmap::storeWord(mask, i, ~SlotBitmap::loadWord(mask, i) & bits);
+		}
+	}
+
+	/* A matcher tests one field, or as many fields as an instruction handles at once, and gives a bit by field.
+	 * The integers are in the range if value - low <= high - low, in unsigned arithmetic : a single comparison.
+	 */
+	struct Integer32Matcher
+	{
+		static constexpr size_type sse42Width = 4;
+		static constexpr size_type avx2Width = 8;
+
+		bool matchOne(const uint8_t* word) const noexcept
+		{
+			uint32_t value;
+			std::memcpy(&value, word, sizeof(value));
+
+			return static_cast<uint32_t>((value >> shift) - low) <= span;
+		}
+
+#ifdef FIELD_COMPARE_X86
+		FIELD_COMPARE_SSE42 uint32_t matchSse42(const uint8_t* words) const noexcept
+		{
+			__m128i values = _mm_setr_epi32(load(words), load(words + stride), load(words + 2 * stride), load(words + 3 * stride));
+			__m128i offsets = _mm_sub_epi32(_mm_srl_epi32(values, _mm_cvtsi32_si128(static_cast<int>(shift))), _mm_set1_epi32(static_cast<int>(low)));
+			__m128i matches = _mm_cmpeq_epi32(_mm_min_epu32(offsets, _mm_set1_epi32(static_cast<int>(span))), offsets);
+
+			return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(matches)));
+		}
+
+		FIELD_COMPARE_AVX2 uint32_t matchAvx2(const uint8_t* words) const noexcept
+		{
+			__m256i indices = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+			__m256i values = _mm256_i32gather_epi32(reinterpret_cast<const int*>(words), indices, 1);
+			__m256i offsets = _mm256_sub_epi32(_mm256_srl_epi32(values, _mm_cvtsi32_si128(static_cast<int>(shift))), _mm256_set1_epi32(static_cast<int>(low)));
+			__m256i matches = _mm256_cmpeq_epi32(_mm256_min_epu32(offsets, _mm256_set1_epi32(static_cast<int>(span))), offsets);
+
+			return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(matches)));
+		}
+
+		static int load(const uint8_t* word) noexcept
+		{
+			int value;
+			std::memcpy(&value, word, sizeof(value));
+
+			return value;
+		}
+#endif
+
+		uint32_t low;
+		uint32_t span;
+		// The bits of the word before the field.
+		size_type shift;
+		size_type stride;
+	};
+
+	struct Integer64Matcher
+	{
+		static constexpr size_type sse42Width = 2;
+		static constexpr size_type avx2Width = 4;
+
+		bool matchOne(const uint8_t* word) const noexcept
+		{
+			uint64_t value;
+			std::memcpy(&value, word, sizeof(value));
+
+			return ((value >> shift) - low) <= span;
+		}
+
+#ifdef FIELD_COMPARE_X86
+		// There is no unsigned comparison of 64 bits integers : the sign bits are flipped for a signed one.
+		FIELD_COMPARE_SSE42 uint32_t matchSse42(const uint8_t* words) const noexcept
+		{
+			__m128i values = _mm_set_epi64x(load(words + stride), load(words));
+			__m128i sign = _mm_set1_epi64x(INT64_MIN);
+			__m128i offsets = _mm_sub_epi64(_mm_srl_epi64(values, _mm_cvtsi32_si128(static_cast<int>(shift))), _mm_set1_epi64x(static_cast<long long>(low)));
+			__m128i outside = _mm_cmpgt_epi64(_mm_xor_si128(offsets, sign), _mm_xor_si128(_mm_set1_epi64x(static_cast<long long>(span)), sign));
+
+			return ~static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(outside))) & 0x3;
+		}
+
+		FIELD_COMPARE_AVX2 uint32_t matchAvx2(const uint8_t* words) const noexcept
+		{
+			__m128i indices = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+			__m256i values = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(words), indices, 1);
+			__m256i sign = _mm256_set1_epi64x(INT64_MIN);
+			__m256i offsets = _mm256_sub_epi64(_mm256_srl_epi64(values, _mm_cvtsi32_si128(static_cast<int>(shift))), _mm256_set1_epi64x(static_cast<long long>(low)));
+			__m256i outside = _mm256_cmpgt_epi64(_mm256_xor_si256(offsets, sign), _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(span)), sign));
+
+			return ~static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(outside))) & 0xF;
+		}
+
+		static long long load(const uint8_t* word) noexcept
+		{
+			long long value;
+			std::memcpy(&value, word, sizeof(value));
+
+			return value;
+		}
+#endif
+
+		uint64_t low;
+		uint64_t span;
+		size_type shift;
+		size_type stride;
+	};
+
+	// Ordered comparisons : false for a NaN.
+	template<class T>
+	struct FloatingPointMatcherBase
+	{
+		bool matchOne(const uint8_t* field) const noexcept
+		{
+			T value;
+			std::memcpy(&value, field, sizeof(value));
+
+			return (value >= low) && (value <= high);
+		}
+
+		T low;
+		T high;
+		size_type stride;
+	};
+
+	// Defined for float and double, below the class.
+	template<class T>
+	struct FloatingPointMatcher;
+
+	template<class Matcher>
+	static void run(const Matcher& matcher, const uint8_t* fields, size_type stride, size_type count, uint8_t* mask,
+					InstructionSet instructionSet) noexcept
+	{
+#ifdef FIELD_COMPARE_X86
+		if(instructionSet == InstructionSet::avx2) return runAvx2(matcher, fields, stride, count, mask);
+		if(instructionSet == InstructionSet::sse42) return runSse42(matcher, fields, stride, count, mask);
+#else
+		(void)instructionSet;
+#endif
+
+		for(size_type first = 0; first < count; first += wordBits)
+		{
+			size_type fieldCount = std::min<size_type>(count - first, size_type{wordBits});
+			uint64_t word = 0;
+
+			for(size_type i = 0; i < fieldCount; ++i) word |= static_cast<uint64_t>(matcher.matchOne(fields + (first + i) * stride)) << i;
+
+			SlotBitmap::storeWord(mask, first / wordBits, word);
+		}
+	}
+
+#ifdef FIELD_COMPARE_X86
+	// The loops are repeated by instruction set, for the matcher to be inlined with the instructions it uses.
+	template<class Matcher>
+	FIELD_COMPARE_SSE42 static void runSse42(const Matcher& matcher, const uint8_t* fields, size_type stride, size_type count,
+											 uint8_t* mask) noexcept
+	{
+		for(size_type first = 0; first < count; first += wordBits)
+		{
+			size_type fieldCount = std::min<size_type>(count - first, size_type{wordBits});
+			uint64_t word = 0;
+			size_type i = 0;
+
+			for(; i + Matcher::sse42Width <= fieldCount; i += Matcher::sse42Width)
+			{
+				word |= static_cast<uint64_t>(matcher.matchSse42(fields + (first + i) * stride)) << i;
+			}
+
+			for(; i < fieldCount; ++i) word |= static_cast<uint64_t>(matcher.matchOne(fields + (first + i) * stride)) << i;
+
+			SlotBitmap::storeWord(mask, first / wordBits, word);
+		}
+	}
+
+	template<class Matcher>
+	FIELD_COMPARE_AVX2 static void runAvx2(const Matcher& matcher, const uint8_t* fields, size_type stride, size_type count,
+										   uint8_t* mask) noexcept
+	{
+		for(size_type first = 0; first < count; first += wordBits)
+		{
+			size_type fieldCount = std::min<size_type>(count - first, size_type{wordBits});
+			uint64_t word = 0;
+			size_type i = 0;
+
+			for(; i + Matcher::avx2Width <= fieldCount; i += Matcher::avx2Width)
+			{
+				word |= static_cast<uint64_t>(matcher.matchAvx2(fields + (first + i) * stride)) << i;
+			}
+
+			for(; i < fieldCount; ++i) word |= static_cast<uint64_t>(matcher.matchOne(fields + (first + i) * stride)) << i;
+
+			SlotBitmap::storeWord(mask, first / wordBits, word);
+		}
+	}
+#endif
+};
+
+template<>
+struct FieldCompare::FloatingPointMatcher<float> : FloatingPointMatcherBase<float>
+{
+	static constexpr size_type sse42Width = 4;
+	static constexpr size_type avx2Width = 8;
+
+	FloatingPointMatcher(float low, float high, size_type stride) : FloatingPointMatcherBase<float>{low, high, stride}
+	{}
+
+#ifdef FIELD_COMPARE_X86
+	FIELD_COMPARE_SSE42 uint32_t matchSse42(const uint8_t* fields) const noexcept
+	{
+		__m128 values = _mm_setr_ps(load(fields), load(fields + stride), load(fields + 2 * stride), load(fields + 3 * stride));
+		__m128 matches = _mm_and_ps(_mm_cmpge_ps(values, _mm_set1_ps(low)), _mm_cmple_ps(values, _mm_set1_ps(high)));
+
+		return static_cast<uint32_t>(_mm_movemask_ps(matches));
+	}
+
+	FIELD_COMPARE_AVX2 uint32_t matchAvx2(const uint8_t* fields) const noexcept
+	{
+		__m256i indices = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride)));
+		__m256 values = _mm256_i32gather_ps(reinterpret_cast<const float*>(fields), indices, 1);
+		__m256 matches = _mm256_and_ps(_mm256_cmp_ps(values, _mm256_set1_ps(low), _CMP_GE_OQ), _mm256_cmp_ps(values, _mm256_set1_ps(high), _CMP_LE_OQ));
+
+		return static_cast<uint32_t>(_mm256_movemask_ps(matches));
+	}
+
+	static float load(const uint8_t* field) noexcept
+	{
+		float value;
+		std::memcpy(&value, field, sizeof(value));
+
+		return value;
+	}
+#endif
+};
+
+template<>
+struct FieldCompare::FloatingPointMatcher<double> : FloatingPointMatcherBase<double>
+{
+	static constexpr size_type sse42Width = 2;
+	static constexpr size_type avx2Width = 4;
+
+	FloatingPointMatcher(double low, double high, size_type stride) : FloatingPointMatcherBase<double>{low, high, stride}
+	{}
+
+#ifdef FIELD_COMPARE_X86
+	FIELD_COMPARE_SSE42 uint32_t matchSse42(const uint8_t* fields) const noexcept
+	{
+		__m128d values = _mm_setr_pd(load(fields), load(fields + stride));
+		__m128d matches = _mm_and_pd(_mm_cmpge_pd(values, _mm_set1_pd(low)), _mm_cmple_pd(values, _mm_set1_pd(high)));
+
+		return static_cast<uint32_t>(_mm_movemask_pd(matches));
+	}
+
+	FIELD_COMPARE_AVX2 uint32_t matchAvx2(const uint8_t* fields) const noexcept
+	{
+		__m128i indices = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32(static_cast<int>(stride)));
+		// As the plain gather, which GCC warns about (its undefined source).
+		__m256d values = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), reinterpret_cast<const double*>(fields), indices,
+												  _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 1);
+		__m256d matches = _mm256_and_pd(_mm256_cmp_pd(values, _mm256_set1_pd(low), _CMP_GE_OQ), _mm256_cmp_pd(values, _mm256_set1_pd(high), _CMP_LE_OQ));
+
+		return static_cast<uint32_t>(_mm256_movemask_pd(matches));
+	}
+
+	static double load(const uint8_t* field) noexcept
+	{
+		double value;
+		std::memcpy(&value, field, sizeof(value));
+
+		return value;
+	}
+#endif
+};
+
+#endif // FIELD_COMPARE_HXX
@@ -269,6 +269,12 @@ public:
 		fstream_.flush();
 	}
 
+	// A stream has no way down to the device : the data is only handed to the system.
+	void sync()
+	{
+		flush();
+	}
+
 	std::streampos getCurrentPosition() noexcept
 	{
 		return fstream_.tellp();
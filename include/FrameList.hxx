@@ -0,0 +1,106 @@
+#ifndef FRAME_LIST_HXX
+#define FRAME_LIST_HXX
+
+#include <Configuration.hxx>
+
+#include <gsl/gsl_assert.h>
+
+#include <limits>
+#include <vector>
+
+/* Intrusive doubly linked lists of buffer frames, used by the replace policies.
+ * The links live in a flat array of nodes indexed by the frame index, owned by the policy, so that
+ * several lists can share the same array (a frame belongs to at most one list at a time).
+ * Every operation is O(1), and takes the node array as a parameter so that the policies stay copyable.
+ */
+template<class Index>
+struct FrameNode
+{
+	static constexpr Index nullIndex = std::numeric_limits<Index>::max();
+
+	Index previous = nullIndex;
+	Index next = nullIndex;
+	bool linked = false;
+};
+
+template<class Index>
+constexpr Index FrameNode<Index>::nullIndex;
+
+template<class Index>
+class FrameList
+{
+	public:
+	using Node = FrameNode<Index>;
+	using NodeArray = std::vector<Node>;
+
+	static constexpr Index nullIndex = Node::nullIndex;
+
+	bool empty() const noexcept
+	{
+		return head_ == nullIndex;
+	}
+
+	size_type size() const noexcept
+	{
+		return size_;
+	}
+
+	// The least recently pushed frame.
+	Index front() const noexcept
+	{
+		return head_;
+	}
+
+	void pushBack(NodeArray& nodes, Index index) noexcept
+	{
+		Node& node = nodes[index];
+
+		Expects(!node.linked);
+
+		node.previous = tail_;
+		node.next = nullIndex;
+		node.linked = true;
+
+		if(tail_ != nullIndex) nodes[tail_].next = index;
+		else head_ = index;
+
+		tail_ = index;
+		++size_;
+	}
+
+	// The frame must be linked in this list.
+	void remove(NodeArray& nodes, Index index) noexcept
+	{
+		Node& node = nodes[index];
+
+		Expects(node.linked);
+
+		if(node.previous != nullIndex) nodes[node.previous].next = node.next;
+		else head_ = node.next;
+
+		if(node.next != nullIndex) nodes[node.next].previous = node.previous;
+		else tail_ = node.previous;
+
+		node = Node{};
+		--size_;
+	}
+
+	Index popFront(NodeArray& nodes) noexcept
+	{
+		Index index = head_;
+
+		if(index != nullIndex) remove(nodes, index);
+
+		return index;
+	}
+
+	private:
+	Index head_ = nullIndex;
+	Index tail_ = nullIndex;
+	size_type size_ = 0;
+};
+
+template<class Index>
+constexpr Index FrameList<Index>::nullIndex;
+
+#endif // FRAME_LIST_HXX
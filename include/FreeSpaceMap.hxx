@@ -0,0 +1,218 @@
+#ifndef FREE_SPACE_MAP_HXX
+#define FREE_SPACE_MAP_HXX
+
+#include <Configuration.hxx>
+#include <FileValueReader.hxx>
+#include <Optional.hxx>
+#include <RecordCodec.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* For each schema, the offsets of its pages which have a free slot, so that finding where to insert a row is a single
+ * lookup, whatever the number of full pages. The lowest offset is handed out first, to fill the holes left by the
+ * deletions at the start of the file before the ones at its end.
+ * It is kept up to date by the BufferManager, whenever a modified page is released, and is only a hint : the page it
+ * gives is checked before being used.
+ * It is stored in its own file, next to the database, written in full to a temporary file then renamed over the old
+ * one, so the stored map is always a complete one. As the catalog, it records the size of the database file it
+ * matches, and a map which does not match the file is stale, and must be rebuilt. It is only committed when the
+ * database is closed, and trusted only if the catalog was committed clean after it : see Catalog.
+ * File layout : magic (8), database file size (8), schema count (8), then for each schema its name and its '\0',
+ * the number of pages (8) and their offsets (8 each), and at last the checksum (8) of everything before it.
+ * Thread safe, every function takes the mutex of the map, and nothing else.
+ */
+template<Endianness endian>
+class FreeSpaceMap
+{
+	static constexpr uint64_t magic = 0x504D5346424D44; // "DMBFSMP" in little endian.
+	static constexpr size_type valueSize = RecordCodec<endian>::valueSize;
+
+	using Codec = RecordCodec<endian>;
+
+	public:
+	FreeSpaceMap(const std::string& fileName)
+	: fileName_{fileName},
+	  pages_{},
+	  databaseFileSize_{0},
+	  valid_{false}
+	{
+		load();
+	}
+
+	// Whether the map was loaded, or rebuilt, and can be trusted to know every page with a free slot.
+	bool isValid() const noexcept
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		return valid_;
+	}
+
+	std::streamoff getDatabaseFileSize() const noexcept
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		return databaseFileSize_;
+	}
+
+	// The first page of the schema with a free slot, if any.
+	optional<std::streamoff> findPage(const std::string& schemaName) const
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		auto it = pages_.find(schemaName);
+
+		if((it == pages_.end()) || it->second.empty()) return {};
+
+		return *it->second.begin();
+	}
+
+	void update(const std::string& schemaName, std::streamoff offset, bool hasFreeSlot)
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+
+		if(hasFreeSlot) pages_[schemaName].insert(offset);
+		else
+		{
+			auto it = pages_.find(schemaName);
+			if(it != pages_.end()) it->second.erase(offset);
+		}
+	}
+
+	// To rebuild the map : clear it, update it with every page, then mark it valid.
+	void clear() noexcept
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		pages_.clear();
+		valid_ = false;
+	}
+
+	void setValid(std::streamoff databaseFileSize) noexcept
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		databaseFileSize_ = databaseFileSize;
+		valid_ = true;
+	}
+
+	void commit(std::streamoff databaseFileSize)
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+
+		if(!valid_) return;
+
+		databaseFileSize_ = databaseFileSize;
+
+		std::vector<uint8_t> record = serialize();
+		std::string temporaryFileName = fileName_ + ".tmp";
+
+		{
+			std::ofstream file{temporaryFileName, std::ios::binary | std::ios::trunc};
+			file.write(reinterpret_cast<const char*>(record.data()), record.size());
+			file.flush();
+
+			if(!file) throw std::ios_base::failure("Failed to write the free space map to '" + temporaryFileName + "' !");
+		}
+
+		if(std::rename(temporaryFileName.c_str(), fileName_.c_str()) != 0)
+		{
+			throw std::ios_base::failure("Failed to replace the free space map '" + fileName_ + "' !");
+		}
+	}
+
+	private:
+
+	void load()
+	{
+		// A missing map is rebuilt, and only created when committed : nothing is written next to a read only database.
+		if(!std::ifstream{fileName_, std::ios::binary}) return;
+
+		FileValueReader<endian> reader{fileName_};
+		std::streamoff fileSize = reader.getFileSize();
+
+		if(fileSize < static_cast<std::streamoff>(4 * valueSize)) return;
+
+		std::vector<uint8_t> record;
+		reader.read(record, fileSize, 0);
+
+		valid_ = deserialize(record);
+	}
+
+	std::vector<uint8_t> serialize() const
+	{
+		std::vector<uint8_t> record;
+
+		Codec::appendValue(record, magic);
+		Codec::appendValue(record, databaseFileSize_);
+		Codec::appendValue(record, pages_.size());
+
+		for(const auto& schemaPages : pages_)
+		{
+			Codec::appendString(record, schemaPages.first);
+			Codec::appendValue(record, schemaPages.second.size());
+
+			for(std::streamoff offset : schemaPages.second)
+			{
+				Codec::appendValue(record, offset);
+			}
+		}
+
+		Codec::appendChecksum(record);
+
+		return record;
+	}
+
+	// Only fills the map if the whole record is valid.
+	bool deserialize(const std::vector<uint8_t>& record)
+	{
+		if(Codec::readValue(record, 0) != magic) return false;
+
+		std::unordered_map<std::string, std::set<std::streamoff>> pages;
+		std::streamoff databaseFileSize = Codec::readValue(record, valueSize);
+		size_type schemaCount = Codec::readValue(record, 2 * valueSize);
+		size_type position = 3 * valueSize;
+
+		for(size_type i = 0; i < schemaCount; ++i)
+		{
+			auto schemaName = Codec::readString(record, position);
+
+			if(!schemaName || (position + valueSize > record.size())) return false;
+
+			size_type pageCount = Codec::readValue(record, position);
+			position += valueSize;
+
+			if(position + pageCount * valueSize > record.size()) return false;
+
+			std::set<std::streamoff>& schemaPages = pages[*schemaName];
+
+			for(size_type j = 0; j < pageCount; ++j)
+			{
+				schemaPages.insert(schemaPages.end(), Codec::readValue(record, position));
+				position += valueSize;
+			}
+		}
+
+		if(!Codec::checkChecksum(record, position)) return false;
+
+		pages_ = std::move(pages);
+		databaseFileSize_ = databaseFileSize;
+
+		return true;
+	}
+
+	std::string fileName_;
+	std::unordered_map<std::string, std::set<std::streamoff>> pages_;
+	std::streamoff databaseFileSize_;
+	bool valid_;
+
+	mutable std::mutex mutex_;
+};
+
+template<Endianness endian>
+constexpr uint64_t FreeSpaceMap<endian>::magic;
+
+template<Endianness endian>
+constexpr size_type FreeSpaceMap<endian>::valueSize;
+
+#endif // FREE_SPACE_MAP_HXX
@@ -0,0 +1,88 @@
+#ifndef GHOST_LIST_HXX
+#define GHOST_LIST_HXX
+
+#include <Configuration.hxx>
+
+#include <ios>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+/* A bounded history of the pages recently evicted from the buffer, identified by their offset in the file.
+ * The pages themselves are long gone, only their offsets remain (hence the "ghost").
+ * When the list is full, inserting a new offset forgets the oldest one. Every operation is O(1).
+ */
+class GhostList
+{
+	public:
+	GhostList(size_type capacity = 0)
+	: order_{},
+	  positions_{},
+	  capacity_{capacity}
+	{}
+
+	GhostList(const GhostList& other) = delete;
+	GhostList& operator=(const GhostList& other) = delete;
+
+	bool contains(std::streamoff offset) const
+	{
+		return positions_.find(offset) != positions_.end();
+	}
+
+	void insert(std::streamoff offset)
+	{
+		if(capacity_ == 0) return;
+
+		erase(offset);
+
+		if(order_.size() >= capacity_)
+		{
+			popOldest();
+		}
+
+		order_.push_back(offset);
+		positions_.insert({offset, std::prev(order_.end())});
+	}
+
+	bool erase(std::streamoff offset)
+	{
+		auto it = positions_.find(offset);
+
+		if(it == positions_.end()) return false;
+
+		order_.erase(it->second);
+		positions_.erase(it);
+
+		return true;
+	}
+
+	void popOldest()
+	{
+		if(order_.empty()) return;
+
+		positions_.erase(order_.front());
+		order_.pop_front();
+	}
+
+	size_type size() const noexcept
+	{
+		return order_.size();
+	}
+
+	bool empty() const noexcept
+	{
+		return order_.empty();
+	}
+
+	size_type getCapacity() const noexcept
+	{
+		return capacity_;
+	}
+
+	private:
+	std::list<std::streamoff> order_;
+	std::unordered_map<std::streamoff, std::list<std::streamoff>::iterator> positions_;
+	size_type capacity_;
+};
+
+#endif // GHOST_LIST_HXX
@@ -0,0 +1,13 @@
+#ifndef IMPORT_COMMAND_HXX
+#define IMPORT_COMMAND_HXX
+
+/* The import command of the executable : loads a CSV file into a schema of a database, see CsvImporter.
+ *
+ *     import <database> <schema file> <schema name> <CSV file> [--header] [--delimiter c] [--threads n]
+ *
+ * The arguments start with the name of the command. The database file is created if it does not exist yet.
+ * Returns the exit code of the executable.
+ */
+int runImportCommand(int argc, char** argv);
+
+#endif // IMPORT_COMMAND_HXX
@@ -2,24 +2,34 @@
 #define LRU_PAGE_REPLACE_POLICY_HXX
 
 #include <Configuration.hxx>
+#include <FrameList.hxx>
 #include <Optional.hxx>
 #include <PageReplacePolicy.hxx>
 
-#include <gsl/gsl_assert.h>
-
 #include <vector>
 
+/* Least recently used replace policy.
+ * Every frame of the buffer owns a node in a flat array indexed by its PageIndex. The nodes of the
+ * unpinned frames are chained together in an intrusive doubly linked list, ordered from the least
+ * recently released frame (the head, our next candidate) to the most recently released one (the tail).
+ * Pinning a frame simply unlinks its node, so use, release and getCandidate are all O(1),
+ * whatever the size of the buffer.
+ */
 template<Endianness endian>
 class LRUPageReplacePolicy : public PageReplacePolicy<endian>
 {
 	public:
 	using PageIndex = typename PageReplacePolicy<endian>::PageIndex;
 
+	private:
+	using CandidateList = FrameList<PageIndex>;
+
+	public:
 	LRUPageReplacePolicy() = default;
 
-	LRUPageReplacePolicy(size_type totalPageCount) noexcept
-	: candidateQueue_{},
-	  queuePagePosition_{totalPageCount}
+	LRUPageReplacePolicy(size_type totalPageCount)
+	: nodes_(totalPageCount),
+	  candidates_{}
 	{}
 
 	LRUPageReplacePolicy(const LRUPageReplacePolicy& other) = default;
@@ -32,64 +42,51 @@ class LRUPageReplacePolicy : public PageReplacePolicy<endian>
 	{
 		auto pageId = page.getIndex();
 
-		if(pageId >= queuePagePosition_.size())
-		{
-			queuePagePosition_.resize(pageId + 1);
-		}
-		if(queuePagePosition_[pageId])
-		{
-			auto position = queuePagePosition_[pageId];
-			if(position)
-			{
-				candidateQueue_.erase(candidateQueue_.begin() + *position);
-				queuePagePosition_[pageId] = {};
-				for(auto& pos : queuePagePosition_)
-				{
-					if(pos && (*pos > queuePagePosition_[pageId])) pos = pos - 1;
-				}
-			}
-		}
+		reserve(pageId);
+		unlink(pageId);
 	}
 
 	virtual void release(const DiskPage<endian>& page) override
 	{
 		auto pageId = page.getIndex();
 
-		// Ensures(!queuePagePosition_[pageId]);
-
-		candidateQueue_.push_back(pageId);
-		queuePagePosition_[pageId] = candidateQueue_.size() - 1;
+		reserve(pageId);
+		unlink(pageId);
+		candidates_.pushBack(nodes_, pageId);
 	}
 
 	virtual optional<PageIndex> getCandidate() override
 	{
-		/*PageIndex candidate = candidateQueue_.front();
-		candidateQueue_.erase(candidateQueue_.begin());
+		if(candidates_.empty()) return {};
 
-		return candidate;*/
-			std::cout << "search candidate" << std::endl;
-		for(auto pageId : candidateQueue_)
-		{
-			candidateQueue_.erase(candidateQueue_.begin() + *queuePagePosition_[pageId]);
+		return candidates_.popFront(nodes_);
+	}
 
-			for(auto& pos : queuePagePosition_)
-			{
-				if(pos && (*pos > queuePagePosition_[pageId])) pos = pos - 1;
-			}
+	size_type getCandidateCount() const noexcept
+	{
+		return candidates_.size();
+	}
 
-			queuePagePosition_[pageId] = {};
+	private:
 
-			return pageId;
+	void reserve(PageIndex pageId)
+	{
+		if(pageId >= nodes_.size())
+		{
+			nodes_.resize(pageId + 1);
 		}
-
-		return {};
 	}
 
-	private:
+	void unlink(PageIndex pageId) noexcept
+	{
+		if(nodes_[pageId].linked)
+		{
+			candidates_.remove(nodes_, pageId);
+		}
+	}
 
-	/* Two vectors working together a bit like a sparse integer set */
-	std::vector<PageIndex> candidateQueue_;	
-	std::vector<optional<size_type>> queuePagePosition_;
+	typename CandidateList::NodeArray nodes_;
+	CandidateList candidates_;
 };
 
 #endif // LRU_PAGE_REPLACE_POLICY_HXX
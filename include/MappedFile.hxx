@@ -0,0 +1,64 @@
+#ifndef MAPPED_FILE_HXX
+#define MAPPED_FILE_HXX
+
+#include <Configuration.hxx>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#ifdef HAS_POSITIONAL_IO
+
+// How the mapping is going to be read, see MappedFile::advise.
+enum class MappingAdvice : flag_type
+{
+	normal,
+	sequential,
+	random,
+	willNeed
+};
+
+/* A whole file mapped read only in memory (mmap) : the bytes are read straight from the page cache of the system,
+ * without any copy, and the processes mapping the same file share the same cache.
+ * The size is the one of the file when it was mapped, the file must not shrink as long as it is mapped.
+ * Opening errors throw the same exceptions as the file streams.
+ */
+class MappedFile
+{
+public:
+	MappedFile(const std::string& filename);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Null for an empty file.
+	const uint8_t* getData() const noexcept
+	{
+		return data_;
+	}
+
+	size_type getSize() const noexcept
+	{
+		return size_;
+	}
+
+	/* Tells the system how the bytes from offset on are going to be read (madvise) : a sequential range is read ahead
+	 * aggressively, and freed once read, a range which will be needed is read in the background right away.
+	 * Only a hint, the failures are ignored. */
+	void advise(std::streamoff offset, size_type size, MappingAdvice advice) const noexcept;
+
+	const std::string& getCurrentFileName() const noexcept
+	{
+		return filename_;
+	}
+
+private:
+	uint8_t* data_;
+	size_type size_;
+	std::string filename_;
+};
+
+#endif
+
+#endif // MAPPED_FILE_HXX
@@ -4,14 +4,34 @@
 #include <Configuration.hxx>
 #include <DiskPage.hxx>
 #include <FileValueReader.hxx>
+#include <PositionalFile.hxx>
 
 #include <string>
 #include <vector>
 
+template<Endianness endian, IoBackend backend>
+struct PageReaderBaseSelector;
+
 template<Endianness endian>
-class PageReader : public FileValueReader<endian>
+struct PageReaderBaseSelector<endian, IoBackend::stream>
 {
-	using Base = FileValueReader<endian>;
+	using type = FileValueReader<endian>;
+};
+
+#ifdef HAS_POSITIONAL_IO
+template<Endianness endian>
+struct PageReaderBaseSelector<endian, IoBackend::positional>
+{
+	using type = PositionalFileReader<endian>;
+};
+#endif
+
+/* With the positional backend, reading a page does not touch any state of the reader, so any number of threads
+ * can read through the same reader at the same time. The stream backend has to be serialized. */
+template<Endianness endian, IoBackend backend = defaultIoBackend>
+class PageReader : public PageReaderBaseSelector<endian, backend>::type
+{
+	using Base = typename PageReaderBaseSelector<endian, backend>::type;
 	using PageIndex = typename DiskPage<endian>::PageIndex;
 
 	public:
@@ -23,7 +43,6 @@ class PageReader : public FileValueReader<endian>
 	{
 		static constexpr size_type offset = sizeof(decltype(std::declval<DiskPageHeader<endian>>().getNextPageOffset()));
 
-		std::cout << sizeof(decltype(std::declval<DiskPageHeader<endian>>().getRawPageSize())) << std::endl;
 		return this->readValue(sizeof(decltype(std::declval<DiskPageHeader<endian>>().getRawPageSize())), static_cast<std::streamoff>(pos) + offset);
 	}
 
@@ -36,23 +55,26 @@ class PageReader : public FileValueReader<endian>
 
 	DiskPage<endian> readPage(PageIndex index, std::streampos pos)
 	{
-	std::cout << "RAAAAA : " << pos << std::endl;
 		const auto rawPageSize = readRawPageSize(pos);
-		std::cout << "RAAAAA : " <<rawPageSize << std::endl;
 		std::vector<uint8_t> data(rawPageSize);
 		this->read(data, rawPageSize, pos);
-		/*for(auto d : data)
-	{std::cout << (int)d << " ";}*/
 
 		return {index, std::move(data)};
 	}
 
+	// Reads the page straight into its storage (the frame of the buffer it belongs to), and parses it in place.
+	void readPage(DiskPage<endian>& page, std::streampos pos)
+	{
+		const auto rawPageSize = readRawPageSize(pos);
+
+		this->read(page.prepare(rawPageSize), rawPageSize, pos);
+		page.load();
+	}
+
 	DiskPageHeader<endian> readPageHeader(std::streampos pos)
 	{
 		const auto headerSize = readHeaderSize(pos);
-		std::cout << "Hell yhea" << std::endl;
 		std::vector<uint8_t> data(headerSize);
-		std::cout << "Hell yhea : " << pos << " :" << headerSize << std::endl;
 		this->read(data, headerSize, pos);
 
 		return {std::move(data)};
@@ -4,8 +4,8 @@
 #include <Configuration.hxx>
 #include <DiskPage.hxx>
 #include <Optional.hxx>
-#include <BufferManager.hxx>
 
+#include <ios>
 #include <string>
 
 template<Endianness endian>
@@ -15,9 +15,23 @@ class PageReplacePolicy
 	using PageIndex = typename DiskPage<endian>::PageIndex;
 
 	public:
+	virtual ~PageReplacePolicy() = default;
+
 	virtual void use(const DiskPage<endian>& page) = 0;
 	virtual void release(const DiskPage<endian>& page) = 0;
 	virtual optional<PageIndex> getCandidate() = 0;
+
+	/* Notifications of the pages entering and leaving the buffer, along with their offset in the file.
+	 * Only the policies keeping an history of the evicted pages need them, hence the default empty implementation. */
+	virtual void pageLoaded(const DiskPage<endian>& /*page*/, std::streamoff /*offset*/) {}
+	virtual void pageEvicted(const DiskPage<endian>& /*page*/, std::streamoff /*offset*/) {}
+
+	/* Whether use and release can be called concurrently, between themselves and with getCandidate.
+	 * If not, the BufferManager serializes every call to the policy behind a single mutex. */
+	virtual bool isConcurrent() const noexcept
+	{
+		return false;
+	}
 };
 
 #endif // PAGE_REPLACE_POLICY_HXX
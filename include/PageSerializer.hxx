@@ -36,6 +36,9 @@ class PageSerializer
 		result.insert(result.end(), page.getSchemaName().begin(), page.getSchemaName().end());
 		result.push_back('\0');
 
+		Utils::RawDataAdaptator<uint32_t, sizeof(uint32_t), endian> formatVersionData{DiskPageHeader<endian>::formatVersion};
+		result.insert(result.end(), formatVersionData.bytes.begin(), formatVersionData.bytes.end());
+
 		using freeSlotCountType = decltype(page.getFreeSlotCount());
 		Utils::RawDataAdaptator<freeSlotCountType, sizeof(freeSlotCountType), endian> freeSlotCountData{page.getFreeSlotCount()};
 		result.insert(result.end(), freeSlotCountData.bytes.begin(), freeSlotCountData.bytes.end());
@@ -48,13 +51,10 @@ class PageSerializer
 		return serializeHeader(page.getHeader());
 	}
 
+	// The page is already kept in its serialized form.
 	static std::vector<uint8_t> serialize(const DiskPage<endian>& page) noexcept
 	{
-		std::vector<uint8_t> result{serializeHeader(page)};
-		result.insert(result.end(), page.getFrameIndicators().begin(), page.getFrameIndicators().end());
-		result.insert(result.end(), page.getData().begin(), page.getData().end());
-
-		return result;
+		return {page.getRawData().begin(), page.getRawData().end()};
 	}
 };
 
@@ -0,0 +1,120 @@
+#ifndef PAGE_WRITE_BATCH_HXX
+#define PAGE_WRITE_BATCH_HXX
+
+#include <Configuration.hxx>
+#include <DiskPage.hxx>
+#include <Range.hxx>
+
+#include <algorithm>
+#include <vector>
+
+/* A set of pages to write back together, with a single sync at the end (see PageWriter::writeBatch).
+ * The pages are written by increasing offset, and the pages which follow each other in the file are written at once :
+ * straight from their frames when the backend has gathered writes (pwritev), copied in a single buffer otherwise.
+ * The batch only refers to the bytes of the pages : they must stay alive, and unchanged, until the batch is written.
+ */
+template<Endianness endian>
+class PageWriteBatch
+{
+	public:
+	struct PendingPage
+	{
+		std::streamoff offset;
+		const uint8_t* bytes;
+		size_type size;
+	};
+
+	PageWriteBatch()
+	: pages_{},
+	  runBuffer_{}
+	{}
+
+	void add(const DiskPage<endian>& page, std::streamoff offset)
+	{
+		add(page.getRawData().begin(), page.getRawPageSize(), offset);
+	}
+
+	// The raw bytes of a page, copied elsewhere.
+	void add(const uint8_t* bytes, size_type size, std::streamoff offset)
+	{
+		pages_.push_back({offset, bytes, size});
+	}
+
+	size_type getPageCount() const noexcept
+	{
+		return pages_.size();
+	}
+
+	bool empty() const noexcept
+	{
+		return pages_.empty();
+	}
+
+	void clear() noexcept
+	{
+		pages_.clear();
+	}
+
+	/* Calls function(offset, pages) for each run of adjacent pages, by increasing offset, pages being the
+	 * range<const PendingPage*> of the run, for a gathered write. Returns the number of runs. */
+	template<class Function>
+	size_type forEachPageRun(Function function)
+	{
+		std::sort(pages_.begin(), pages_.end(), [](const PendingPage& lhs, const PendingPage& rhs)
+		{
+			return lhs.offset < rhs.offset;
+		});
+
+		size_type runCount = 0;
+
+		for(size_type runStart = 0; runStart < pages_.size();)
+		{
+			size_type runEnd = runStart + 1;
+			std::streamoff nextOffset = pages_[runStart].offset + pages_[runStart].size;
+
+			while((runEnd < pages_.size()) && (pages_[runEnd].offset == nextOffset))
+			{
+				nextOffset += pages_[runEnd].size;
+				++runEnd;
+			}
+
+			function(pages_[runStart].offset, range<const PendingPage*>{pages_.data() + runStart, pages_.data() + runEnd});
+
+			++runCount;
+			runStart = runEnd;
+		}
+
+		return runCount;
+	}
+
+	/* Calls function(offset, bytes, size) for each run of adjacent pages, by increasing offset, the pages of a run
+	 * being copied one after the other in a single buffer, only valid during the call. Returns the number of runs. */
+	template<class Function>
+	size_type forEachRun(Function function)
+	{
+		return forEachPageRun([this, &function](std::streamoff offset, range<const PendingPage*> pages)
+		{
+			if(pages.size() == 1)
+			{
+				function(offset, pages.begin()->bytes, pages.begin()->size);
+				return;
+			}
+
+			runBuffer_.clear();
+
+			for(const PendingPage& page : pages)
+			{
+				runBuffer_.insert(runBuffer_.end(), page.bytes, page.bytes + page.size);
+			}
+
+			function(offset, static_cast<const uint8_t*>(runBuffer_.data()), runBuffer_.size());
+		});
+	}
+
+	private:
+	std::vector<PendingPage> pages_;
+	// Kept between the runs, and the batches, not to allocate it every time.
+	std::vector<uint8_t> runBuffer_;
+};
+
+#endif // PAGE_WRITE_BATCH_HXX
@@ -5,28 +5,114 @@
 #include <DiskPage.hxx>
 #include <FileStream.hxx>
 #include <PageSerializer.hxx>
+#include <AsyncFileIo.hxx>
+#include <PageWriteBatch.hxx>
+#include <PositionalFile.hxx>
 
 #include <string>
+#include <type_traits>
+#include <vector>
 
-template<Endianness endian>
-class PageWriter : public FileStreamBase<StreamGoal::write>
+template<IoBackend backend>
+struct PageWriterBaseSelector;
+
+template<>
+struct PageWriterBaseSelector<IoBackend::stream>
+{
+	using type = FileStreamBase<StreamGoal::write>;
+};
+
+#ifdef HAS_POSITIONAL_IO
+template<>
+struct PageWriterBaseSelector<IoBackend::positional>
 {
-	using Base = FileStreamBase<StreamGoal::write>;
+	using type = PositionalFile;
+};
+#endif
+
+/* With the positional backend, the writes of different pages can run at the same time, and a run of adjacent pages
+ * is written straight from the frames (see writeBatch). The stream backend has to be serialized. */
+template<Endianness endian, IoBackend backend = defaultIoBackend>
+class PageWriter : public PageWriterBaseSelector<backend>::type
+{
+	using Base = typename PageWriterBaseSelector<backend>::type;
+	using PendingPage = typename PageWriteBatch<endian>::PendingPage;
 
 	public:
 	PageWriter(const std::string& fileName)
 	: Base(fileName, std::ios_base::out | std::ios_base::in | std::ios::binary)
 	{}
 
+	// The raw page is written as is, no serialization needed.
 	void writePage(const DiskPage<endian>& page, std::streampos pos)
 	{
-		this->write(PageSerializer<endian>::serialize(page), pos);
+		this->write(page.getRawData().begin(), page.getRawPageSize(), pos);
 		this->flush();
 	}
 
+	/* One write by run of adjacent pages, and a single sync for the whole batch : the batch is on the device once it
+	 * returns. Returns the number of writes. */
+	size_type writeBatch(PageWriteBatch<endian>& batch)
+	{
+		size_type writeCount = writeRuns(batch, std::integral_constant<IoBackend, backend>{});
+
+		this->sync();
+
+		return writeCount;
+	}
+
+#ifdef HAS_POSITIONAL_IO
+	/* Same as writeBatch, but every run is in flight at once through io, which must be opened on the file of the writer.
+	 * A run written only in part is written again, synchronously. */
+	template<IoBackend usedBackend = backend, typename std::enable_if_t<usedBackend == IoBackend::positional>* = nullptr>
+	size_type writeBatch(PageWriteBatch<endian>& batch, AsyncFileIo& io)
+	{
+		std::vector<std::vector<iovec>> runBuffers;
+		std::vector<std::streamoff> runOffsets;
+		std::vector<size_type> runSizes;
+
+		batch.forEachPageRun([&](std::streamoff offset, range<const PendingPage*> pages)
+		{
+			runBuffers.emplace_back();
+			runOffsets.push_back(offset);
+			runSizes.push_back(0);
+
+			for(const PendingPage& page : pages)
+			{
+				runBuffers.back().push_back({const_cast<uint8_t*>(page.bytes), page.size});
+				runSizes.back() += page.size;
+			}
+		});
+
+		std::vector<AsyncIoCompletion> completions;
+
+		for(size_type i = 0; i < runBuffers.size(); ++i)
+		{
+			while(!io.prepareWriteVector(runBuffers[i].data(), runBuffers[i].size(), runOffsets[i], i))
+			{
+				io.wait(completions);
+			}
+		}
+
+		io.wait(completions, io.getPendingCount());
+
+		for(const AsyncIoCompletion& completion : completions)
+		{
+			if(completion.result != static_cast<int64_t>(runSizes[completion.tag]))
+			{
+				this->writeVector(runBuffers[completion.tag].data(), runBuffers[completion.tag].size(), runOffsets[completion.tag]);
+			}
+		}
+
+		this->sync();
+
+		return runBuffers.size();
+	}
+#endif
+
 	void appendPage(const DiskPage<endian>& page)
 	{
-		this->append(PageSerializer<endian>::serialize(page));
+		this->append(page.getRawData().begin(), page.getRawPageSize());
 		this->flush();
 	}
 
@@ -35,6 +121,34 @@ class PageWriter : public FileStreamBase<StreamGoal::write>
 		this->write(PageSerializer<endian>::serializeHeader(header), pos);
 		this->flush();
 	}
+
+	private:
+	size_type writeRuns(PageWriteBatch<endian>& batch, std::integral_constant<IoBackend, IoBackend::stream>)
+	{
+		return batch.forEachRun([this](std::streamoff offset, const uint8_t* bytes, size_type size)
+		{
+			this->write(bytes, size, offset);
+		});
+	}
+
+#ifdef HAS_POSITIONAL_IO
+	size_type writeRuns(PageWriteBatch<endian>& batch, std::integral_constant<IoBackend, IoBackend::positional>)
+	{
+		std::vector<iovec> buffers;
+
+		return batch.forEachPageRun([this, &buffers](std::streamoff offset, range<const PendingPage*> pages)
+		{
+			buffers.clear();
+
+			for(const PendingPage& page : pages)
+			{
+				buffers.push_back({const_cast<uint8_t*>(page.bytes), page.size});
+			}
+
+			this->writeVector(buffers.data(), buffers.size(), offset);
+		});
+	}
+#endif
 };
 
 #endif // PAGE_WRITER_HXX
@@ -0,0 +1,159 @@
+#ifndef POSITIONAL_FILE_HXX
+#define POSITIONAL_FILE_HXX
+
+#include <Configuration.hxx>
+#include <RawDataUtils.hxx>
+
+#include <gsl/gsl_assert.h>
+
+#include <array>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <sys/uio.h>
+
+/* A file accessed through its descriptor, with pread and pwrite : every access gives its own position, there is no
+ * shared stream position to seek first, and no stream buffer in between.
+ * So any number of threads can read the file at the same time, and write it too, as long as they do not write the
+ * same bytes. Nothing is buffered, so flush has nothing to do : the data is handed to the system by the write itself.
+ * sync goes further, and waits for the data to reach the device.
+ * The interface follows the one of the file streams (see FileStreamSelector), with the same exceptions.
+ */
+class PositionalFile
+{
+public:
+	PositionalFile(const std::string& filename, std::ios::ios_base::openmode flags);
+	~PositionalFile();
+
+	PositionalFile(const PositionalFile&) = delete;
+	PositionalFile& operator=(const PositionalFile&) = delete;
+
+	void read(unsigned char* buffer, size_type size, std::streampos position) const;
+
+	void read(char* buffer, size_type size, std::streampos position) const
+	{
+		read(reinterpret_cast<unsigned char*>(buffer), size, position);
+	}
+
+	template<class T, size_type n>
+	void read(std::array<T, n>& buffer, size_type size, std::streampos position) const
+	{
+		static_assert(std::is_convertible<T, char>::value || std::is_convertible<T, unsigned char>::value,
+				     "The buffer must contain byte size values.");
+		Ensures(size <= n);
+		read(buffer.data(), size, position);
+	}
+
+	template<class T>
+	void read(std::vector<T>& buffer, size_type size, std::streampos position) const
+	{
+		static_assert(std::is_convertible<T, char>::value || std::is_convertible<T, unsigned char>::value,
+				     "The buffer must contain byte size values.");
+		buffer.resize(size);
+		read(buffer.data(), buffer.size(), position);
+	}
+
+	// Scattered read, the buffers are filled one after the other from position (preadv).
+	void readVector(const iovec* buffers, size_type count, std::streampos position) const;
+
+	void write(const unsigned char* buffer, size_type size, std::streampos position);
+
+	void write(const char* buffer, size_type size, std::streampos position)
+	{
+		write(reinterpret_cast<const unsigned char*>(buffer), size, position);
+	}
+
+	template<class T, size_type n>
+	void write(const std::array<T, n>& buffer, std::streampos position)
+	{
+		static_assert(std::is_convertible<T, char>::value || std::is_convertible<T, unsigned char>::value,
+					 "The buffer must contain byte size values.");
+		write(buffer.data(), buffer.size(), position);
+	}
+
+	template<class T>
+	void write(const std::vector<T>& buffer, std::streampos position)
+	{
+		static_assert(std::is_convertible<T, char>::value || std::is_convertible<T, unsigned char>::value,
+					  "The buffer must contain byte size values.");
+		write(buffer.data(), buffer.size(), position);
+	}
+
+	// Gathered write, the buffers are written one after the other from position (pwritev).
+	void writeVector(const iovec* buffers, size_type count, std::streampos position);
+
+	// Not atomic : two threads appending at the same time would write at the same place.
+	void append(const unsigned char* buffer, size_type size)
+	{
+		write(buffer, size, getFileSize());
+	}
+
+	void append(const char* buffer, size_type size)
+	{
+		append(reinterpret_cast<const unsigned char*>(buffer), size);
+	}
+
+	template<class T>
+	void append(const std::vector<T>& buffer)
+	{
+		append(buffer.data(), buffer.size());
+	}
+
+	void flush() noexcept
+	{}
+
+	// Returns once the data written so far is on the device (fdatasync), throws if it can not get there.
+	void sync();
+
+	std::streampos getFileSize() const;
+
+	/* Direct I/O bypasses the cache of the system : the data goes straight between the device and the buffers. Every
+	 * transfer must then be aligned, its buffer, position and size being multiples of the block size of the device.
+	 * Throws if the file system does not support it. */
+	void setDirectIo(bool enable);
+
+	bool isOpen() const noexcept
+	{
+		return descriptor_ >= 0;
+	}
+
+	// For the asynchronous requests on the file (see AsyncFileIo).
+	int getDescriptor() const noexcept
+	{
+		return descriptor_;
+	}
+
+	const std::string& getCurrentFileName() const noexcept
+	{
+		return filename_;
+	}
+
+private:
+	int descriptor_;
+	std::string filename_;
+};
+
+template<Endianness endian>
+class PositionalFileReader : public PositionalFile
+{
+public:
+	PositionalFileReader(const std::string& filename, std::ios::ios_base::openmode flags = std::ios_base::in | std::ios::binary)
+	: PositionalFile(filename, flags)
+	{}
+
+	size_type readValue(size_type size, std::streampos position) const
+	{
+		std::array<unsigned char, sizeof(size_type)> value{};
+		read(value, size, position);
+
+		return Utils::RawDataConverter<endian>::rawDataToInteger(value.begin(), value.begin() + size);
+	}
+};
+
+#endif
+
+#endif // POSITIONAL_FILE_HXX
@@ -0,0 +1,550 @@
+#ifndef PREDICATE_HXX
+#define PREDICATE_HXX
+
+#include <Configuration.hxx>
+#include <CsvRowEncoder.hxx>
+#include <DataTypes.hxx>
+#include <FieldCompare.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <SlotBitmap.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class PredicateException : public std::exception
+{
+public:
+	PredicateException(const std::string& msg) : msg_{std::string{"Error when binding the predicate : "} + msg}
+	{}
+
+	const char* what() const noexcept override
+	{
+		return msg_.c_str();
+	}
+
+private:
+	const std::string msg_;
+};
+
+enum class CompareOperator : flag_type
+{
+	equal,
+	notEqual,
+	less,
+	lessOrEqual,
+	greater,
+	greaterOrEqual
+};
+
+template<Endianness endian>
+class BoundPredicate;
+
+template<Endianness endian>
+class BatchFilter;
+
+/* A condition on the rows of a schema, which the database can evaluate on the bytes of the rows, in the pages, instead
+ * of on copies of them (see DbSystem::updateWhen and removeWhen) :
+ *
+ *     auto pred = Predicate::compare("Name", CompareOperator::equal, "Norbert")
+ *              || (Predicate::compare("BestTime", CompareOperator::less, 3600) && Predicate::compare("Number", CompareOperator::greater, 5));
+ *
+ * The constants are written as the fields they are compared to, once, when the predicate is bound to the schema : the
+ * strings are compared byte by byte, the integers, dates and booleans as unsigned numbers, the floating point numbers
+ * as such. A constant may also be given as text, written as in a CSV file (see CsvRowEncoder), a date for instance.
+ */
+class Predicate
+{
+	template<Endianness endian>
+	friend class BoundPredicate;
+
+	template<Endianness endian>
+	friend class BatchFilter;
+
+public:
+	template<class T>
+	static Predicate compare(std::string fieldName, CompareOperator op, T constant)
+	{
+		Predicate predicate{Kind::comparison};
+		predicate.fieldName_ = std::move(fieldName);
+		predicate.operator_ = op;
+		predicate.constant_ = toText(constant);
+
+		return predicate;
+	}
+
+	// Matched by every row : the condition of a statement without any.
+	static Predicate always()
+	{
+		return Predicate{Kind::conjunction};
+	}
+
+	friend Predicate operator&&(Predicate lhs, Predicate rhs)
+	{
+		return combine(Kind::conjunction, std::move(lhs), std::move(rhs));
+	}
+
+	friend Predicate operator||(Predicate lhs, Predicate rhs)
+	{
+		return combine(Kind::disjunction, std::move(lhs), std::move(rhs));
+	}
+
+	// The fields the predicate reads, once each.
+	std::vector<std::string> getFieldNames() const
+	{
+		std::vector<std::string> fieldNames;
+		collectFieldNames(fieldNames);
+
+		return fieldNames;
+	}
+
+	// The same condition on other fields, rename giving the new name of every field.
+	template<class Rename>
+	Predicate renameFields(Rename rename) const
+	{
+		Predicate predicate{*this};
+
+		if(kind_ == Kind::comparison) predicate.fieldName_ = rename(fieldName_);
+
+		for(Predicate& operand : predicate.operands_) operand = operand.renameFields(rename);
+
+		return predicate;
+	}
+
+private:
+	enum class Kind : flag_type
+	{
+		comparison,
+		conjunction,
+		disjunction
+	};
+
+	explicit Predicate(Kind kind)
+	: kind_{kind},
+	  operator_{CompareOperator::equal}
+	{}
+
+	// a && b && c is a single conjunction of three operands.
+	static Predicate combine(Kind kind, Predicate lhs, Predicate rhs)
+	{
+		Predicate predicate{kind};
+
+		for(Predicate* operand : {&lhs, &rhs})
+		{
+			if(operand->kind_ == kind)
+			{
+				std::move(operand->operands_.begin(), operand->operands_.end(), std::back_inserter(predicate.operands_));
+			}
+			else
+			{
+				predicate.operands_.push_back(std::move(*operand));
+			}
+		}
+
+		return predicate;
+	}
+
+	void collectFieldNames(std::vector<std::string>& fieldNames) const
+	{
+		if((kind_ == Kind::comparison) && (std::find(fieldNames.begin(), fieldNames.end(), fieldName_) == fieldNames.end()))
+		{
+			fieldNames.push_back(fieldName_);
+		}
+
+		for(const Predicate& operand : operands_) operand.collectFieldNames(fieldNames);
+	}
+
+	static std::string toText(const std::string& constant)
+	{
+		return constant;
+	}
+
+	static std::string toText(const char* constant)
+	{
+		return constant;
+	}
+
+	static std::string toText(bool constant)
+	{
+		return constant ? "true" : "false";
+	}
+
+	template<class T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+	static std::string toText(T constant)
+	{
+		return std::to_string(constant);
+	}
+
+	template<class T, std::enable_if_t<std::is_floating_point<T>::value, int> = 0>
+	static std::string toText(T constant)
+	{
+		std::ostringstream sstr;
+		sstr.precision(std::numeric_limits<T>::max_digits10);
+		sstr << constant;
+
+		return sstr.str();
+	}
+
+	Kind kind_;
+	std::string fieldName_;
+	CompareOperator operator_;
+	std::string constant_;
+	std::vector<Predicate> operands_;
+};
+
+/* A predicate resolved against a schema : the fields are found and the constants decoded once, a row is then only read
+ * where it is compared, without any allocation. The predicate tree is flattened, every node followed by its operands.
+ */
+template<Endianness endian>
+class BoundPredicate
+{
+public:
+	BoundPredicate(const Predicate& predicate, const DbSchema& schema)
+	: rowSize_{schema.getDataSize()}
+	{
+		bind(predicate, schema);
+	}
+
+	// The row must be of the schema the predicate is bound to.
+	bool matches(const uint8_t* row) const noexcept
+	{
+		return evaluate(0, row);
+	}
+
+	/* Sets the bits of the used slots matching the predicate in a mask laid out as the slot bitmap, a comparison at a time
+	 * for all the slots of a page : the integers, dates and floating point numbers of a little endian file are compared
+	 * by FieldCompare, the other fields slot by slot. The rows must be the rows of a page.
+	 */
+	void matchSlots(const uint8_t* rows, const uint8_t* slotBitmap, size_type slotCount, uint8_t* mask)
+	{
+		size_type maskSize = SlotBitmap::getSize(slotCount);
+
+		if(masks_.size() < nodes_.size() * maskSize) masks_.resize(nodes_.size() * maskSize);
+
+		evaluateSlots(0, rows, slotCount, mask);
+
+		for(size_type i = 0; i < maskSize / sizeof(uint64_t); ++i)
+		{
+			SlotBitmap::storeWord(mask, i, SlotBitmap::loadWord(mask, i) & SlotBitmap::loadWord(slotBitmap, i));
+		}
+	}
+
+private:
+	// How a field is compared.
+	enum class ValueKind : flag_type
+	{
+		bytes,
+		unsignedInteger,
+		date,
+		boolean,
+		floatingPoint
+	};
+
+	struct Node
+	{
+		Predicate::Kind kind;
+		// The node after the operands of this one.
+		size_type end;
+		FieldRef field;
+		ValueKind valueKind;
+		CompareOperator op;
+		uint64_t integer;
+		double floating;
+		std::vector<uint8_t> bytes;
+		// The comparison as a range, matched by FieldCompare if isVectorized.
+		bool isVectorized;
+		uint64_t lowInteger;
+		uint64_t highInteger;
+		double lowFloating;
+		double highFloating;
+	};
+
+	void bind(const Predicate& predicate, const DbSchema& schema)
+	{
+		size_type index = nodes_.size();
+		nodes_.push_back(Node{predicate.kind_, 0, {}, ValueKind::bytes, predicate.operator_, 0, 0, {}, false, 0, 0, 0, 0});
+
+		if(predicate.kind_ == Predicate::Kind::comparison)
+		{
+			bindComparison(nodes_[index], predicate, schema);
+		}
+		else
+		{
+			for(const Predicate& operand : predicate.operands_) bind(operand, schema);
+		}
+
+		nodes_[index].end = nodes_.size();
+	}
+
+	static void bindComparison(Node& node, const Predicate& predicate, const DbSchema& schema)
+	{
+		optional<FieldRef> field = schema.findFieldRef(predicate.fieldName_);
+
+		if(!field) throw PredicateException("there is no field " + predicate.fieldName_ + " in " + schema.getName());
+
+		node.field = *field;
+		node.valueKind = getValueKind(node.field.type);
+		node.bytes.resize(node.field.size);
+
+		try
+		{
+			CsvRowEncoder<endian> encoder{schema};
+			encoder.encodeField(node.field, {predicate.constant_.data(), predicate.constant_.data() + predicate.constant_.size()},
+								node.bytes.data());
+		}
+		catch(const CsvImportException&)
+		{
+			throw PredicateException("'" + predicate.constant_ + "' can not be compared to the field " + predicate.fieldName_);
+		}
+
+		// The constant is read back as the rows will be.
+		node.integer = readUnsigned(node, node.bytes.data());
+		node.floating = readFloatingPoint(node, node.bytes.data());
+
+		// The dates of a little endian file are their own keys.
+		bool isFixedSize = (node.valueKind == ValueKind::unsignedInteger) || (node.valueKind == ValueKind::date)
+						|| ((node.valueKind == ValueKind::floatingPoint) && ((node.field.size == sizeof(float)) || (node.field.size == sizeof(double))));
+		node.isVectorized = (endian == Endianness::little) && isFixedSize;
+
+		if(node.valueKind != ValueKind::floatingPoint)
+		{
+			getRange<uint64_t>(node.op, node.integer, 0, std::numeric_limits<uint64_t>::max(), node.lowInteger, node.highInteger);
+		}
+		else if(node.field.size == sizeof(float))
+		{
+			float low, high;
+			getRange<float>(node.op, static_cast<float>(node.floating), -std::numeric_limits<float>::infinity(),
+							std::numeric_limits<float>::infinity(), low, high);
+
+			node.lowFloating = low;
+			node.highFloating = high;
+		}
+		else
+		{
+			getRange<double>(node.op, node.floating, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+							 node.lowFloating, node.highFloating);
+		}
+	}
+
+	// The values matching the comparison to the constant, or not matching it for notEqual, as [low, high].
+	template<class T>
+	static void getRange(CompareOperator op, T constant, T lowest, T highest, T& low, T& high) noexcept
+	{
+		low = lowest;
+		high = highest;
+
+		switch(op)
+		{
+			case CompareOperator::equal:
+			case CompareOperator::notEqual:
+				low = high = constant;
+				break;
+			case CompareOperator::less:
+				if(constant == lowest) std::swap(low, high);
+				else high = previous(constant);
+				break;
+			case CompareOperator::lessOrEqual:
+				high = constant;
+				break;
+			case CompareOperator::greater:
+				if(constant == highest) std::swap(low, high);
+				else low = next(constant);
+				break;
+			default:
+				low = constant;
+		}
+	}
+
+	static uint64_t previous(uint64_t value) noexcept
+	{
+		return value - 1;
+	}
+
+	static uint64_t next(uint64_t value) noexcept
+	{
+		return value + 1;
+	}
+
+	template<class T>
+	static T previous(T value) noexcept
+	{
+		return std::nextafter(value, -std::numeric_limits<T>::infinity());
+	}
+
+	template<class T>
+	static T next(T value) noexcept
+	{
+		return std::nextafter(value, std::numeric_limits<T>::infinity());
+	}
+
+	static ValueKind getValueKind(DataType type)
+	{
+		if(type == DataType::INTEGER) return ValueKind::unsignedInteger;
+		if(type == DataType::DATE) return ValueKind::date;
+		if(type == DataType::BOOLEAN) return ValueKind::boolean;
+		if((type == DataType::FLOAT) || (type == DataType::TIME)) return ValueKind::floatingPoint;
+
+		return ValueKind::bytes;
+	}
+
+	bool evaluate(size_type index, const uint8_t* row) const noexcept
+	{
+		const Node& node = nodes_[index];
+
+		if(node.kind == Predicate::Kind::comparison) return compare(node, row);
+
+		// Stops at the first operand deciding the result.
+		bool isConjunction = (node.kind == Predicate::Kind::conjunction);
+
+		for(size_type operand = index + 1; operand < node.end; operand = nodes_[operand].end)
+		{
+			if(evaluate(operand, row) != isConjunction) return !isConjunction;
+		}
+
+		return isConjunction;
+	}
+
+	void evaluateSlots(size_type index, const uint8_t* rows, size_type slotCount, uint8_t* mask) noexcept
+	{
+		const Node& node = nodes_[index];
+
+		if(node.kind == Predicate::Kind::comparison) return compareSlots(node, rows, slotCount, mask);
+
+		// The first operand is written to the mask, the others to the mask of the node, then merged.
+		size_type wordCount = SlotBitmap::getSize(slotCount) / sizeof(uint64_t);
+		uint8_t* operandMask = masks_.data() + index * wordCount * sizeof(uint64_t);
+		bool isConjunction = (node.kind == Predicate::Kind::conjunction);
+
+		// Without any operand, a conjunction is always true, a disjunction never.
+		if(index + 1 == node.end)
+		{
+			std::memset(mask, 0, wordCount * sizeof(uint64_t));
+
+			for(size_type slot = 0; isConjunction && (slot < slotCount); ++slot) SlotBitmap::set(mask, slot);
+
+			return;
+		}
+
+		evaluateSlots(index + 1, rows, slotCount, mask);
+
+		for(size_type operand = nodes_[index + 1].end; operand < node.end; operand = nodes_[operand].end)
+		{
+			evaluateSlots(operand, rows, slotCount, operandMask);
+
+			for(size_type i = 0; i < wordCount; ++i)
+			{
+				uint64_t word = SlotBitmap::loadWord(mask, i);
+				uint64_t operandWord = SlotBitmap::loadWord(operandMask, i);
+
+				SlotBitmap::storeWord(mask, i, isConjunction ? (word & operandWord) : (word | operandWord));
+			}
+		}
+	}
+
+	void compareSlots(const Node& node, const uint8_t* rows, size_type slotCount, uint8_t* mask) const noexcept
+	{
+		const uint8_t* fields = rows + node.field.offset;
+		bool negate = (node.op == CompareOperator::notEqual);
+
+		if(node.isVectorized && (node.valueKind != ValueKind::floatingPoint))
+		{
+			FieldCompare::compareIntegers(fields, node.field.size, rowSize_, slotCount, node.lowInteger, node.highInteger, negate, mask);
+		}
+		else if(node.isVectorized && (node.field.size == sizeof(float)))
+		{
+			FieldCompare::compareFloatingPoints<float>(fields, rowSize_, slotCount, static_cast<float>(node.lowFloating),
+													   static_cast<float>(node.highFloating), negate, mask);
+		}
+		else if(node.isVectorized)
+		{
+			FieldCompare::compareFloatingPoints<double>(fields, rowSize_, slotCount, node.lowFloating, node.highFloating, negate, mask);
+		}
+		else
+		{
+			for(size_type first = 0; first < slotCount; first += 64)
+			{
+				size_type count = std::min<size_type>(slotCount - first, 64);
+				uint64_t word = 0;
+
+				for(size_type i = 0; i < count; ++i) word |= static_cast<uint64_t>(compare(node, rows + (first + i) * rowSize_)) << i;
+
+				SlotBitmap::storeWord(mask, first / 64, word);
+			}
+		}
+	}
+
+	static bool compare(const Node& node, const uint8_t* row) noexcept
+	{
+		const uint8_t* field = row + node.field.offset;
+
+		switch(node.valueKind)
+		{
+			case ValueKind::bytes:
+				return test(node.op, std::memcmp(field, node.bytes.data(), node.field.size), 0);
+			case ValueKind::floatingPoint:
+				return test(node.op, readFloatingPoint(node, field), node.floating);
+			default:
+				return test(node.op, readUnsigned(node, field), node.integer);
+		}
+	}
+
+	template<class T>
+	static bool test(CompareOperator op, T lhs, T rhs) noexcept
+	{
+		switch(op)
+		{
+			case CompareOperator::equal:
+				return lhs == rhs;
+			case CompareOperator::notEqual:
+				return lhs != rhs;
+			case CompareOperator::less:
+				return lhs < rhs;
+			case CompareOperator::lessOrEqual:
+				return lhs <= rhs;
+			case CompareOperator::greater:
+				return lhs > rhs;
+			default:
+				return lhs >= rhs;
+		}
+	}
+
+	// The integers, the dates as year, month then day, and the booleans as 0 or 1.
+	static uint64_t readUnsigned(const Node& node, const uint8_t* field) noexcept
+	{
+		switch(node.valueKind)
+		{
+			case ValueKind::unsignedInteger:
+				return static_cast<uint64_t>(Utils::RawDataConverter<endian>::rawDataToStreamoff(field, field + node.field.size));
+			case ValueKind::date:
+				return (Utils::RawDataConverter<endian>::rawDataToInteger(field + 2, field + 4) << 16) | (field[1] << 8) | field[0];
+			case ValueKind::boolean:
+				return *field != 0;
+			default:
+				return 0;
+		}
+	}
+
+	static double readFloatingPoint(const Node& node, const uint8_t* field) noexcept
+	{
+		if(node.valueKind != ValueKind::floatingPoint) return 0;
+
+		return (node.field.size == sizeof(float)) ? Utils::RawDataConverter<endian>::rawDataToFloat(field, field + node.field.size)
+												  : Utils::RawDataConverter<endian>::rawDataToDouble(field, field + node.field.size);
+	}
+
+	size_type rowSize_;
+	std::vector<Node> nodes_;
+	// The masks of the operands of the nodes, for matchSlots.
+	std::vector<uint8_t> masks_;
+};
+
+#endif // PREDICATE_HXX
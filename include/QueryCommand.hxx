@@ -0,0 +1,14 @@
+#ifndef QUERY_COMMAND_HXX
+#define QUERY_COMMAND_HXX
+
+/* The query command of the executable : runs a statement on a database, see QueryParser.
+ *
+ *     query <database> <schema file> <statement>
+ *
+ * The rows of a select are printed one by line, their columns separated by tabs, after a line with the names of the
+ * columns. For the other statements, the count of rows inserted, updated or removed is printed.
+ * The arguments start with the name of the command. Returns the exit code of the executable.
+ */
+int runQueryCommand(int argc, char** argv);
+
+#endif // QUERY_COMMAND_HXX
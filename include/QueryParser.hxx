@@ -2,99 +2,789 @@
 #define QUERY_PARSER_HXX
 
 #include <Configuration.hxx>
-#include <DataType.hxx>
+#include <DataTypes.hxx>
 #include <DbSystem.hxx>
+#include <BatchOperators.hxx>
+#include <Predicate.hxx>
+#include <QueryPlan.hxx>
+#include <Schema.hxx>
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <exception>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
 
 class ParsingException : public std::exception
 {
 public:
 	ParsingException(const std::string& symbol, const std::string& desc)
-	: msg_{std::string{"Error during the query parsing : " + symbol + " (" + desc + ")"}
+	: msg_{std::string{"Error during the query parsing : " + symbol + " (" + desc + ")"}}
 	{}
 
 	virtual const char* what() const noexcept override
 	{
-		return msg.c_str();
+		return msg_.c_str();
 	}
 
 private:
-	msg_;
+	const std::string msg_;
 };
 
+/* Parses a statement into a SqlStatement, its names checked against the schemas, to be planned (see QueryPlanner) :
+ *
+ *	SELECT r.Name, count(*) FROM Runner AS r JOIN Club c ON r.Club = c.Id WHERE c.City = 'Lyon' AND r.BestTime < 3600
+ *		GROUP BY r.Name ORDER BY count(*) DESC LIMIT 10
+ *	INSERT INTO Runner (Name, BestTime) VALUES ('Norbert', 3400), ('Ann', 3550)
+ *	UPDATE Runner SET BestTime = 3300 WHERE Name = 'Norbert'
+ *	DELETE FROM Runner WHERE BestTime BETWEEN 4000 AND 5000 OR Name = 'Ann'
+ *
+ * The keywords are in any case, the names of the schemas and of the fields as written in them. The strings are quoted
+ * with single quotes, doubled in the string. A column is compared to a constant, the columns of two tables are only
+ * compared by the ON of a join, on their equality.
+ * A column may be named without its table, when a single one of the tables has such a field.
+ */
 template<Endianness endian>
-class QueryIterator
+class QueryParser
 {
 public:
-	QueryIterator(DbSystem<endian>& system)
-	: iterator_{system.getIterator()},
-	  endIterator_{
+	QueryParser(const DbSystem<endian>& system)
+	: findSchema_{[&system](const std::string& name) -> const DbSchema* {
+		auto schemaIndex = system.getSchemaIndex(name);
+		return schemaIndex ? &*system.getSchema(*schemaIndex) : nullptr;
+	  }}
+	{}
+
+	// The schemas must outlive the parser.
+	QueryParser(const std::vector<DbSchema>& schemas)
+	: findSchema_{[&schemas](const std::string& name) -> const DbSchema* {
+		auto it = std::find_if(schemas.begin(), schemas.end(), [&name](const DbSchema& schema) { return schema.getName() == name; });
+		return (it != schemas.end()) ? &*it : nullptr;
+	  }}
 	{}
 
-	DbEntry<endian, PageType::ReadOnly> operator*() noexcept
+	SqlStatement parse(const std::string& text) const
 	{
-		auto dataStart = pageHandle_.get()->getData().begin() + (currentEntryIndex_ * schema_.getDataSize());
-		std::vector<uint8_t> tmp(dataStart, dataStart + schema_.getDataSize());
-		return {schema_, tmp};
+		Context context{text};
+
+		if(context.lexer.acceptKeyword("SELECT")) parseSelect(context);
+		else if(context.lexer.acceptKeyword("INSERT")) parseInsert(context);
+		else if(context.lexer.acceptKeyword("UPDATE")) parseUpdate(context);
+		else if(context.lexer.acceptKeyword("DELETE")) parseDelete(context);
+		else context.lexer.fail("expected SELECT, INSERT, UPDATE or DELETE");
+
+		context.lexer.acceptSymbol(";");
+		if(context.lexer.peek().type != TokenType::end) context.lexer.fail("expected the end of the statement");
+
+		return std::move(context.statement);
 	}
 
+private:
+	enum class TokenType : flag_type
+	{
+		identifier,
+		number,
+		string,
+		symbol,
+		end
+	};
+
+	struct Token
+	{
+		TokenType type;
+		std::string text;
+	};
+
+	// Cuts the statement into tokens, one ahead of the parser.
+	class Lexer
+	{
+	public:
+		explicit Lexer(const std::string& text)
+		: it_{text.data()},
+		  end_{text.data() + text.size()}
+		{
+			advance();
+		}
+
+		const Token& peek() const noexcept
+		{
+			return token_;
+		}
+
+		Token take()
+		{
+			Token token = std::move(token_);
+			advance();
+
+			return token;
+		}
+
+		bool isKeyword(const char* keyword) const noexcept
+		{
+			return (token_.type == TokenType::identifier) && isKeyword(token_.text, keyword);
+		}
+
+		// Whether the name is the keyword, in upper case, in any case, the keywords being plain ASCII.
+		static bool isKeyword(const std::string& name, const char* keyword) noexcept
+		{
+			for(char c : name)
+			{
+				if((*keyword == '\0') || ((((c >= 'a') && (c <= 'z')) ? c - 'a' + 'A' : c) != *keyword)) return false;
+				++keyword;
+			}
+
+			return *keyword == '\0';
+		}
+
+		bool acceptKeyword(const char* keyword)
+		{
+			if(!isKeyword(keyword)) return false;
+
+			advance();
+			return true;
+		}
+
+		void expectKeyword(const char* keyword)
+		{
+			if(!acceptKeyword(keyword)) fail(std::string{"expected "} + keyword);
+		}
+
+		bool isSymbol(const char* symbol) const noexcept
+		{
+			return (token_.type == TokenType::symbol) && (token_.text == symbol);
+		}
+
+		bool acceptSymbol(const char* symbol)
+		{
+			if(!isSymbol(symbol)) return false;
+
+			advance();
+			return true;
+		}
+
+		void expectSymbol(const char* symbol)
+		{
+			if(!acceptSymbol(symbol)) fail(std::string{"expected "} + symbol);
+		}
+
+		// A name, which can not be a keyword.
+		std::string expectIdentifier(const char* what)
+		{
+			if((token_.type != TokenType::identifier) || isReserved()) fail(std::string{"expected "} + what);
+
+			return take().text;
+		}
+
+		bool isReserved() const noexcept
+		{
+			static const char* const keywords[] = {"SELECT", "FROM", "WHERE", "AND", "OR", "GROUP", "ORDER", "BY", "ASC", "DESC", "LIMIT",
+												   "JOIN", "INNER", "ON", "AS", "INSERT", "INTO", "VALUES", "UPDATE", "SET", "DELETE",
+												   "BETWEEN", "TRUE", "FALSE"};
+
+			return std::any_of(std::begin(keywords), std::end(keywords), [this](const char* keyword) { return isKeyword(keyword); });
+		}
+
+		[[noreturn]] void fail(const std::string& desc) const
+		{
+			throw ParsingException((token_.type == TokenType::end) ? "end of the statement" : token_.text, desc);
+		}
+
+	private:
+		void advance()
+		{
+			while((it_ != end_) && std::isspace(static_cast<unsigned char>(*it_))) ++it_;
+
+			const char* begin = it_;
+
+			if(it_ == end_)
+			{
+				token_ = {TokenType::end, {}};
+			}
+			else if(std::isalpha(static_cast<unsigned char>(*it_)) || (*it_ == '_'))
+			{
+				while((it_ != end_) && (std::isalnum(static_cast<unsigned char>(*it_)) || (*it_ == '_'))) ++it_;
+				token_ = {TokenType::identifier, {begin, it_}};
+			}
+			else if(isNumberStart())
+			{
+				if((*it_ == '-') || (*it_ == '+')) ++it_;
+				while((it_ != end_) && (std::isdigit(static_cast<unsigned char>(*it_)) || (*it_ == '.'))) ++it_;
+
+				if((it_ != end_) && ((*it_ == 'e') || (*it_ == 'E')))
+				{
+					++it_;
+					if((it_ != end_) && ((*it_ == '-') || (*it_ == '+'))) ++it_;
+					while((it_ != end_) && std::isdigit(static_cast<unsigned char>(*it_))) ++it_;
+				}
+
+				token_ = {TokenType::number, {begin, it_}};
+			}
+			else if(*it_ == '\'')
+			{
+				std::string text;
+
+				for(++it_;; ++it_)
+				{
+					if(it_ == end_) throw ParsingException(std::string{begin, it_}, "the string is not closed");
+
+					if(*it_ == '\'')
+					{
+						if((it_ + 1 == end_) || (it_[1] != '\'')) break;
+						++it_;
+					}
+
+					text.push_back(*it_);
+				}
+
+				++it_;
+				token_ = {TokenType::string, std::move(text)};
+			}
+			else
+			{
+				static const char* const symbols[] = {"<=", ">=", "<>", "!=", "(", ")", ",", ".", "*", ";", "=", "<", ">"};
+
+				for(const char* symbol : symbols)
+				{
+					size_type size = std::strlen(symbol);
+
+					if((static_cast<size_type>(end_ - it_) >= size) && std::equal(symbol, symbol + size, it_))
+					{
+						it_ += size;
+						token_ = {TokenType::symbol, {begin, it_}};
+						return;
+					}
+				}
+
+				throw ParsingException(std::string{*it_}, "unexpected character");
+			}
+		}
+
+		// A digit, or a sign or a point before a digit.
+		bool isNumberStart() const noexcept
+		{
+			const char* it = it_;
+
+			if((*it == '-') || (*it == '+')) ++it;
+			if((it != end_) && (*it == '.')) ++it;
+
+			return (it != end_) && std::isdigit(static_cast<unsigned char>(*it));
+		}
+
+		const char* it_;
+		const char* end_;
+		Token token_;
+	};
+
+	// The state of the parsing of a statement : its tokens, and what is known of it so far.
+	struct Context
+	{
+		explicit Context(const std::string& text)
+		: lexer{text},
+		  statement{}
+		{}
+
+		Lexer lexer;
+		SqlStatement statement;
+		// The schemas of the tables of the statement.
+		std::vector<const DbSchema*> schemas;
+	};
+
+	// A column or an aggregate, as written in the select list, resolved once the tables are known.
+	struct SelectItem
+	{
+		bool isAggregate;
+		AggregateFunction function;
+		std::string tableName;
+		std::string fieldName;
+	};
 
-protected:
-	virtual DbEntry<endian, PageType::ReadOnly> next() noexcept
+	void parseSelect(Context& context) const
 	{
-		if(iterator_ != endIterator)
+		Lexer& lexer = context.lexer;
+		SqlStatement& statement = context.statement;
+		std::vector<SelectItem> items;
+		bool isStar = lexer.acceptSymbol("*");
+
+		statement.kind = StatementKind::select;
+
+		if(!isStar)
+		{
+			do items.push_back(parseSelectItem(lexer));
+			while(lexer.acceptSymbol(","));
+		}
+
+		lexer.expectKeyword("FROM");
+		parseTable(context);
+
+		while(lexer.acceptKeyword("JOIN") || (lexer.acceptKeyword("INNER") && (lexer.expectKeyword("JOIN"), true)))
+		{
+			parseTable(context);
+			parseJoinCondition(context);
+		}
+
+		if(lexer.acceptKeyword("WHERE")) statement.conditions = parseConditions(context);
+
+		if(lexer.acceptKeyword("GROUP"))
+		{
+			lexer.expectKeyword("BY");
+
+			do statement.groupColumnNames.push_back(parseColumn(context));
+			while(lexer.acceptSymbol(","));
+		}
+
+		if(lexer.acceptKeyword("ORDER"))
+		{
+			lexer.expectKeyword("BY");
+
+			do
+			{
+				SelectItem item = parseSelectItem(lexer);
+				bool isDescending = lexer.acceptKeyword("DESC");
+				if(!isDescending) lexer.acceptKeyword("ASC");
+
+				statement.sortKeys.push_back({resolve(context, item), isDescending});
+			}
+			while(lexer.acceptSymbol(","));
+		}
+
+		if(lexer.acceptKeyword("LIMIT"))
 		{
-			
+			const Token& token = lexer.peek();
+
+			if((token.type != TokenType::number) || !std::all_of(token.text.begin(), token.text.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }))
+			{
+				lexer.fail("expected a count of rows");
+			}
+
+			statement.limit = std::stoull(lexer.take().text);
 		}
+
+		if(isStar)
+		{
+			for(size_type table = 0; table < context.schemas.size(); ++table)
+			{
+				const DbSchema& schema = *context.schemas[table];
+				for(size_type i = 0; i < schema.getFieldCount(); ++i) statement.columnNames.push_back(getColumnName(context, table, schema[i].name));
+			}
+		}
+
+		for(const auto& item : items) statement.columnNames.push_back(resolve(context, item));
+
+		checkGroups(context);
 	}
 
-	DbIterator<endian> iterator_;
-	DbIterator<endian> endIterator_;
-};
+	// A column, or an aggregate on a column, count(*) counting the rows.
+	SelectItem parseSelectItem(Lexer& lexer) const
+	{
+		static const std::pair<const char*, AggregateFunction> functions[] = {
+			{"COUNT", AggregateFunction::count}, {"SUM", AggregateFunction::sum}, {"MIN", AggregateFunction::minimum},
+			{"MAX", AggregateFunction::maximum}, {"AVG", AggregateFunction::average}};
 
-template<Endianness endian>
-class Query
-{
-public:
-	Query(DbSystem<endian>& system, 
-		  const std::string& command, 
-		  std::vector<std::pair<const DbSchema&>, std::string>&& columns,
-		  DbSchema&& schema, 
-		  std::function<bool(const DbEntry<endian, PageType::Writable>&)> pred)
-	: system_{system},
-	  command_{command},
-	  columns{std::move(columns)},
-	  schema_{std::move(schema)},
-	  pred_{pred}
-	{}
+		SelectItem item{false, AggregateFunction::count, {}, {}};
+		std::string name = lexer.expectIdentifier("a column");
+
+		if(lexer.acceptSymbol("("))
+		{
+			auto function = std::find_if(std::begin(functions), std::end(functions), [&name](const std::pair<const char*, AggregateFunction>& f) {
+				return Lexer::isKeyword(name, f.first);
+			});
+
+			if(function == std::end(functions)) throw ParsingException(name, "not an aggregate function");
+
+			item.isAggregate = true;
+			item.function = function->second;
 
-	DbIterator<endian> execute()
+			if(!((item.function == AggregateFunction::count) && lexer.acceptSymbol("*")))
+			{
+				name = lexer.expectIdentifier("a column");
+				parseQualifiedName(lexer, name, item);
+			}
+
+			lexer.expectSymbol(")");
+		}
+		else
+		{
+			parseQualifiedName(lexer, name, item);
+		}
+
+		return item;
+	}
+
+	// The name read, and the field after the dot if it was the name of a table.
+	void parseQualifiedName(Lexer& lexer, const std::string& name, SelectItem& item) const
 	{
+		if(lexer.acceptSymbol("."))
+		{
+			item.tableName = name;
+			item.fieldName = lexer.expectIdentifier("a field");
+		}
+		else
+		{
+			item.fieldName = name;
+		}
 	}
 
-	void executeUpdate()
+	// A schema, and its alias if any.
+	void parseTable(Context& context) const
 	{
+		Lexer& lexer = context.lexer;
+		std::string schemaName = lexer.expectIdentifier("a schema");
+		const DbSchema* schema = findSchema_(schemaName);
+
+		if(!schema) throw ParsingException(schemaName, "there is no such schema");
+
+		std::string alias = schemaName;
+		if(lexer.acceptKeyword("AS")) alias = lexer.expectIdentifier("an alias");
+		else if((lexer.peek().type == TokenType::identifier) && !lexer.isReserved()) alias = lexer.take().text;
+
+		for(const auto& table : context.statement.tables)
+		{
+			if(table.alias == alias) throw ParsingException(alias, "the name of a table is given twice, an alias tells them apart");
+		}
+
+		context.statement.tables.push_back({schemaName, alias});
+		context.schemas.push_back(schema);
 	}
 
-private:
-	DbSystem<endian>& system_;
-	const std::string command_;
-	const std::vector<std::pair<const DbSchema&>, std::string> columns_;
-	const DbSchema schema_;
-	std::function<bool(const DbEntry<endian, PageType::Writable>&)> pred_;
-};
+	// The ON of the join of the last table, its column on either side.
+	void parseJoinCondition(Context& context) const
+	{
+		Lexer& lexer = context.lexer;
+		size_type joinedTable = context.schemas.size() - 1;
 
-template<Endianness endian>
-class QueryParser
-{
-public:
-	QueryParser(DbSystem<endian>& system)
-	: system_{system}
-	{}
+		lexer.expectKeyword("ON");
 
-private:
-	DbSystem<endian>& system_;
+		size_type leftTable = 0;
+		std::string leftColumnName = parseColumn(context, &leftTable);
+		lexer.expectSymbol("=");
+		size_type rightTable = 0;
+		std::string rightColumnName = parseColumn(context, &rightTable);
+
+		if(leftTable == joinedTable)
+		{
+			std::swap(leftTable, rightTable);
+			std::swap(leftColumnName, rightColumnName);
+		}
+
+		if((rightTable != joinedTable) || (leftTable == joinedTable))
+		{
+			throw ParsingException(leftColumnName + " = " + rightColumnName, "a join compares a column of the joined table to a column of the tables before");
+		}
+
+		context.statement.joins.push_back({leftColumnName, rightColumnName});
+	}
+
+	// The conditions all to be met : the terms of a conjunction, or a single disjunction.
+	std::vector<Predicate> parseConditions(Context& context) const
+	{
+		std::vector<Predicate> conditions = parseConjunction(context);
+
+		if(!context.lexer.isKeyword("OR")) return conditions;
+
+		Predicate disjunction = combine(std::move(conditions));
+		while(context.lexer.acceptKeyword("OR")) disjunction = disjunction || combine(parseConjunction(context));
+
+		return {disjunction};
+	}
+
+	std::vector<Predicate> parseConjunction(Context& context) const
+	{
+		std::vector<Predicate> conditions;
+
+		do
+		{
+			std::vector<Predicate> terms = parseComparison(context);
+			std::move(terms.begin(), terms.end(), std::back_inserter(conditions));
+		}
+		while(context.lexer.acceptKeyword("AND"));
+
+		return conditions;
+	}
+
+	// A comparison, a BETWEEN, as its two comparisons, or conditions in parentheses.
+	std::vector<Predicate> parseComparison(Context& context) const
+	{
+		Lexer& lexer = context.lexer;
+
+		if(lexer.acceptSymbol("("))
+		{
+			std::vector<Predicate> conditions = parseConditions(context);
+			lexer.expectSymbol(")");
+
+			return conditions;
+		}
+
+		// The constant may come first, the comparison is then turned around.
+		if(isConstant(lexer))
+		{
+			std::string constant = parseConstant(lexer);
+			CompareOperator op = parseOperator(lexer);
+
+			return {Predicate::compare(parseColumn(context), flip(op), std::move(constant))};
+		}
+
+		std::string columnName = parseColumn(context);
+
+		if(lexer.acceptKeyword("BETWEEN"))
+		{
+			std::string low = parseConstant(lexer);
+			lexer.expectKeyword("AND");
+			std::string high = parseConstant(lexer);
+
+			return {Predicate::compare(columnName, CompareOperator::greaterOrEqual, std::move(low)),
+					Predicate::compare(columnName, CompareOperator::lessOrEqual, std::move(high))};
+		}
+
+		CompareOperator op = parseOperator(lexer);
+
+		if(lexer.peek().type == TokenType::identifier && !lexer.isReserved())
+		{
+			lexer.fail("expected a constant, the columns are only compared to each other by the ON of a join");
+		}
+
+		return {Predicate::compare(std::move(columnName), op, parseConstant(lexer))};
+	}
+
+	static bool isConstant(const Lexer& lexer) noexcept
+	{
+		TokenType type = lexer.peek().type;
+
+		return (type == TokenType::number) || (type == TokenType::string) || lexer.isKeyword("TRUE") || lexer.isKeyword("FALSE");
+	}
+
+	// A constant as text, as written in a CSV file.
+	static std::string parseConstant(Lexer& lexer)
+	{
+		if(lexer.acceptKeyword("TRUE")) return "true";
+		if(lexer.acceptKeyword("FALSE")) return "false";
+		if(!isConstant(lexer)) lexer.fail("expected a constant");
+
+		return lexer.take().text;
+	}
+
+	static CompareOperator parseOperator(Lexer& lexer)
+	{
+		static const std::pair<const char*, CompareOperator> operators[] = {
+			{"=", CompareOperator::equal}, {"<>", CompareOperator::notEqual}, {"!=", CompareOperator::notEqual}, {"<", CompareOperator::less},
+			{"<=", CompareOperator::lessOrEqual}, {">", CompareOperator::greater}, {">=", CompareOperator::greaterOrEqual}};
+
+		for(const auto& op : operators)
+		{
+			if(lexer.acceptSymbol(op.first)) return op.second;
+		}
+
+		lexer.fail("expected a comparison");
+	}
+
+	// The same comparison, its sides swapped.
+	static CompareOperator flip(CompareOperator op) noexcept
+	{
+		switch(op)
+		{
+			case CompareOperator::less: return CompareOperator::greater;
+			case CompareOperator::lessOrEqual: return CompareOperator::greaterOrEqual;
+			case CompareOperator::greater: return CompareOperator::less;
+			case CompareOperator::greaterOrEqual: return CompareOperator::lessOrEqual;
+			default: return op;
+		}
+	}
+
+	static Predicate combine(std::vector<Predicate> conditions)
+	{
+		Predicate conjunction = std::move(conditions[0]);
+		for(size_type i = 1; i < conditions.size(); ++i) conjunction = std::move(conjunction) && std::move(conditions[i]);
+
+		return conjunction;
+	}
+
+	// A column of one of the tables, by its name in the result, the index of its table written to table.
+	std::string parseColumn(Context& context, size_type* table = nullptr) const
+	{
+		SelectItem item{false, AggregateFunction::count, {}, {}};
+		parseQualifiedName(context.lexer, context.lexer.expectIdentifier("a column"), item);
+
+		return resolve(context, item, table);
+	}
+
+	// An aggregate is added to the aggregates of the statement, once.
+	std::string resolve(Context& context, const SelectItem& item, size_type* table = nullptr) const
+	{
+		if(item.isAggregate)
+		{
+			Aggregate aggregate{item.function, item.fieldName.empty() ? std::string{} : resolveColumn(context, item)};
+			std::vector<Aggregate>& aggregates = context.statement.aggregates;
+
+			if(std::find_if(aggregates.begin(), aggregates.end(), [&aggregate](const Aggregate& other) {
+				return (other.function == aggregate.function) && (other.fieldName == aggregate.fieldName);
+			}) == aggregates.end())
+			{
+				aggregates.push_back(aggregate);
+			}
+
+			return BatchAggregate::getColumnName(aggregate);
+		}
+
+		return resolveColumn(context, item, table);
+	}
+
+	std::string resolveColumn(const Context& context, const SelectItem& item, size_type* table = nullptr) const
+	{
+		const std::vector<TableRef>& tables = context.statement.tables;
+		std::string name = item.tableName.empty() ? item.fieldName : item.tableName + "." + item.fieldName;
+		size_type found = tables.size();
+
+		for(size_type i = 0; i < tables.size(); ++i)
+		{
+			bool isNamed = item.tableName.empty() || (item.tableName == tables[i].alias);
+
+			if(isNamed && context.schemas[i]->findFieldRef(item.fieldName))
+			{
+				if(found != tables.size()) throw ParsingException(name, "ambiguous column, its table must be given");
+				found = i;
+			}
+		}
+
+		if(found == tables.size()) throw ParsingException(name, "there is no such column");
+
+		if(table) *table = found;
+
+		return getColumnName(context, found, item.fieldName);
+	}
+
+	static std::string getColumnName(const Context& context, size_type table, const std::string& fieldName)
+	{
+		return (context.statement.tables.size() > 1) ? context.statement.tables[table].alias + "." + fieldName : fieldName;
+	}
+
+	// With groups or aggregates, the columns of the result and the sort keys are groups or aggregates.
+	static void checkGroups(const Context& context)
+	{
+		const SqlStatement& statement = context.statement;
+
+		if(statement.aggregates.empty() && statement.groupColumnNames.empty()) return;
+
+		auto isGrouped = [&statement](const std::string& columnName) {
+			return (std::find(statement.groupColumnNames.begin(), statement.groupColumnNames.end(), columnName) != statement.groupColumnNames.end())
+				|| std::any_of(statement.aggregates.begin(), statement.aggregates.end(), [&columnName](const Aggregate& aggregate) {
+					   return BatchAggregate::getColumnName(aggregate) == columnName;
+				   });
+		};
+
+		for(const auto& columnName : statement.columnNames)
+		{
+			if(!isGrouped(columnName)) throw ParsingException(columnName, "the column is neither grouped nor aggregated");
+		}
+
+		for(const auto& sortKey : statement.sortKeys)
+		{
+			if(!isGrouped(sortKey.columnName)) throw ParsingException(sortKey.columnName, "the column is neither grouped nor aggregated");
+		}
+	}
+
+	void parseInsert(Context& context) const
+	{
+		Lexer& lexer = context.lexer;
+		SqlStatement& statement = context.statement;
+
+		statement.kind = StatementKind::insert;
+		lexer.expectKeyword("INTO");
+		parseSingleTable(context);
+
+		if(lexer.acceptSymbol("("))
+		{
+			do statement.fieldNames.push_back(parseField(context));
+			while(lexer.acceptSymbol(","));
+
+			lexer.expectSymbol(")");
+		}
+		else
+		{
+			const DbSchema& schema = *context.schemas[0];
+			for(size_type i = 0; i < schema.getFieldCount(); ++i) statement.fieldNames.push_back(schema[i].name);
+		}
+
+		lexer.expectKeyword("VALUES");
+
+		do
+		{
+			std::vector<std::string> values;
+			lexer.expectSymbol("(");
+
+			do values.push_back(parseConstant(lexer));
+			while(lexer.acceptSymbol(","));
+
+			if(values.size() != statement.fieldNames.size())
+			{
+				lexer.fail("expected " + std::to_string(statement.fieldNames.size()) + " values, one by field");
+			}
+
+			lexer.expectSymbol(")");
+			statement.rows.push_back(std::move(values));
+		}
+		while(lexer.acceptSymbol(","));
+	}
+
+	void parseUpdate(Context& context) const
+	{
+		Lexer& lexer = context.lexer;
+		SqlStatement& statement = context.statement;
+
+		statement.kind = StatementKind::update;
+		parseSingleTable(context);
+		lexer.expectKeyword("SET");
+		statement.rows.emplace_back();
+
+		do
+		{
+			statement.fieldNames.push_back(parseField(context));
+			lexer.expectSymbol("=");
+			statement.rows[0].push_back(parseConstant(lexer));
+		}
+		while(lexer.acceptSymbol(","));
+
+		if(lexer.acceptKeyword("WHERE")) statement.conditions = parseConditions(context);
+	}
+
+	void parseDelete(Context& context) const
+	{
+		context.statement.kind = StatementKind::remove;
+		context.lexer.expectKeyword("FROM");
+		parseSingleTable(context);
+
+		if(context.lexer.acceptKeyword("WHERE")) context.statement.conditions = parseConditions(context);
+	}
+
+	// The schema written to, without an alias.
+	void parseSingleTable(Context& context) const
+	{
+		std::string schemaName = context.lexer.expectIdentifier("a schema");
+		const DbSchema* schema = findSchema_(schemaName);
+
+		if(!schema) throw ParsingException(schemaName, "there is no such schema");
+
+		context.statement.tables.push_back({schemaName, schemaName});
+		context.schemas.push_back(schema);
+	}
+
+	// A field written by the statement, once.
+	std::string parseField(Context& context) const
+	{
+		std::string fieldName = parseColumn(context);
+		const std::vector<std::string>& fieldNames = context.statement.fieldNames;
+
+		if(std::find(fieldNames.begin(), fieldNames.end(), fieldName) != fieldNames.end())
+		{
+			throw ParsingException(fieldName, "the field is written twice");
+		}
+
+		return fieldName;
+	}
+
+	std::function<const DbSchema*(const std::string&)> findSchema_;
 };
 
 #endif // QUERY_PARSER_HXX
@@ -0,0 +1,479 @@
+#ifndef QUERY_PLAN_HXX
+#define QUERY_PLAN_HXX
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <DbEntry.hxx>
+#include <DbSystem.hxx>
+#include <ColumnBatch.hxx>
+#include <BatchScan.hxx>
+#include <BatchOperators.hxx>
+#include <CsvRowEncoder.hxx>
+#include <Predicate.hxx>
+#include <Schema.hxx>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class StatementKind : flag_type
+{
+	select,
+	insert,
+	update,
+	remove
+};
+
+struct TableRef
+{
+	std::string schemaName;
+	std::string alias;
+};
+
+// The equality of a column of the tables joined before, and of a column of the table joined.
+struct JoinCondition
+{
+	std::string leftColumnName;
+	std::string rightColumnName;
+};
+
+/* A statement, its names checked against the schemas (see QueryParser). A column is named by its field, or, in a join,
+ * by the alias of its table, a dot, then its field, an aggregate as its output column (see BatchAggregate::getColumnName).
+ */
+struct SqlStatement
+{
+	StatementKind kind;
+	// The table of the statement, then the joined ones, joins[i] joining tables[i + 1].
+	std::vector<TableRef> tables;
+	std::vector<JoinCondition> joins;
+	// The columns of the result, in order.
+	std::vector<std::string> columnNames;
+	std::vector<Aggregate> aggregates;
+	std::vector<std::string> groupColumnNames;
+	// The conditions all the rows must meet, the terms of the conjunction of the WHERE clause.
+	std::vector<Predicate> conditions;
+	std::vector<SortKey> sortKeys;
+	optional<size_type> limit;
+	// The fields written, and their values as text : a row by inserted row, a single row for an update.
+	std::vector<std::string> fieldNames;
+	std::vector<std::vector<std::string>> rows;
+};
+
+struct ScanPlan
+{
+	TableRef table;
+	// The fields decoded, their columns named after the prefix.
+	std::vector<std::string> fieldNames;
+	std::string columnPrefix;
+	// The conditions on the table alone, on its fields, evaluated on the pages.
+	optional<Predicate> predicate;
+};
+
+struct QueryPlan
+{
+	StatementKind kind;
+	std::vector<ScanPlan> scans;
+	std::vector<JoinCondition> joins;
+	// The conditions on several tables, evaluated on the joined rows.
+	optional<Predicate> filter;
+	std::vector<std::string> groupColumnNames;
+	std::vector<Aggregate> aggregates;
+	std::vector<SortKey> sortKeys;
+	optional<size_type> limit;
+	std::vector<std::string> columnNames;
+	std::vector<std::string> fieldNames;
+	std::vector<std::vector<std::string>> rows;
+};
+
+/* Chooses where each condition is evaluated : a condition on a single table is pushed down to its scan, so that only
+ * the matching rows are ever decoded, the others are left to a filter after the joins. Each scan decodes only the
+ * fields read after it.
+ * There is no index to choose from yet : every table is scanned.
+ */
+class QueryPlanner
+{
+public:
+	static QueryPlan plan(const SqlStatement& statement)
+	{
+		QueryPlan plan;
+		plan.kind = statement.kind;
+		plan.joins = statement.joins;
+		plan.groupColumnNames = statement.groupColumnNames;
+		plan.aggregates = statement.aggregates;
+		plan.sortKeys = statement.sortKeys;
+		plan.limit = statement.limit;
+		plan.columnNames = statement.columnNames;
+		plan.fieldNames = statement.fieldNames;
+		plan.rows = statement.rows;
+
+		bool isJoin = statement.tables.size() > 1;
+
+		for(const auto& table : statement.tables)
+		{
+			plan.scans.push_back({table, {}, isJoin ? table.alias + "." : std::string{}, {}});
+		}
+
+		for(const auto& condition : statement.conditions)
+		{
+			std::vector<size_type> tables;
+
+			for(const auto& columnName : condition.getFieldNames())
+			{
+				size_type table = findTable(plan, columnName);
+				if(std::find(tables.begin(), tables.end(), table) == tables.end()) tables.push_back(table);
+			}
+
+			if(tables.size() <= 1)
+			{
+				ScanPlan& scan = plan.scans[tables.empty() ? 0 : tables[0]];
+				size_type prefixSize = scan.columnPrefix.size();
+				Predicate pushed = condition.renameFields([prefixSize](const std::string& columnName) { return columnName.substr(prefixSize); });
+
+				scan.predicate = scan.predicate ? (*scan.predicate && pushed) : pushed;
+			}
+			else
+			{
+				plan.filter = plan.filter ? (*plan.filter && condition) : condition;
+			}
+		}
+
+		if(statement.kind == StatementKind::select) addScannedFields(plan);
+
+		return plan;
+	}
+
+private:
+	// The index of the scan of the table of a column, the first for a column without any alias.
+	static size_type findTable(const QueryPlan& plan, const std::string& columnName)
+	{
+		for(size_type i = 0; i < plan.scans.size(); ++i)
+		{
+			const std::string& prefix = plan.scans[i].columnPrefix;
+
+			if(!prefix.empty() && (columnName.compare(0, prefix.size(), prefix) == 0)) return i;
+		}
+
+		return 0;
+	}
+
+	static void addScannedFields(QueryPlan& plan)
+	{
+		auto add = [&plan](const std::string& columnName) {
+			for(const auto& aggregate : plan.aggregates)
+			{
+				if(BatchAggregate::getColumnName(aggregate) == columnName) return;
+			}
+
+			ScanPlan& scan = plan.scans[findTable(plan, columnName)];
+			std::string fieldName = columnName.substr(scan.columnPrefix.size());
+
+			if(std::find(scan.fieldNames.begin(), scan.fieldNames.end(), fieldName) == scan.fieldNames.end())
+			{
+				scan.fieldNames.push_back(fieldName);
+			}
+		};
+
+		for(const auto& columnName : plan.columnNames) add(columnName);
+		for(const auto& columnName : plan.groupColumnNames) add(columnName);
+		for(const auto& sortKey : plan.sortKeys) add(sortKey.columnName);
+
+		for(const auto& aggregate : plan.aggregates)
+		{
+			if(!aggregate.fieldName.empty()) add(aggregate.fieldName);
+		}
+
+		for(const auto& join : plan.joins)
+		{
+			add(join.leftColumnName);
+			add(join.rightColumnName);
+		}
+
+		if(plan.filter)
+		{
+			for(const auto& columnName : plan.filter->getFieldNames()) add(columnName);
+		}
+	}
+};
+
+// Walks the batches of the result of a query, skipping the batches left without any row by a filter.
+class QueryIterator
+{
+public:
+	QueryIterator(std::unique_ptr<BatchOperator> root)
+	: root_{std::move(root)}
+	{}
+
+	bool next()
+	{
+		while(root_->next(batch_))
+		{
+			if(batch_.getSelectedCount() > 0) return true;
+		}
+
+		return false;
+	}
+
+	const ColumnBatch& getBatch() const noexcept
+	{
+		return batch_;
+	}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept
+	{
+		return root_->getColumns();
+	}
+
+private:
+	std::unique_ptr<BatchOperator> root_;
+	ColumnBatch batch_;
+};
+
+/* Runs the plans on the database : a select is lowered to batch operators, the scans, the joins, the filter, the
+ * aggregates, the sort or the limit, then the projection. The rows written by the other statements are changed in
+ * place (see DbSystem::updateWhen and removeWhen).
+ */
+template<Endianness endian>
+class QueryExecutor
+{
+public:
+	QueryExecutor(DbSystem<endian>& system)
+	: system_{system}
+	{}
+
+	std::unique_ptr<BatchOperator> build(const QueryPlan& plan)
+	{
+		std::unique_ptr<BatchOperator> root = buildScan(plan.scans[0]);
+
+		for(size_type i = 0; i < plan.joins.size(); ++i)
+		{
+			// The smaller of the first two tables is hashed, as the catalog counts their rows, then every joined table.
+			bool isLeftHashed = (i == 0) && (getRowCount(plan.scans[0]) < getRowCount(plan.scans[1]));
+
+			root.reset(new BatchJoin{std::move(root), buildScan(plan.scans[i + 1]), plan.joins[i].leftColumnName,
+									 plan.joins[i].rightColumnName, isLeftHashed});
+		}
+
+		if(plan.filter) root.reset(new BatchFilter<endian>{std::move(root), *plan.filter});
+
+		if(!plan.aggregates.empty() || !plan.groupColumnNames.empty())
+		{
+			root.reset(new BatchAggregate{std::move(root), plan.groupColumnNames, plan.aggregates});
+		}
+
+		if(!plan.sortKeys.empty()) root.reset(new BatchSort{std::move(root), plan.sortKeys, plan.limit});
+		else if(plan.limit) root.reset(new BatchLimit{std::move(root), *plan.limit});
+
+		if(!hasColumns(*root, plan.columnNames)) root.reset(new BatchProject{std::move(root), plan.columnNames});
+
+		return root;
+	}
+
+	QueryIterator select(const QueryPlan& plan)
+	{
+		if(plan.kind != StatementKind::select) throw QueryException("only a select has a result");
+
+		return QueryIterator{build(plan)};
+	}
+
+	// Inserts, updates or removes the rows of the plan, and returns their count.
+	size_type execute(const QueryPlan& plan)
+	{
+		const std::string& schemaName = plan.scans[0].table.schemaName;
+		Predicate predicate = plan.scans[0].predicate ? *plan.scans[0].predicate : Predicate::always();
+
+		switch(plan.kind)
+		{
+			case StatementKind::insert:
+				return insert(plan);
+			case StatementKind::update:
+				return system_.updateWhen(schemaName, getFields(plan), encode(plan, plan.rows[0]), predicate);
+			case StatementKind::remove:
+				return system_.removeWhen(schemaName, predicate);
+			default:
+				throw QueryException("a select does not change any row");
+		}
+	}
+
+private:
+	std::unique_ptr<BatchOperator> buildScan(const ScanPlan& scan)
+	{
+		BatchScan<endian>* batchScan = new BatchScan<endian>{system_, scan.table.schemaName, scan.fieldNames, scan.columnPrefix};
+		std::unique_ptr<BatchOperator> root{batchScan};
+
+		if(scan.predicate) batchScan->pushDown(*scan.predicate);
+
+		return root;
+	}
+
+	size_type getRowCount(const ScanPlan& scan) const
+	{
+		auto entry = system_.getCatalogEntry(scan.table.schemaName);
+
+		return entry ? entry->rowCount : 0;
+	}
+
+	static bool hasColumns(const BatchOperator& op, const std::vector<std::string>& columnNames)
+	{
+		const std::vector<ColumnDescriptor>& columns = op.getColumns();
+
+		return std::equal(columnNames.begin(), columnNames.end(), columns.begin(), columns.end(),
+						  [](const std::string& name, const ColumnDescriptor& column) { return name == column.name; });
+	}
+
+	const DbSchema& getSchema(const QueryPlan& plan) const
+	{
+		auto schemaIndex = system_.getSchemaIndex(plan.scans[0].table.schemaName);
+		if(!schemaIndex) throw QueryException("there is no schema " + plan.scans[0].table.schemaName);
+
+		return *system_.getSchema(*schemaIndex);
+	}
+
+	std::vector<FieldRef> getFields(const QueryPlan& plan) const
+	{
+		const DbSchema& schema = getSchema(plan);
+		std::vector<FieldRef> fields;
+
+		for(const auto& fieldName : plan.fieldNames)
+		{
+			optional<FieldRef> field = schema.findFieldRef(fieldName);
+			if(!field) throw QueryException("there is no field " + fieldName + " in " + schema.getName());
+
+			fields.push_back(*field);
+		}
+
+		return fields;
+	}
+
+	// The values written in a row of the schema, the fields not written left to zero.
+	std::vector<uint8_t> encode(const QueryPlan& plan, const std::vector<std::string>& values) const
+	{
+		const DbSchema& schema = getSchema(plan);
+		std::vector<FieldRef> fields = getFields(plan);
+		std::vector<uint8_t> row(schema.getDataSize());
+		CsvRowEncoder<endian> encoder{schema};
+
+		for(size_type i = 0; i < fields.size(); ++i)
+		{
+			const std::string& value = values[i];
+
+			try
+			{
+				encoder.encodeField(fields[i], {value.data(), value.data() + value.size()}, row.data() + fields[i].offset);
+			}
+			catch(const CsvImportException& e)
+			{
+				throw QueryException("the value " + value + " does not fit the field " + plan.fieldNames[i] + ", " + e.getReason());
+			}
+		}
+
+		return row;
+	}
+
+	// All the rows are encoded first : none is inserted if a value does not fit its field.
+	size_type insert(const QueryPlan& plan)
+	{
+		const DbSchema& schema = getSchema(plan);
+		std::vector<DbEntry<endian>> entries;
+
+		for(const auto& values : plan.rows) entries.emplace_back(schema, encode(plan, values));
+		for(const auto& entry : entries) system_.add(entry);
+
+		return entries.size();
+	}
+
+	DbSystem<endian>& system_;
+};
+
+/* A query on a schema, built in code rather than parsed, then planned and executed as a parsed select : the condition
+ * is pushed down to the scan, then come the aggregates, or else the fields selected.
+ *
+ *	Query<endian> query{system, "Runner"};
+ *	query.where(Predicate::compare("BestTime", CompareOperator::less, 3600)).groupBy({"Name"}).aggregate(AggregateFunction::count);
+ *
+ * Without any field selected, the result has the groups then the aggregates, or, without them, all the fields of the
+ * schema.
+ */
+template<Endianness endian>
+class Query
+{
+public:
+	Query(DbSystem<endian>& system, std::string schemaName)
+	: system_{system},
+	  schemaName_{std::move(schemaName)}
+	{}
+
+	Query& select(std::vector<std::string> fieldNames)
+	{
+		selectedFieldNames_ = std::move(fieldNames);
+		return *this;
+	}
+
+	Query& where(Predicate predicate)
+	{
+		predicate_ = std::move(predicate);
+		return *this;
+	}
+
+	Query& groupBy(std::vector<std::string> fieldNames)
+	{
+		groupFieldNames_ = std::move(fieldNames);
+		return *this;
+	}
+
+	// Without a field, counts the rows.
+	Query& aggregate(AggregateFunction function, std::string fieldName = {})
+	{
+		aggregates_.push_back({function, std::move(fieldName)});
+		return *this;
+	}
+
+	std::unique_ptr<BatchOperator> plan() const
+	{
+		return QueryExecutor<endian>{system_}.build(QueryPlanner::plan(getStatement()));
+	}
+
+	QueryIterator execute() const
+	{
+		return QueryIterator{plan()};
+	}
+
+private:
+	SqlStatement getStatement() const
+	{
+		SqlStatement statement;
+		statement.kind = StatementKind::select;
+		statement.tables.push_back({schemaName_, schemaName_});
+		statement.aggregates = aggregates_;
+		statement.groupColumnNames = groupFieldNames_;
+		statement.columnNames = selectedFieldNames_;
+
+		if(predicate_) statement.conditions.push_back(*predicate_);
+
+		if(selectedFieldNames_.empty() && (!aggregates_.empty() || !groupFieldNames_.empty()))
+		{
+			statement.columnNames = groupFieldNames_;
+			for(const auto& aggregate : aggregates_) statement.columnNames.push_back(BatchAggregate::getColumnName(aggregate));
+		}
+		else if(selectedFieldNames_.empty())
+		{
+			auto schemaIndex = system_.getSchemaIndex(schemaName_);
+			if(!schemaIndex) throw QueryException("there is no schema " + schemaName_);
+
+			const DbSchema& schema = *system_.getSchema(*schemaIndex);
+			for(size_type i = 0; i < schema.getFieldCount(); ++i) statement.columnNames.push_back(schema[i].name);
+		}
+
+		return statement;
+	}
+
+	DbSystem<endian>& system_;
+	const std::string schemaName_;
+	std::vector<std::string> selectedFieldNames_;
+	std::vector<std::string> groupFieldNames_;
+	std::vector<Aggregate> aggregates_;
+	optional<Predicate> predicate_;
+};
+
+#endif // QUERY_PLAN_HXX
@@ -217,7 +217,7 @@ public:
 		uint8_t offset = 0;
 		for(auto byte : EndiannessRangeIteratorSelector<endian>::select(rg))
 		{
-			out |= (byte << (offset * 8));
+			out |= (static_cast<size_type>(byte) << (offset * 8));
 			++offset;
 		}
 
@@ -247,15 +247,16 @@ public:
 
 		Ensures(rg.size() <= sizeof(std::streamoff));
 
-		std::streamoff out = 0;
+		// Shifted unsigned, a byte may land in the sign bit.
+		uint64_t out = 0;
 		size_type offset = 0;
 		for(auto byte : EndiannessRangeIteratorSelector<endian>::select(rg))
 		{
-			out = out | ((std::streamoff)byte << (offset * 8));
+			out = out | (static_cast<uint64_t>(byte) << (offset * 8));
 			++offset;
 		}
 
-		return out;
+		return static_cast<std::streamoff>(out);
 	}
 
 	template<class Iterator>
@@ -281,7 +282,7 @@ public:
 			Adaptater(Iterator begin, Iterator end) : bytes{ makeArray<sizeof(double)>(begin, end) }
 			{}
 
-			float value;
+			double value;
 			std::array<uint8_t, sizeof(double)> bytes;
 		} res{ begin, end };
 
@@ -333,7 +334,6 @@ class RawDataStringizer
 					// RawDataAdaptator<double, sizeof(double), endian> adapt{begin, begin + type.getSize()};
 					// sstr << adapt.value;
 					sstr << RawDataConverter<endian>::rawDataToDouble(begin, begin + type.getSize());
-					std::cout << sstr.str();
 				}
 				else
 				{
@@ -376,7 +376,6 @@ class RawDataStringizer
 				result += byte;
 			}
 
-			std::cout << "Result : " << result << std::endl;
 			return result;
 		}
 	}
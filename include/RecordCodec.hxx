@@ -0,0 +1,79 @@
+#ifndef RECORD_CODEC_HXX
+#define RECORD_CODEC_HXX
+
+#include <Configuration.hxx>
+#include <Optional.hxx>
+#include <RawDataUtils.hxx>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/* Builds, and reads back, the records of 64 bits values and null terminated strings the metadata files are made of
+ * (see Catalog and FreeSpaceMap). A record ends with the checksum of everything before it, to detect the torn writes.
+ */
+template<Endianness endian>
+struct RecordCodec
+{
+	static constexpr size_type valueSize = sizeof(uint64_t);
+
+	static void appendValue(std::vector<uint8_t>& record, uint64_t value)
+	{
+		Utils::RawDataAdaptator<uint64_t, valueSize, endian> valueData{value};
+		record.insert(record.end(), valueData.bytes.begin(), valueData.bytes.end());
+	}
+
+	static void appendString(std::vector<uint8_t>& record, const std::string& str)
+	{
+		record.insert(record.end(), str.begin(), str.end());
+		record.push_back('\0');
+	}
+
+	static void appendChecksum(std::vector<uint8_t>& record)
+	{
+		appendValue(record, checksum(record, record.size()));
+	}
+
+	// The magic numbers and the checksums use all 64 bits.
+	static uint64_t readValue(const std::vector<uint8_t>& record, size_type position) noexcept
+	{
+		return Utils::RawDataConverter<endian>::rawDataToStreamoff(record.begin() + position, record.begin() + position + valueSize);
+	}
+
+	// Reads the string at position and moves past it, nullopt if it is not terminated.
+	static optional<std::string> readString(const std::vector<uint8_t>& record, size_type& position)
+	{
+		auto stringEnd = std::find(record.begin() + position, record.end(), '\0');
+
+		if(stringEnd == record.end()) return {};
+
+		std::string str{record.begin() + position, stringEnd};
+		position += str.size() + 1;
+
+		return str;
+	}
+
+	// Whether the checksum at position matches the bytes before it.
+	static bool checkChecksum(const std::vector<uint8_t>& record, size_type position) noexcept
+	{
+		return (position + valueSize <= record.size()) && (readValue(record, position) == checksum(record, position));
+	}
+
+	// FNV-1a, we only need to detect the torn writes.
+	static uint64_t checksum(const std::vector<uint8_t>& record, size_type size) noexcept
+	{
+		uint64_t hash = 0xCBF29CE484222325ull;
+
+		for(size_type i = 0; i < size; ++i)
+		{
+			hash = (hash ^ record[i]) * 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+};
+
+template<Endianness endian>
+constexpr size_type RecordCodec<endian>::valueSize;
+
+#endif // RECORD_CODEC_HXX
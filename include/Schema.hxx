@@ -20,6 +20,16 @@ struct FieldDescriptor
 	DataTypeDescriptor type;	
 };
 
+/* A field of a schema, resolved once : reading it from a row is then a load at a fixed offset, without any lookup.
+ * Only valid for the schema it was resolved from. */
+struct FieldRef
+{
+	size_type index;
+	size_type offset;
+	size_type size;
+	DataType type;
+};
+
 class DbSchema 
 {
 	public:
@@ -28,14 +38,18 @@ class DbSchema
 	  internal_{internal},
 	  size_{computeSize()},
 	  dataSize_{computeDataSize()}
-	{}
+	{
+		computeFieldTable();
+	}
 	
 	DbSchema(std::string name, std::vector<FieldDescriptor>&& internal) 
 	: name_{name}, 
 	  internal_{std::move(internal)},
 	  size_{computeSize()},
 	  dataSize_{computeDataSize()}
-	{}
+	{
+		computeFieldTable();
+	}
 
 	DbSchema(const DbSchema&) = default;
 	DbSchema(DbSchema&&) = default;
@@ -53,10 +67,7 @@ class DbSchema
 		size_type space = name_.length() + 1;
 		for(auto& elem : internal_)
 		{
-
-	std::cout << "LLLL ? " << space << std::endl;	
 			space += elem.name.length() + 1 + DataTypeDescriptor::getPackedSize();
-		std::cout << "LLLL ... " << DataTypeDescriptor::getPackedSize() << " : " << elem.name.size() << std::endl;
 		}
 		
 		return space;
@@ -74,6 +85,23 @@ class DbSchema
 		return size;
 	}
 
+	// The offset, size and type of every field, and the index of every field name, so that no access has to go through the fields.
+	void computeFieldTable()
+	{
+		size_type offset = 0;
+
+		fields_.reserve(internal_.size());
+
+		for(size_type i = 0; i < internal_.size(); ++i)
+		{
+			size_type size = internal_[i].type.getSize();
+
+			fields_.push_back(FieldRef{i, offset, size, internal_[i].type.getType()});
+			fieldIndices_.insert({internal_[i].name, i});
+			offset += size;
+		}
+	}
+
 	public:
 	size_type getSize() const noexcept
 	{
@@ -90,43 +118,49 @@ class DbSchema
 		return internal_.size();
 	}
 	
-	FieldDescriptor at(size_type index) const noexcept
+	// No copy of the descriptor, the rows read their fields through it.
+	const FieldDescriptor& at(size_type index) const noexcept
 	{
 		return internal_[index];
 	}
 	
-	FieldDescriptor operator[](size_type index) const noexcept
+	const FieldDescriptor& operator[](size_type index) const noexcept
 	{
 		return at(index);
 	}
 	
 	optional<size_type> findIndexOf(const std::string& fieldName) const
 	{
-		auto it = std::find_if(internal_.begin(), internal_.end(), [&fieldName](const auto& elem) {
-			return elem.name == fieldName;
-		});
+		auto it = fieldIndices_.find(fieldName);
 
-		if(it == internal_.end()) return {};
+		if(it == fieldIndices_.end()) return {};
 
-		return std::distance(internal_.begin(), it);
-		
+		return it->second;
 	}
 
 	size_type getFieldOffset(size_type index) const noexcept
 	{
-		size_type offset = 0;
+		return fields_[index].offset;
+	}
 
-		for(size_type i = 0; i < index; ++i)
-		{
-			offset += internal_[i].type.getSize();
-		}
+	size_type getFieldOffset(const std::string& fieldName) const noexcept
+	{
+		return getFieldOffset(*findIndexOf(fieldName));
+	}
 
-		return offset;
+	const FieldRef& getFieldRef(size_type index) const noexcept
+	{
+		return fields_[index];
 	}
 
-	size_type getFieldOffset(const std::string& fieldName) const noexcept
+	// To be resolved once, out of the loops over the rows.
+	optional<FieldRef> findFieldRef(const std::string& fieldName) const
 	{
-		return getFieldOffset(findIndexOf(fieldName));
+		auto index = findIndexOf(fieldName);
+
+		if(!index) return {};
+
+		return fields_[*index];
 	}
 
 	private:
@@ -134,6 +168,8 @@ class DbSchema
 	std::vector<FieldDescriptor> internal_;
 	size_type size_;
 	size_type dataSize_;
+	std::vector<FieldRef> fields_;
+	std::unordered_map<std::string, size_type> fieldIndices_;
 
 	static constexpr size_type nameLengthFieldSize = 2;
 };
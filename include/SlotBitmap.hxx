@@ -0,0 +1,121 @@
+#ifndef SLOT_BITMAP_HXX
+#define SLOT_BITMAP_HXX
+
+#include <Configuration.hxx>
+
+#include <cstdint>
+#include <cstring>
+
+/* The slot directory of a page : one bit by slot, set when the slot is used, in whole 64 bits words.
+ * The slot i is the bit i % 8 of the byte i / 8, which makes the words little endian, whatever the endianness of the
+ * file : a slot is changed with a single byte, and the searches go through the slots a word at a time, skipping the
+ * full (or empty) words at once, and finding the first slot of a word with a count of the trailing zeros.
+ * The bits past the last slot of the last word are never set. Works in place, on the raw page.
+ */
+class SlotBitmap
+{
+	static constexpr size_type wordBits = 64;
+
+public:
+	// Size in bytes of the bitmap of slotCount slots.
+	static constexpr size_type getSize(size_type slotCount) noexcept
+	{
+		return ((slotCount + wordBits - 1) / wordBits) * sizeof(uint64_t);
+	}
+
+	static bool test(const uint8_t* bitmap, size_type slot) noexcept
+	{
+		return (bitmap[slot / 8] >> (slot % 8)) & 1;
+	}
+
+	static void set(uint8_t* bitmap, size_type slot) noexcept
+	{
+		bitmap[slot / 8] |= static_cast<uint8_t>(1 << (slot % 8));
+	}
+
+	static void reset(uint8_t* bitmap, size_type slot) noexcept
+	{
+		bitmap[slot / 8] &= static_cast<uint8_t>(~(1 << (slot % 8)));
+	}
+
+	// The first used slot from the slot from on, slotCount if there is none.
+	static size_type findNextUsed(const uint8_t* bitmap, size_type from, size_type slotCount) noexcept
+	{
+		if(from >= slotCount) return slotCount;
+
+		size_type wordIndex = from / wordBits;
+
+		// Drop the slots of the first word before from.
+		uint64_t word = loadWord(bitmap, wordIndex) & (~uint64_t{0} << (from % wordBits));
+
+		for(size_type wordCount = getSize(slotCount) / sizeof(uint64_t); word == 0;)
+		{
+			if(++wordIndex == wordCount) return slotCount;
+
+			word = loadWord(bitmap, wordIndex);
+		}
+
+		return (wordIndex * wordBits) + countTrailingZeros(word);
+	}
+
+	// The first free slot, slotCount if there is none.
+	static size_type findFirstFree(const uint8_t* bitmap, size_type slotCount) noexcept
+	{
+		size_type wordCount = getSize(slotCount) / sizeof(uint64_t);
+
+		for(size_type wordIndex = 0; wordIndex < wordCount; ++wordIndex)
+		{
+			uint64_t word = ~loadWord(bitmap, wordIndex);
+
+			if(word != 0)
+			{
+				size_type slot = (wordIndex * wordBits) + countTrailingZeros(word);
+
+				// The free bits past the last slot.
+				return (slot < slotCount) ? slot : slotCount;
+			}
+		}
+
+		return slotCount;
+	}
+
+	// The slots wordIndex * 64 to wordIndex * 64 + 63, the slot wordIndex * 64 being the lowest bit.
+	static uint64_t loadWord(const uint8_t* bitmap, size_type wordIndex) noexcept
+	{
+		uint64_t word;
+		std::memcpy(&word, bitmap + (wordIndex * sizeof(uint64_t)), sizeof(uint64_t));
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		word = __builtin_bswap64(word);
+#endif
+
+		return word;
+	}
+
+	static void storeWord(uint8_t* bitmap, size_type wordIndex, uint64_t word) noexcept
+	{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+		word = __builtin_bswap64(word);
+#endif
+
+		std::memcpy(bitmap + (wordIndex * sizeof(uint64_t)), &word, sizeof(uint64_t));
+	}
+
+private:
+
+	// The word must not be 0.
+	static size_type countTrailingZeros(uint64_t word) noexcept
+	{
+#if (COMPILER == GCC_COMPILER) || (COMPILER == CLANG_COMPILER)
+		return static_cast<size_type>(__builtin_ctzll(word));
+#else
+		size_type count = 0;
+
+		for(; (word & 1) == 0; word >>= 1) ++count;
+
+		return count;
+#endif
+	}
+};
+
+#endif // SLOT_BITMAP_HXX
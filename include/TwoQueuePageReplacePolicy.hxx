@@ -0,0 +1,237 @@
+#ifndef TWO_QUEUE_PAGE_REPLACE_POLICY_HXX
+#define TWO_QUEUE_PAGE_REPLACE_POLICY_HXX
+
+#include <Configuration.hxx>
+#include <FrameList.hxx>
+#include <GhostList.hxx>
+#include <Optional.hxx>
+#include <PageReplacePolicy.hxx>
+
+#include <algorithm>
+#include <vector>
+
+/* Scan resistant 2Q replace policy (Johnson & Shasha, "2Q: A Low Overhead High Performance Buffer Management
+ * Replacement Algorithm").
+ * A page loaded for the first time goes in the probationary queue, a FIFO : the page keeps its place whatever its
+ * accesses, so a page touched again during a scan still leaves the queue with the scan. While the probationary queue
+ * holds more than its share of the buffer, the candidates are taken from it, so a full scan only ever recycles
+ * probationary frames.
+ * The offsets of the pages evicted from the probationary queue are remembered in a ghost list : a page loaded again
+ * while its ghost is still there proved it is not a one time access, and goes in the protected queue, managed in
+ * LRU order.
+ * As for the LRU policy, pinned protected frames are unlinked from their queue. The pinned probationary frames keep
+ * their place, and are only taken out of the queue when met at its front, to go back at its end once released.
+ * Every operation is O(1), amortized for the candidates.
+ */
+template<Endianness endian>
+class TwoQueuePageReplacePolicy : public PageReplacePolicy<endian>
+{
+	public:
+	using PageIndex = typename PageReplacePolicy<endian>::PageIndex;
+
+	private:
+	using Queue = FrameList<PageIndex>;
+
+	enum class QueueId : uint8_t
+	{
+		none,
+		probation,
+		protectedPages
+	};
+
+	// Default shares of the buffer, from the original paper.
+	static constexpr size_type probationShareDivisor = 4;
+	static constexpr size_type ghostShareDivisor = 2;
+
+	public:
+	TwoQueuePageReplacePolicy()
+	: TwoQueuePageReplacePolicy(0)
+	{}
+
+	TwoQueuePageReplacePolicy(size_type totalPageCount)
+	: TwoQueuePageReplacePolicy(totalPageCount,
+								std::max<size_type>(1, totalPageCount / probationShareDivisor),
+								std::max<size_type>(1, totalPageCount / ghostShareDivisor))
+	{}
+
+	TwoQueuePageReplacePolicy(size_type totalPageCount, size_type probationTarget, size_type ghostCapacity)
+	: nodes_(totalPageCount),
+	  queueIds_(totalPageCount, QueueId::none),
+	  pinned_(totalPageCount, false),
+	  probation_{},
+	  protected_{},
+	  ghosts_{ghostCapacity},
+	  probationCount_{0},
+	  protectedCount_{0},
+	  probationTarget_{probationTarget}
+	{}
+
+	virtual void use(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		pinned_[pageId] = true;
+
+		if(queueIds_[pageId] != QueueId::probation) unlink(pageId);
+	}
+
+	virtual void release(const DiskPage<endian>& page) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		pinned_[pageId] = false;
+
+		// A frame we were not told about is treated as a new page.
+		if(queueIds_[pageId] == QueueId::none)
+		{
+			assign(pageId, QueueId::probation);
+		}
+
+		if(queueIds_[pageId] == QueueId::probation)
+		{
+			if(!nodes_[pageId].linked) probation_.pushBack(nodes_, pageId);
+			return;
+		}
+
+		unlink(pageId);
+		protected_.pushBack(nodes_, pageId);
+	}
+
+	virtual optional<PageIndex> getCandidate() override
+	{
+		bool preferProbation = (probationCount_ > probationTarget_) || protected_.empty();
+
+		if(preferProbation)
+		{
+			auto candidate = popProbation();
+			if(candidate) return candidate;
+		}
+
+		if(!protected_.empty()) return protected_.popFront(nodes_);
+
+		return popProbation();
+	}
+
+	// The buffer loads the pages in frames it holds pinned.
+	virtual void pageLoaded(const DiskPage<endian>& page, std::streamoff offset) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+		pinned_[pageId] = true;
+
+		if(ghosts_.erase(offset))
+		{
+			assign(pageId, QueueId::protectedPages);
+			return;
+		}
+
+		assign(pageId, QueueId::probation);
+		probation_.pushBack(nodes_, pageId);
+	}
+
+	virtual void pageEvicted(const DiskPage<endian>& page, std::streamoff offset) override
+	{
+		auto pageId = page.getIndex();
+
+		reserve(pageId);
+		unlink(pageId);
+
+		if(queueIds_[pageId] == QueueId::probation)
+		{
+			ghosts_.insert(offset);
+		}
+
+		assign(pageId, QueueId::none);
+	}
+
+	size_type getProbationCount() const noexcept
+	{
+		return probationCount_;
+	}
+
+	size_type getProtectedCount() const noexcept
+	{
+		return protectedCount_;
+	}
+
+	size_type getGhostCount() const noexcept
+	{
+		return ghosts_.size();
+	}
+
+	private:
+
+	void reserve(PageIndex pageId)
+	{
+		if(pageId >= nodes_.size())
+		{
+			nodes_.resize(pageId + 1);
+			queueIds_.resize(pageId + 1, QueueId::none);
+			pinned_.resize(pageId + 1, false);
+		}
+	}
+
+	// The pinned frames met at the front of the probationary queue leave it, until they are released.
+	optional<PageIndex> popProbation() noexcept
+	{
+		while(!probation_.empty())
+		{
+			PageIndex pageId = probation_.popFront(nodes_);
+
+			if(!pinned_[pageId]) return pageId;
+		}
+
+		return {};
+	}
+
+	Queue& getQueue(QueueId id) noexcept
+	{
+		return (id == QueueId::protectedPages) ? protected_ : probation_;
+	}
+
+	void unlink(PageIndex pageId) noexcept
+	{
+		if(nodes_[pageId].linked)
+		{
+			getQueue(queueIds_[pageId]).remove(nodes_, pageId);
+		}
+	}
+
+	// Moves a (non linked) frame from one queue to another, keeping the resident counts up to date.
+	void assign(PageIndex pageId, QueueId newId) noexcept
+	{
+		QueueId& id = queueIds_[pageId];
+
+		if(id == QueueId::probation) --probationCount_;
+		else if(id == QueueId::protectedPages) --protectedCount_;
+
+		if(newId == QueueId::probation) ++probationCount_;
+		else if(newId == QueueId::protectedPages) ++protectedCount_;
+
+		id = newId;
+	}
+
+	typename Queue::NodeArray nodes_;
+	std::vector<QueueId> queueIds_;
+	std::vector<bool> pinned_;
+	Queue probation_;
+	Queue protected_;
+	GhostList ghosts_;
+
+	// Resident frames of each queue, pinned ones included.
+	size_type probationCount_;
+	size_type protectedCount_;
+	size_type probationTarget_;
+};
+
+template<Endianness endian>
+constexpr size_type TwoQueuePageReplacePolicy<endian>::probationShareDivisor;
+
+template<Endianness endian>
+constexpr size_type TwoQueuePageReplacePolicy<endian>::ghostShareDivisor;
+
+#endif // TWO_QUEUE_PAGE_REPLACE_POLICY_HXX
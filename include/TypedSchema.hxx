@@ -0,0 +1,225 @@
+#ifndef TYPED_SCHEMA_HXX
+#define TYPED_SCHEMA_HXX
+
+#include <Configuration.hxx>
+#include <ConstString.hxx>
+#include <DataTypes.hxx>
+#include <DbEntry.hxx>
+#include <MacroUtils.hxx>
+#include <Schema.hxx>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/* Schemas declared as C++ types : the fields are types too, and their offsets, sizes and decoders are known at compile
+ * time. A typed read of a row is then a load at a constant offset, without any lookup in the schema.
+ *
+ *     TYPED_FIELD(Name, CHARACTER, 24);
+ *     TYPED_FIELD(BestTime, INTEGER, 32);
+ *     TYPED_SCHEMA(Runner, Name, BestTime);
+ *
+ *     TypedEntryView<endian, Runner> runner{*it};
+ *     auto time = runner.get<BestTime>();
+ *
+ * A typed schema is the same schema as its DbSchema (see toDbSchema), written to the schema file by the same
+ * serializer : typed and untyped code read the same files. A schema read from a file should be checked once against the
+ * typed schema (see matches) before its rows are read through it, the rows themselves are not checked.
+ * C++14 has no string template parameter, which is why the fields are named by types, not by strings.
+ */
+
+namespace Details
+{
+
+// The C++ type a field is decoded to.
+template<DataType::UnderlyingEnumType dataType, size_type size, class = void>
+struct FieldValueType
+{
+	using type = std::string;
+};
+
+template<size_type size>
+struct FieldValueType<DataType::INTEGER, size>
+{
+	using type = std::conditional_t<(size <= sizeof(uint32_t)), uint32_t, size_type>;
+};
+
+template<size_type size>
+struct FieldValueType<DataType::DATE, size>
+{
+	using type = uint32_t;
+};
+
+template<size_type size>
+struct FieldValueType<DataType::BOOLEAN, size>
+{
+	using type = bool;
+};
+
+template<DataType::UnderlyingEnumType dataType, size_type size>
+struct FieldValueType<dataType, size, std::enable_if_t<(dataType == DataType::FLOAT) || (dataType == DataType::TIME)>>
+{
+	using type = std::conditional_t<(size <= sizeof(float)), float, double>;
+};
+
+}
+
+template<DataType::UnderlyingEnumType fieldType, size_type fieldModifier>
+struct TypedField
+{
+	using value_type = typename Details::FieldValueType<fieldType, DataTypeDescriptor::getSize(fieldType, fieldModifier)>::type;
+
+	static constexpr DataType getType() noexcept
+	{
+		return fieldType;
+	}
+
+	static constexpr size_type getModifier() noexcept
+	{
+		return fieldModifier;
+	}
+
+	static constexpr size_type getSize() noexcept
+	{
+		return DataTypeDescriptor::getSize(fieldType, fieldModifier);
+	}
+};
+
+#define TYPED_FIELD(FieldName, fieldType, fieldModifier)                                                                 \
+struct FieldName : TypedField<DataType::fieldType, fieldModifier>                                                      \
+{                                                                                                                       \
+	static constexpr ConstString getName() noexcept { return STRINGIFY(FieldName); }                                    \
+}
+
+template<class Schema, class... Fields>
+class TypedSchema
+{
+	static_assert(sizeof...(Fields) > 0, "A schema needs at least one field");
+
+public:
+	static constexpr size_type getFieldCount() noexcept
+	{
+		return sizeof...(Fields);
+	}
+
+	static constexpr size_type getDataSize() noexcept
+	{
+		const size_type sizes[] = {Fields::getSize()...};
+		size_type dataSize = 0;
+
+		for(size_type size : sizes) dataSize += size;
+
+		return dataSize;
+	}
+
+	template<class Field>
+	static constexpr bool contains() noexcept
+	{
+		const bool found[] = {std::is_same<Field, Fields>::value...};
+
+		for(bool isField : found)
+		{
+			if(isField) return true;
+		}
+
+		return false;
+	}
+
+	template<class Field>
+	static constexpr size_type getFieldIndex() noexcept
+	{
+		static_assert(contains<Field>(), "The field is not a field of the schema");
+
+		const bool found[] = {std::is_same<Field, Fields>::value...};
+		size_type index = 0;
+
+		while(!found[index]) ++index;
+
+		return index;
+	}
+
+	template<class Field>
+	static constexpr size_type getFieldOffset() noexcept
+	{
+		const size_type sizes[] = {Fields::getSize()...};
+		size_type offset = 0;
+
+		for(size_type i = 0; i < getFieldIndex<Field>(); ++i) offset += sizes[i];
+
+		return offset;
+	}
+
+	template<class Field>
+	static constexpr FieldRef getFieldRef() noexcept
+	{
+		return {getFieldIndex<Field>(), getFieldOffset<Field>(), Field::getSize(), Field::getType()};
+	}
+
+	static DbSchema toDbSchema()
+	{
+		return {toString(Schema::getName()), {FieldDescriptor{toString(Fields::getName()), {Fields::getType(), Fields::getModifier()}}...}};
+	}
+
+	// Same name, and same fields in the same order, with the same types.
+	static bool matches(const DbSchema& schema)
+	{
+		static const DbSchema typedSchema = toDbSchema();
+
+		if((schema.getName() != typedSchema.getName()) || (schema.getFieldCount() != typedSchema.getFieldCount())) return false;
+
+		for(size_type i = 0; i < schema.getFieldCount(); ++i)
+		{
+			const auto& field = schema[i];
+			const auto& typedField = typedSchema[i];
+
+			if((field.name != typedField.name) || (field.type.getType() != typedField.type.getType())
+			|| (field.type.getModifier() != typedField.type.getModifier()))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+	static std::string toString(ConstString str)
+	{
+		return {str.data(), str.size()};
+	}
+};
+
+#define TYPED_SCHEMA(SchemaName, ...)                                                                                   \
+struct SchemaName : TypedSchema<SchemaName, __VA_ARGS__>                                                               \
+{                                                                                                                       \
+	static constexpr ConstString getName() noexcept { return STRINGIFY(SchemaName); }                                   \
+}
+
+/* A row read through its typed schema. Like the DbEntryView it is made from, it only lives as long as the bytes of the
+ * row, and the row must be of the schema (see TypedSchema::matches), which is not checked by row. */
+template<Endianness endian, class Schema>
+class TypedEntryView
+{
+public:
+	explicit TypedEntryView(const DbEntryView<endian>& view) noexcept
+	: view_{view}
+	{}
+
+	template<class Field>
+	typename Field::value_type get() const
+	{
+		constexpr FieldRef field = Schema::template getFieldRef<Field>();
+
+		return view_.template getAs<typename Field::value_type>(field);
+	}
+
+	const DbEntryView<endian>& getView() const noexcept
+	{
+		return view_;
+	}
+
+private:
+	DbEntryView<endian> view_;
+};
+
+#endif // TYPED_SCHEMA_HXX
@@ -0,0 +1,523 @@
+#include <AsyncFileIo.hxx>
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+	enum class RequestKind : flag_type
+	{
+		read,
+		write,
+		writeVector
+	};
+}
+
+struct AsyncFileIo::Request
+{
+	RequestKind kind;
+	// The buffer, or the iovec array for writeVector.
+	const void* data;
+	// The bytes, or the number of iovec for writeVector.
+	size_type size;
+	std::streamoff offset;
+	uint64_t tag;
+};
+
+class AsyncFileIo::Engine
+{
+public:
+	virtual ~Engine() = default;
+
+	virtual void prepare(const Request& request) = 0;
+	virtual size_type submit() = 0;
+	// Collects the completions there, waiting for minCount of them first if minCount is not 0.
+	virtual size_type reap(std::vector<AsyncIoCompletion>& completions, size_type minCount) = 0;
+	// Waits for the requests submitted, dropping their completions, and can not fail : what is left once submit or reap
+	// failed. The requests only prepared are never run.
+	virtual void drain() noexcept = 0;
+};
+
+namespace
+{
+	using Request = AsyncFileIo::Request;
+
+	// Runs the request right away, with the positional calls, as a worker of the pool does.
+	int64_t runRequest(int descriptor, const Request& request) noexcept
+	{
+		while(true)
+		{
+			ssize_t result;
+
+			switch(request.kind)
+			{
+				case RequestKind::read:
+					result = ::pread(descriptor, const_cast<void*>(request.data), request.size, request.offset);
+					break;
+				case RequestKind::write:
+					result = ::pwrite(descriptor, request.data, request.size, request.offset);
+					break;
+				default:
+					result = ::pwritev(descriptor, static_cast<const iovec*>(request.data), static_cast<int>(request.size), request.offset);
+					break;
+			}
+
+			if((result >= 0) || (errno != EINTR)) return (result >= 0) ? result : -errno;
+		}
+	}
+
+	class ThreadPoolEngine : public AsyncFileIo::Engine
+	{
+	public:
+		ThreadPoolEngine(int descriptor, size_type threadCount)
+		: descriptor_{descriptor},
+		  prepared_{},
+		  queued_{},
+		  completed_{},
+		  submittedCount_{0},
+		  stop_{false},
+		  workers_{}
+		{
+			for(size_type i = 0; i < threadCount; ++i)
+			{
+				workers_.emplace_back(&ThreadPoolEngine::runWorker, this);
+			}
+		}
+
+		~ThreadPoolEngine() override
+		{
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				stop_ = true;
+			}
+
+			workCondition_.notify_all();
+
+			for(auto& worker : workers_) worker.join();
+		}
+
+		void prepare(const Request& request) override
+		{
+			prepared_.push_back(request);
+		}
+
+		size_type submit() override
+		{
+			size_type count = prepared_.size();
+
+			if(count == 0) return 0;
+
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				queued_.insert(queued_.end(), prepared_.begin(), prepared_.end());
+			}
+
+			prepared_.clear();
+			submittedCount_ += count;
+			workCondition_.notify_all();
+
+			return count;
+		}
+
+		size_type reap(std::vector<AsyncIoCompletion>& completions, size_type minCount) override
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+
+			minCount = std::min(minCount, submittedCount_);
+			doneCondition_.wait(lock, [this, minCount]() { return completed_.size() >= minCount; });
+
+			size_type count = completed_.size();
+
+			completions.insert(completions.end(), completed_.begin(), completed_.end());
+			completed_.clear();
+			submittedCount_ -= count;
+
+			return count;
+		}
+
+		void drain() noexcept override
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+
+			doneCondition_.wait(lock, [this]() { return completed_.size() >= submittedCount_; });
+
+			submittedCount_ -= completed_.size();
+			completed_.clear();
+		}
+
+	private:
+		void runWorker()
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+
+			while(true)
+			{
+				workCondition_.wait(lock, [this]() { return stop_ || !queued_.empty(); });
+
+				if(stop_) break;
+
+				Request request = queued_.front();
+				queued_.pop_front();
+
+				lock.unlock();
+				int64_t result = runRequest(descriptor_, request);
+				lock.lock();
+
+				completed_.push_back({request.tag, result});
+				doneCondition_.notify_one();
+			}
+		}
+
+		int descriptor_;
+
+		// Only used by the thread driving the engine.
+		std::vector<Request> prepared_;
+
+		// Protected by the mutex.
+		std::deque<Request> queued_;
+		std::vector<AsyncIoCompletion> completed_;
+		size_type submittedCount_;
+		bool stop_;
+
+		std::mutex mutex_;
+		std::condition_variable workCondition_;
+		std::condition_variable doneCondition_;
+		std::vector<std::thread> workers_;
+	};
+
+#ifdef HAS_IO_URING
+	/* The rings are shared with the kernel : we own the tail of the submission ring and the head of the completion
+	 * ring, the kernel owns the other ends. */
+	class IoUringEngine : public AsyncFileIo::Engine
+	{
+	public:
+		// Null if io_uring, or one of the operations we need, is not available.
+		static std::unique_ptr<IoUringEngine> create(int descriptor, size_type queueDepth)
+		{
+			std::unique_ptr<IoUringEngine> engine{new IoUringEngine{descriptor}};
+
+			if(!engine->setup(queueDepth) || !engine->supportsOperations()) return {};
+
+			return engine;
+		}
+
+		~IoUringEngine() override
+		{
+			if(sqes_ != MAP_FAILED) ::munmap(sqes_, sqesSize_);
+			if((cqRing_ != MAP_FAILED) && (cqRing_ != sqRing_)) ::munmap(cqRing_, cqRingSize_);
+			if(sqRing_ != MAP_FAILED) ::munmap(sqRing_, sqRingSize_);
+			if(ringDescriptor_ >= 0) ::close(ringDescriptor_);
+		}
+
+		void prepare(const Request& request) override
+		{
+			unsigned tail = *sqTail_;
+			unsigned index = tail & *sqMask_;
+			io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[index];
+
+			std::memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = (request.kind == RequestKind::read) ? IORING_OP_READ
+					   : ((request.kind == RequestKind::write) ? IORING_OP_WRITE : IORING_OP_WRITEV);
+			sqe.fd = descriptor_;
+			sqe.off = request.offset;
+			sqe.addr = reinterpret_cast<uint64_t>(request.data);
+			sqe.len = static_cast<uint32_t>(request.size);
+			sqe.user_data = request.tag;
+
+			sqArray_[index] = index;
+			__atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+			++preparedCount_;
+		}
+
+		size_type submit() override
+		{
+			size_type count = preparedCount_;
+
+			while(preparedCount_ > 0)
+			{
+				int result = enter(preparedCount_, 0, 0);
+
+				if(result < 0)
+				{
+					if((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) continue;
+
+					throw std::runtime_error(std::string{"Failed to submit the requests to io_uring ("} + std::strerror(errno) + ") !");
+				}
+
+				preparedCount_ -= result;
+				submittedCount_ += result;
+			}
+
+			return count;
+		}
+
+		size_type reap(std::vector<AsyncIoCompletion>& completions, size_type minCount) override
+		{
+			minCount = std::min(minCount, submittedCount_);
+			size_type count = harvest(completions);
+
+			while(count < minCount)
+			{
+				if((enter(0, minCount - count, IORING_ENTER_GETEVENTS) < 0) && (errno != EINTR))
+				{
+					throw std::runtime_error(std::string{"Failed to wait for io_uring ("} + std::strerror(errno) + ") !");
+				}
+
+				count += harvest(completions);
+			}
+
+			return count;
+		}
+
+		// The kernel posts the completions to the ring without io_uring_enter, they are polled.
+		void drain() noexcept override
+		{
+			while(true)
+			{
+				unsigned head = *cqHead_;
+				unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+
+				__atomic_store_n(cqHead_, tail, __ATOMIC_RELEASE);
+				submittedCount_ -= tail - head;
+
+				if(submittedCount_ == 0) return;
+
+				::usleep(100);
+			}
+		}
+
+	private:
+		IoUringEngine(int descriptor)
+		: descriptor_{descriptor},
+		  ringDescriptor_{-1},
+		  sqRing_{MAP_FAILED},
+		  cqRing_{MAP_FAILED},
+		  sqes_{MAP_FAILED},
+		  sqRingSize_{0},
+		  cqRingSize_{0},
+		  sqesSize_{0},
+		  preparedCount_{0},
+		  submittedCount_{0}
+		{}
+
+		bool setup(size_type queueDepth)
+		{
+			io_uring_params params;
+			std::memset(&params, 0, sizeof(params));
+
+			ringDescriptor_ = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(queueDepth), &params));
+
+			if(ringDescriptor_ < 0) return false;
+
+			sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+
+			bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+
+			if(singleMap) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+			sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor_, IORING_OFF_SQ_RING);
+			if(sqRing_ == MAP_FAILED) return false;
+
+			cqRing_ = singleMap ? sqRing_ : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor_, IORING_OFF_CQ_RING);
+			if(cqRing_ == MAP_FAILED) return false;
+
+			sqes_ = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor_, IORING_OFF_SQES);
+			if(sqes_ == MAP_FAILED) return false;
+
+			uint8_t* sqRing = static_cast<uint8_t*>(sqRing_);
+			uint8_t* cqRing = static_cast<uint8_t*>(cqRing_);
+
+			sqTail_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+			sqMask_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+			sqArray_ = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+			cqHead_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+			cqTail_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+			cqMask_ = reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+			cqes_ = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+
+			return true;
+		}
+
+		// IORING_OP_READ and IORING_OP_WRITE came with Linux 5.6, along with the probe itself.
+		bool supportsOperations()
+		{
+			static constexpr unsigned opCount = 256;
+			std::vector<uint8_t> storage(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+			io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+
+			if(::syscall(__NR_io_uring_register, ringDescriptor_, IORING_REGISTER_PROBE, probe, opCount) < 0) return false;
+
+			for(unsigned op : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_WRITEV})
+			{
+				if((op > probe->last_op) || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+			}
+
+			return true;
+		}
+
+		int enter(size_type toSubmit, size_type minComplete, unsigned flags)
+		{
+			return static_cast<int>(::syscall(__NR_io_uring_enter, ringDescriptor_, static_cast<unsigned>(toSubmit),
+											  static_cast<unsigned>(minComplete), flags, nullptr, 0));
+		}
+
+		size_type harvest(std::vector<AsyncIoCompletion>& completions)
+		{
+			unsigned head = *cqHead_;
+			unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+			size_type count = 0;
+
+			for(; head != tail; ++head, ++count)
+			{
+				const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+				completions.push_back({cqe.user_data, cqe.res});
+			}
+
+			__atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+			submittedCount_ -= count;
+
+			return count;
+		}
+
+		int descriptor_;
+		int ringDescriptor_;
+
+		void* sqRing_;
+		void* cqRing_;
+		void* sqes_;
+		size_type sqRingSize_;
+		size_type cqRingSize_;
+		size_type sqesSize_;
+
+		unsigned* sqTail_;
+		unsigned* sqMask_;
+		unsigned* sqArray_;
+		unsigned* cqHead_;
+		unsigned* cqTail_;
+		unsigned* cqMask_;
+		io_uring_cqe* cqes_;
+
+		size_type preparedCount_;
+		size_type submittedCount_;
+	};
+#endif
+
+	// Enough threads to keep a disk busy, without one thread by request for the deep queues.
+	constexpr size_type maxPoolThreadCount = 16;
+}
+
+AsyncFileIo::AsyncFileIo(int descriptor, size_type queueDepth, AsyncIoEngine engine)
+: queueDepth_{std::max<size_type>(queueDepth, 1)},
+  usesIoUring_{false},
+  engine_{},
+  pendingCount_{0}
+{
+#ifdef HAS_IO_URING
+	if(engine != AsyncIoEngine::threadPool)
+	{
+		engine_ = IoUringEngine::create(descriptor, queueDepth_);
+		usesIoUring_ = static_cast<bool>(engine_);
+	}
+#endif
+
+	if(!engine_)
+	{
+		if(engine == AsyncIoEngine::ioUring)
+		{
+			throw std::runtime_error("io_uring is not available on this system !");
+		}
+
+		engine_.reset(new ThreadPoolEngine{descriptor, std::min(queueDepth_, maxPoolThreadCount)});
+	}
+}
+
+AsyncFileIo::~AsyncFileIo()
+{
+	// The buffers of the requests in flight belong to the caller, wait for the requests before it frees them.
+	std::vector<AsyncIoCompletion> completions;
+
+	try
+	{
+		engine_->submit();
+		engine_->reap(completions, pendingCount_);
+	}
+	catch(...)
+	{
+		// Nothing can be thrown from here : the requests already submitted are still waited for.
+		engine_->drain();
+	}
+}
+
+bool AsyncFileIo::prepareRead(uint8_t* buffer, size_type size, std::streamoff offset, uint64_t tag)
+{
+	return prepare({RequestKind::read, buffer, size, offset, tag});
+}
+
+bool AsyncFileIo::prepareWrite(const uint8_t* buffer, size_type size, std::streamoff offset, uint64_t tag)
+{
+	return prepare({RequestKind::write, buffer, size, offset, tag});
+}
+
+bool AsyncFileIo::prepareWriteVector(const iovec* buffers, size_type count, std::streamoff offset, uint64_t tag)
+{
+	return prepare({RequestKind::writeVector, buffers, count, offset, tag});
+}
+
+bool AsyncFileIo::prepare(const Request& request)
+{
+	if(pendingCount_ == queueDepth_) return false;
+
+	engine_->prepare(request);
+	++pendingCount_;
+
+	return true;
+}
+
+size_type AsyncFileIo::submit()
+{
+	return engine_->submit();
+}
+
+size_type AsyncFileIo::poll(std::vector<AsyncIoCompletion>& completions)
+{
+	size_type count = engine_->reap(completions, 0);
+	pendingCount_ -= count;
+
+	return count;
+}
+
+size_type AsyncFileIo::wait(std::vector<AsyncIoCompletion>& completions, size_type minCount)
+{
+	engine_->submit();
+
+	size_type count = engine_->reap(completions, minCount);
+	pendingCount_ -= count;
+
+	return count;
+}
+
+size_type AsyncFileIo::getPendingCount() const noexcept
+{
+	return pendingCount_;
+}
+
+#endif
@@ -0,0 +1,99 @@
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <ImportCommand.hxx>
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <CsvImporter.hxx>
+
+namespace
+{
+	constexpr Endianness usedEndianness = Endianness::little;
+
+	int printUsage()
+	{
+		std::cerr << "Usage : import <database> <schema file> <schema name> <CSV file> [--header] [--delimiter c] [--threads n]"
+				  << std::endl;
+
+		return EXIT_FAILURE;
+	}
+}
+
+int runImportCommand(int argc, char** argv)
+{
+	if(argc < 5) return printUsage();
+
+	std::string dbFileName = argv[1];
+	std::string schemaFileName = argv[2];
+	std::string schemaName = argv[3];
+	std::string csvFileName = argv[4];
+	CsvImportOptions options;
+
+	for(int i = 5; i < argc; ++i)
+	{
+		std::string option = argv[i];
+
+		if(option == "--header")
+		{
+			options.hasHeader = true;
+		}
+		else if((option == "--delimiter") && (i + 1 < argc) && (std::string{argv[i + 1]}.size() == 1))
+		{
+			options.delimiter = argv[++i][0];
+		}
+		else if((option == "--threads") && (i + 1 < argc) && (std::atoi(argv[i + 1]) > 0))
+		{
+			options.threadCount = std::atoi(argv[++i]);
+		}
+		else
+		{
+			return printUsage();
+		}
+	}
+
+	try
+	{
+		// The database opens an existing file.
+		if(!std::ifstream{dbFileName}) std::ofstream{dbFileName, std::ios::binary};
+
+		DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+		if(!system.getSchemaIndex(schemaName))
+		{
+			std::cerr << "There is no schema " << schemaName << " in " << schemaFileName << std::endl;
+
+			return EXIT_FAILURE;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		CsvImporter<usedEndianness> importer{system, schemaName, options};
+		size_type rowCount = importer.import(csvFileName);
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cerr << "Imported " << rowCount << " rows in " << elapsed.count() << " s" << std::endl;
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,94 @@
+#include <MappedFile.hxx>
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+	int toMadvice(MappingAdvice advice) noexcept
+	{
+		switch(advice)
+		{
+			case MappingAdvice::sequential:
+				return MADV_SEQUENTIAL;
+			case MappingAdvice::random:
+				return MADV_RANDOM;
+			case MappingAdvice::willNeed:
+				return MADV_WILLNEED;
+			default:
+				return MADV_NORMAL;
+		}
+	}
+}
+
+MappedFile::MappedFile(const std::string& filename)
+: data_{nullptr},
+  size_{0},
+  filename_{filename}
+{
+	int descriptor = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if(descriptor < 0)
+	{
+		throw std::ios_base::failure(std::string("Error : failed to open the file ") + filename + ". Please check that the file exists, and is a valid file !");
+	}
+
+	struct stat status;
+
+	if(::fstat(descriptor, &status) != 0)
+	{
+		std::string error = std::strerror(errno);
+		::close(descriptor);
+
+		throw std::ios_base::failure("Error when processing the file '" + filename + "' (" + error + ") !");
+	}
+
+	size_ = static_cast<size_type>(status.st_size);
+
+	// An empty mapping is not allowed, an empty file simply has no data.
+	if(size_ > 0)
+	{
+		void* data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, descriptor, 0);
+
+		if(data == MAP_FAILED)
+		{
+			std::string error = std::strerror(errno);
+			::close(descriptor);
+
+			throw std::ios_base::failure("Error when mapping the file '" + filename + "' (" + error + ") !");
+		}
+
+		data_ = static_cast<uint8_t*>(data);
+	}
+
+	// The mapping keeps its own reference to the file.
+	::close(descriptor);
+}
+
+MappedFile::~MappedFile()
+{
+	if(data_) ::munmap(data_, size_);
+}
+
+void MappedFile::advise(std::streamoff offset, size_type size, MappingAdvice advice) const noexcept
+{
+	if(!data_ || (offset < 0) || (static_cast<size_type>(offset) >= size_)) return;
+
+	// madvise wants a range starting on a page of the system.
+	static const size_type systemPageSize = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+
+	size_type start = (static_cast<size_type>(offset) / systemPageSize) * systemPageSize;
+	size_type end = std::min(size_, static_cast<size_type>(offset) + size);
+
+	::madvise(data_ + start, end - start, toMadvice(advice));
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include <PositionalFile.hxx>
+
+#ifdef HAS_POSITIONAL_IO
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace
+{
+	// The fstreams never create the file unless truncating or appending, the flags follow the same rules.
+	int toOpenFlags(std::ios::ios_base::openmode flags) noexcept
+	{
+		bool in = flags & std::ios_base::in;
+		bool out = flags & (std::ios_base::out | std::ios_base::app);
+
+		int openFlags = (in && out) ? O_RDWR : (out ? O_WRONLY : O_RDONLY);
+
+		if(flags & std::ios_base::trunc) openFlags |= O_CREAT | O_TRUNC;
+		else if(flags & std::ios_base::app) openFlags |= O_CREAT;
+		else if(out && !in) openFlags |= O_CREAT | O_TRUNC;
+
+		return openFlags | O_CLOEXEC;
+	}
+
+	std::string systemError()
+	{
+		return std::strerror(errno);
+	}
+
+	std::string transferError(bool reading, const std::string& filename)
+	{
+		return std::string{reading ? "Failed to read data from the file '" : "Failed to write data to the file '"} + filename + "' (" + systemError() + ") !";
+	}
+
+	std::string endOfFileError(bool reading, const std::string& filename)
+	{
+		return reading ? std::string{"Error : attempting to read beyond the end of the file '"} + filename + "'."
+					   : std::string{"Unknown error when writing data to the file '"} + filename + "' !";
+	}
+
+	// Runs the positional transfer until the whole buffer is done. transfer has the signature of pread and pwrite.
+	template<class Byte, class Transfer>
+	void transferAll(Byte* buffer, size_type size, std::streampos position, Transfer transfer,
+					 bool reading, const std::string& filename)
+	{
+		off_t offset = static_cast<off_t>(static_cast<std::streamoff>(position));
+
+		while(size > 0)
+		{
+			ssize_t done = transfer(buffer, size, offset);
+
+			if(done < 0)
+			{
+				if(errno == EINTR) continue;
+
+				throw std::ios_base::failure(transferError(reading, filename));
+			}
+
+			if(done == 0) throw std::ios_base::failure(endOfFileError(reading, filename));
+
+			buffer += done;
+			size -= done;
+			offset += done;
+		}
+	}
+
+	/* Runs the positional transfer until every buffer is done, moving past the partial transfers.
+	 * transfer(buffers, count, position) has the signature of preadv and pwritev. */
+	template<class Transfer>
+	void transferAllVector(const iovec* buffers, size_type count, std::streampos position, Transfer transfer,
+					 bool reading, const std::string& filename)
+	{
+		std::vector<iovec> pending(buffers, buffers + count);
+		auto first = pending.begin();
+		off_t offset = static_cast<off_t>(static_cast<std::streamoff>(position));
+
+		while(first != pending.end())
+		{
+			int chunk = static_cast<int>(std::min<std::ptrdiff_t>(pending.end() - first, IOV_MAX));
+			ssize_t done = transfer(&*first, chunk, offset);
+
+			if(done < 0)
+			{
+				if(errno == EINTR) continue;
+
+				throw std::ios_base::failure(transferError(reading, filename));
+			}
+
+			if(done == 0) throw std::ios_base::failure(endOfFileError(reading, filename));
+
+			offset += done;
+
+			for(size_t left = static_cast<size_t>(done); left > 0;)
+			{
+				size_t step = std::min(left, first->iov_len);
+
+				first->iov_base = static_cast<uint8_t*>(first->iov_base) + step;
+				first->iov_len -= step;
+				left -= step;
+
+				if(first->iov_len == 0) ++first;
+			}
+
+			while((first != pending.end()) && (first->iov_len == 0)) ++first;
+		}
+	}
+}
+
+PositionalFile::PositionalFile(const std::string& filename, std::ios::ios_base::openmode flags)
+: descriptor_{::open(filename.c_str(), toOpenFlags(flags), 0644)},
+  filename_{filename}
+{
+	if(descriptor_ < 0)
+	{
+		throw std::ios_base::failure(std::string("Error : failed to open the file ") + filename + ". Please check that the file exists, and is a valid file !");
+	}
+}
+
+PositionalFile::~PositionalFile()
+{
+	::close(descriptor_);
+}
+
+void PositionalFile::read(unsigned char* buffer, size_type size, std::streampos position) const
+{
+	transferAll(buffer, size, position, [this](unsigned char* data, size_t dataSize, off_t offset) {
+		return ::pread(descriptor_, data, dataSize, offset);
+	}, true, filename_);
+}
+
+void PositionalFile::readVector(const iovec* buffers, size_type count, std::streampos position) const
+{
+	transferAllVector(buffers, count, position, [this](const iovec* chunk, int chunkCount, off_t offset) {
+		return ::preadv(descriptor_, chunk, chunkCount, offset);
+	}, true, filename_);
+}
+
+void PositionalFile::write(const unsigned char* buffer, size_type size, std::streampos position)
+{
+	transferAll(buffer, size, position, [this](const unsigned char* data, size_t dataSize, off_t offset) {
+		return ::pwrite(descriptor_, data, dataSize, offset);
+	}, false, filename_);
+}
+
+void PositionalFile::writeVector(const iovec* buffers, size_type count, std::streampos position)
+{
+	transferAllVector(buffers, count, position, [this](const iovec* chunk, int chunkCount, off_t offset) {
+		return ::pwritev(descriptor_, chunk, chunkCount, offset);
+	}, false, filename_);
+}
+
+void PositionalFile::sync()
+{
+#if OS == LINUX
+	while(::fdatasync(descriptor_) != 0)
+#else
+	while(::fsync(descriptor_) != 0)
+#endif
+	{
+		if(errno != EINTR) throw std::ios_base::failure(transferError(false, filename_));
+	}
+}
+
+void PositionalFile::setDirectIo(bool enable)
+{
+#ifdef O_DIRECT
+	int flags = ::fcntl(descriptor_, F_GETFL);
+	bool failed = (flags < 0) || (::fcntl(descriptor_, F_SETFL, enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT)) != 0);
+#else
+	bool failed = (::fcntl(descriptor_, F_NOCACHE, enable ? 1 : 0) != 0);
+#endif
+
+	if(failed)
+	{
+		throw std::ios_base::failure("Error : direct I/O is not available for the file '" + filename_ + "' (" + systemError() + ") !");
+	}
+}
+
+std::streampos PositionalFile::getFileSize() const
+{
+	struct stat status;
+
+	if(::fstat(descriptor_, &status) != 0)
+	{
+		throw std::ios_base::failure("Error when processing the file '" + filename_ + "' (" + systemError() + ") !");
+	}
+
+	return status.st_size;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <QueryCommand.hxx>
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <QueryPlan.hxx>
+#include <QueryParser.hxx>
+
+namespace
+{
+	constexpr Endianness usedEndianness = Endianness::little;
+
+	int printUsage()
+	{
+		std::cerr << "Usage : query <database> <schema file> <statement>" << std::endl;
+
+		return EXIT_FAILURE;
+	}
+
+	// The strings without their trailing null characters.
+	void printValue(const ColumnDescriptor& column, const ColumnVector& values, size_type row)
+	{
+		if(column.kind == ColumnKind::unsignedInteger)
+		{
+			std::cout << values.integers[row];
+		}
+		else if(column.kind == ColumnKind::floatingPoint)
+		{
+			std::cout << values.floats[row];
+		}
+		else
+		{
+			const char* begin = reinterpret_cast<const char*>(&values.bytes[row * column.size]);
+			std::cout << std::string{begin, strnlen(begin, column.size)};
+		}
+	}
+
+	size_type printRows(QueryIterator& result)
+	{
+		const std::vector<ColumnDescriptor>& columns = result.getColumns();
+		size_type rowCount = 0;
+
+		for(size_type i = 0; i < columns.size(); ++i) std::cout << (i ? "\t" : "") << columns[i].name;
+		std::cout << '\n';
+
+		while(result.next())
+		{
+			const ColumnBatch& batch = result.getBatch();
+
+			for(size_type i = 0; i < batch.getSelectedCount(); ++i, ++rowCount)
+			{
+				size_type row = batch.getSelectedRow(i);
+
+				for(size_type column = 0; column < columns.size(); ++column)
+				{
+					if(column) std::cout << '\t';
+					printValue(columns[column], batch.columns[column], row);
+				}
+
+				std::cout << '\n';
+			}
+		}
+
+		return rowCount;
+	}
+}
+
+int runQueryCommand(int argc, char** argv)
+{
+	if(argc != 4) return printUsage();
+
+	std::string dbFileName = argv[1];
+	std::string schemaFileName = argv[2];
+	std::string statement = argv[3];
+
+	try
+	{
+		if(!std::ifstream{dbFileName})
+		{
+			std::cerr << "There is no database " << dbFileName << std::endl;
+
+			return EXIT_FAILURE;
+		}
+
+		DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+
+		auto start = std::chrono::steady_clock::now();
+
+		QueryPlan plan = QueryPlanner::plan(QueryParser<usedEndianness>{system}.parse(statement));
+		QueryExecutor<usedEndianness> executor{system};
+		size_type rowCount = 0;
+
+		if(plan.kind == StatementKind::select)
+		{
+			QueryIterator result = executor.select(plan);
+			rowCount = printRows(result);
+		}
+		else
+		{
+			rowCount = executor.execute(plan);
+		}
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout.flush();
+		std::cerr << rowCount << ((plan.kind == StatementKind::select) ? " rows in " : " rows changed in ") << elapsed.count() << " s" << std::endl;
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -22,6 +22,8 @@
 #include <PageReader.hxx>
 #include <BufferManager.hxx>
 #include <DbSystem.hxx>
+#include <ImportCommand.hxx>
+#include <QueryCommand.hxx>
 
 static constexpr ConstString exprBegin = "const char *CTTI::GetTypeName() [T = ";
 static constexpr ConstString exprEnd = "] ";
@@ -113,8 +115,11 @@ enum class Toto2 : uint16_t
 
 //    int tstdd = EXPAND(DEFER_EVAL(A)());
 
-int main()
+int main(int argc, char** argv)
 {
+	if((argc > 1) && (std::string{argv[1]} == "import")) return runImportCommand(argc - 1, argv + 1);
+	if((argc > 1) && (std::string{argv[1]} == "query")) return runQueryCommand(argc - 1, argv + 1);
+
     std::vector<uint8_t> vevec{16, 0};
 	std::vector<uint8_t> dateVec{16, 2, 7, 224};
 	Utils::RawDataAdaptator<size_type, sizeof(size_type), Endianness::little> tt2{4};
@@ -193,12 +198,12 @@ int main()
 
 	std::vector<uint8_t> dummyDiskData{
 		3, 4, 0, 0, 0, 0, 0, 0,
-		0xa7, 0, 0, 0, 0, 0, 0, 0,
+		0xad, 0, 0, 0, 0, 0, 0, 0,
 		43, 0, 0, 0,
         2, 0, 0, 0, 0, 0, 0, 0,
 		'R', 'u', 'n', 'n', 'e', 'r', '\0',
 		2, 0, 0, 0, 0, 0, 0, 0,
-		0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0,
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 		0, 0, 0, 0,
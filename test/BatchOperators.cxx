@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <ColumnBatch.hxx>
+#include <Predicate.hxx>
+#include <BatchOperators.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+// Runners numbered from 0, a name, a best time and a speed by runner, in batches of batchSize rows.
+class RunnerSource : public BatchOperator
+{
+public:
+	RunnerSource(size_type rowCount, size_type batchSize)
+	: columns_{{"Name", DataType::CHARACTER, 4, ColumnKind::bytes}, {"BestTime", DataType::INTEGER, 4, ColumnKind::unsignedInteger},
+			   {"Speed", DataType::FLOAT, 8, ColumnKind::floatingPoint}},
+	  rowCount_{rowCount},
+	  batchSize_{batchSize},
+	  nextRow_{0}
+	{}
+
+	const std::vector<ColumnDescriptor>& getColumns() const noexcept override
+	{
+		return columns_;
+	}
+
+	bool next(ColumnBatch& batch) override
+	{
+		if(nextRow_ == rowCount_) return false;
+
+		batch.reset(columns_);
+
+		for(; (nextRow_ < rowCount_) && (batch.rowCount < batchSize_); ++nextRow_, ++batch.rowCount)
+		{
+			std::string name = (nextRow_ % 3 == 0) ? "Ann" : "Bob";
+			std::copy(name.begin(), name.end(), &batch.columns[0].bytes[batch.rowCount * 4]);
+			batch.columns[0].bytes[batch.rowCount * 4 + 3] = 0;
+			batch.columns[1].integers[batch.rowCount] = 3000 + nextRow_;
+			batch.columns[2].floats[batch.rowCount] = nextRow_ / 2.0;
+		}
+
+		return true;
+	}
+
+private:
+	std::vector<ColumnDescriptor> columns_;
+	size_type rowCount_;
+	size_type batchSize_;
+	size_type nextRow_;
+};
+
+static std::vector<uint64_t> collectBestTimes(BatchOperator& op)
+{
+	std::vector<uint64_t> bestTimes;
+	ColumnBatch batch;
+	size_type column = 0;
+
+	while(op.getColumns()[column].name != "BestTime") ++column;
+
+	while(op.next(batch))
+	{
+		for(size_type i = 0; i < batch.getSelectedCount(); ++i) bestTimes.push_back(batch.columns[column].integers[batch.getSelectedRow(i)]);
+	}
+
+	return bestTimes;
+}
+
+static std::vector<uint64_t> filter(const Predicate& predicate)
+{
+	BatchFilter<usedEndianness> filter{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, predicate};
+	return collectBestTimes(filter);
+}
+
+suite<> batchOperatorsSuite("Testing suite for the batch operators", [](auto& _){
+	_.test("Testing that a filter selects the rows matching the comparisons", []() {
+		expect(filter(Predicate::compare("BestTime", CompareOperator::less, 3003)), equal_to(std::vector<uint64_t>{3000, 3001, 3002}));
+		expect(filter(Predicate::compare("Name", CompareOperator::equal, "Ann")), equal_to(std::vector<uint64_t>{3000, 3003, 3006, 3009}));
+		expect(filter(Predicate::compare("Speed", CompareOperator::greaterOrEqual, 4)), equal_to(std::vector<uint64_t>{3008, 3009}));
+		expect(filter(Predicate::compare("BestTime", CompareOperator::greater, 4000)), equal_to(std::vector<uint64_t>{}));
+	});
+
+	_.test("Testing that a filter combines the comparisons", []() {
+		auto isAnn = Predicate::compare("Name", CompareOperator::equal, "Ann");
+		auto isSlow = Predicate::compare("Speed", CompareOperator::less, 1.5);
+		auto isLate = Predicate::compare("BestTime", CompareOperator::greaterOrEqual, 3008);
+
+		expect(filter(isAnn && isSlow), equal_to(std::vector<uint64_t>{3000}));
+		expect(filter(isSlow || isLate), equal_to(std::vector<uint64_t>{3000, 3001, 3002, 3008, 3009}));
+		expect(filter(isAnn && (isSlow || isLate)), equal_to(std::vector<uint64_t>{3000, 3009}));
+		expect(filter((isAnn || isSlow) && isLate), equal_to(std::vector<uint64_t>{3009}));
+	});
+
+	_.test("Testing that a projection keeps the columns asked for", []() {
+		BatchProject project{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, {"Speed", "BestTime"}};
+
+		expect(project.getColumns().size(), equal_to(2u));
+		expect(project.getColumns()[0].name, equal_to("Speed"));
+		expect(collectBestTimes(project).size(), equal_to(10u));
+		expect([]() { BatchProject{std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, {"Surname"}}; }, thrown<QueryException>());
+
+		// A column kept twice holds the values of the current batch at both places.
+		BatchProject twice{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, {"BestTime", "Speed", "BestTime"}};
+		ColumnBatch batch;
+
+		for(uint64_t first = 3000; twice.next(batch); first += 4)
+		{
+			for(size_type row = 0; row < batch.rowCount; ++row)
+			{
+				expect(batch.columns[0].integers[row], equal_to(first + row));
+				expect(batch.columns[2].integers[row], equal_to(first + row));
+			}
+		}
+	});
+
+	_.test("Testing that the aggregates are computed by group", []() {
+		BatchAggregate aggregate{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, {"Name"},
+								 {{AggregateFunction::count, ""}, {AggregateFunction::sum, "BestTime"}, {AggregateFunction::maximum, "Speed"},
+								  {AggregateFunction::average, "BestTime"}}};
+		ColumnBatch batch;
+
+		expect(aggregate.getColumns()[2].name, equal_to("sum(BestTime)"));
+		expect(aggregate.next(batch), equal_to(true));
+		expect(batch.rowCount, equal_to(2u));
+		expect(std::string{reinterpret_cast<const char*>(&batch.columns[0].bytes[0])}, equal_to("Ann"));
+		expect(batch.columns[1].integers[0], equal_to(4u));
+		expect(batch.columns[1].integers[1], equal_to(6u));
+		expect(batch.columns[2].integers[0], equal_to(12018u));
+		expect(batch.columns[3].floats[1], equal_to(4.0));
+		expect(batch.columns[4].floats[0], equal_to(3004.5));
+		expect(aggregate.next(batch), equal_to(false));
+
+		BatchAggregate total{std::unique_ptr<BatchOperator>{new RunnerSource{0, 4}}, {}, {{AggregateFunction::count, ""}}};
+
+		expect(total.next(batch), equal_to(true));
+		expect(batch.columns[0].integers[0], equal_to(0u));
+		expect([]() { BatchAggregate{std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, {}, {{AggregateFunction::sum, "Name"}}}; },
+			   thrown<QueryException>());
+	});
+
+	_.test("Testing that a sort orders the rows by its keys, and keeps the first ones with a limit", []() {
+		BatchSort sort{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, {{"Name", false}, {"Speed", true}}};
+		expect(collectBestTimes(sort), equal_to(std::vector<uint64_t>{3009, 3006, 3003, 3000, 3008, 3007, 3005, 3004, 3002, 3001}));
+
+		BatchSort top{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, {{"BestTime", true}}, size_type{3}};
+		expect(collectBestTimes(top), equal_to(std::vector<uint64_t>{3009, 3008, 3007}));
+
+		BatchLimit limit{std::unique_ptr<BatchOperator>{new RunnerSource{10, 4}}, 6};
+		expect(collectBestTimes(limit), equal_to(std::vector<uint64_t>{3000, 3001, 3002, 3003, 3004, 3005}));
+	});
+
+	_.test("Testing that a join pairs the rows with equal keys, whichever side is hashed", []() {
+		for(bool isLeftHashed : {false, true})
+		{
+			std::unique_ptr<BatchOperator> left{new BatchProject{std::unique_ptr<BatchOperator>{new RunnerSource{4, 4}}, {"Name"}}};
+			BatchJoin join{std::move(left), std::unique_ptr<BatchOperator>{new RunnerSource{7, 3}}, "Name", "Name", isLeftHashed};
+
+			expect(join.getColumns().size(), equal_to(4u));
+			expect(join.getColumns()[0].name, equal_to("Name"));
+
+			// Ann is the name of 2 of the left rows and 3 of the right ones, Bob of 2 and 4.
+			std::vector<uint64_t> bestTimes = collectBestTimes(join);
+			std::sort(bestTimes.begin(), bestTimes.end());
+			expect(bestTimes, equal_to(std::vector<uint64_t>{3000, 3000, 3001, 3001, 3002, 3002, 3003, 3003, 3004, 3004, 3005, 3005, 3006, 3006}));
+		}
+
+		expect([]() { BatchJoin{std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, "Name", "BestTime"}; },
+			   thrown<QueryException>());
+		expect([]() { BatchJoin{std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, std::unique_ptr<BatchOperator>{new RunnerSource{1, 1}}, "BestTime", "Speed"}; },
+			   thrown<QueryException>());
+	});
+});
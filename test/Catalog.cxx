@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Catalog.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static const std::string catalogFileName = "CatalogTest.cat";
+static constexpr std::streamoff slotSize = 16384;
+
+// Commits a catalog whose only entry, and the database file size, are made of the given value.
+static void commitVersion(Catalog<usedEndianness>& catalog, std::streamoff value, bool clean = false)
+{
+	catalog.setEntry("Runner", CatalogEntry{value, value, 1, 10});
+	catalog.setDatabaseFileSize(value);
+	catalog.commit(clean);
+}
+
+static std::streamoff getFileSize()
+{
+	std::ifstream file{catalogFileName, std::ios::binary | std::ios::ate};
+	return file.tellg();
+}
+
+// Flips a byte of the file, as a write torn in the middle would.
+static void corruptByte(std::streamoff offset)
+{
+	std::fstream file{catalogFileName, std::ios::in | std::ios::out | std::ios::binary};
+	file.seekg(offset);
+	char byte = static_cast<char>(file.get() ^ 0xFF);
+	file.seekp(offset);
+	file.put(byte);
+}
+
+suite<> catalogSuite("Testing suite for the Catalog", [](auto& _){
+	_.test("Testing that the commits alternate between the slots, the last one being loaded", []() {
+		std::remove(catalogFileName.c_str());
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			expect(catalog.isValid(), equal_to(false));
+
+			commitVersion(catalog, 100);
+			expect(getFileSize() < slotSize, equal_to(true));
+
+			commitVersion(catalog, 200);
+			expect(getFileSize() > slotSize, equal_to(true));
+		}
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			expect(catalog.isValid(), equal_to(true));
+			expect(catalog.getDatabaseFileSize(), equal_to(200));
+			expect(catalog.getEntry("Runner")->lastPageOffset, equal_to(200));
+			expect(catalog.getEntry("Runner")->rowCount, equal_to(10u));
+
+			// Back in the first slot : damaging it leaves the version of the second one.
+			commitVersion(catalog, 300);
+		}
+
+		expect(Catalog<usedEndianness>{catalogFileName}.getDatabaseFileSize(), equal_to(300));
+
+		corruptByte(3 * 8);
+		expect(Catalog<usedEndianness>{catalogFileName}.getDatabaseFileSize(), equal_to(200));
+
+		std::remove(catalogFileName.c_str());
+	});
+
+	_.test("Testing that a torn slot is ignored", []() {
+		std::remove(catalogFileName.c_str());
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			commitVersion(catalog, 100);
+			commitVersion(catalog, 200);
+		}
+
+		// The checksum of the second slot does not match anymore.
+		corruptByte(slotSize + 5 * 8);
+		expect(Catalog<usedEndianness>{catalogFileName}.getDatabaseFileSize(), equal_to(100));
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			commitVersion(catalog, 200);
+		}
+
+		// The second slot is cut short.
+		{
+			std::ifstream file{catalogFileName, std::ios::binary};
+			std::string slots(static_cast<size_type>(slotSize + 16), '\0');
+			file.read(&slots[0], slots.size());
+			file.close();
+
+			std::ofstream{catalogFileName, std::ios::binary | std::ios::trunc}.write(slots.data(), slots.size());
+		}
+
+		expect(Catalog<usedEndianness>{catalogFileName}.getDatabaseFileSize(), equal_to(100));
+
+		corruptByte(0);
+		expect(Catalog<usedEndianness>{catalogFileName}.isValid(), equal_to(false));
+
+		std::remove(catalogFileName.c_str());
+	});
+
+	_.test("Testing that only a commit said clean is loaded clean", []() {
+		std::remove(catalogFileName.c_str());
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			commitVersion(catalog, 100, true);
+			expect(catalog.isClean(), equal_to(true));
+		}
+
+		{
+			Catalog<usedEndianness> catalog{catalogFileName};
+			expect(catalog.isClean(), equal_to(true));
+
+			commitVersion(catalog, 100);
+		}
+
+		expect(Catalog<usedEndianness>{catalogFileName}.isClean(), equal_to(false));
+
+		std::remove(catalogFileName.c_str());
+	});
+});
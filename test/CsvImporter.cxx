@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <DbSystem.hxx>
+#include <CsvImporter.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static const std::string dbFileName = "CsvImporterTest.db";
+static const std::string schemaFileName = "CsvImporterTest.sch";
+
+static void removeDatabase()
+{
+	for(const std::string& fileName : {dbFileName, schemaFileName, dbFileName + ".cat", dbFileName + ".fsm"})
+	{
+		std::remove(fileName.c_str());
+	}
+}
+
+// An empty database, with a schema of laps.
+static void createDatabase()
+{
+	removeDatabase();
+
+	std::ofstream{dbFileName};
+	std::ofstream{schemaFileName};
+
+	FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+	schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(
+		DbSchema{"Lap", {{"Number", {DataType::INTEGER, 32}}, {"Runner", {DataType::CHARACTER, 8}}}}));
+}
+
+// The lap numbers from first to last, one by line, after the header if any.
+static std::string makeCsv(size_type first, size_type last, const std::string& header = "")
+{
+	std::string csv = header;
+
+	for(size_type number = first; number <= last; ++number)
+	{
+		csv += std::to_string(number) + ",Ann\n";
+	}
+
+	return csv;
+}
+
+// Small chunks and several parsers : the chunks are parsed out of order.
+static CsvImportOptions makeOptions(size_type queueDepth, size_type threadCount, bool hasHeader = false)
+{
+	CsvImportOptions options;
+	options.hasHeader = hasHeader;
+	options.threadCount = threadCount;
+	options.chunkSize = 16;
+	options.queueDepth = queueDepth;
+
+	return options;
+}
+
+// Imports the text, and returns the lap numbers of the rows in the order of their pages.
+static std::vector<size_type> importText(const std::string& text, CsvImportOptions options)
+{
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName};
+	std::istringstream input{text};
+
+	size_type rowCount = CsvImporter<usedEndianness>{system, "Lap", options}.import(input);
+
+	std::vector<size_type> numbers;
+
+	for(auto it = system.getIterator("Lap"); it != system.endIterator("Lap"); ++it)
+	{
+		numbers.push_back((*it).template getAs<uint32_t>("Number"));
+	}
+
+	expect(numbers.size(), equal_to(rowCount));
+
+	return numbers;
+}
+
+static bool isSequence(const std::vector<size_type>& numbers, size_type first, size_type last)
+{
+	if(numbers.size() != last - first + 1) return false;
+
+	for(size_type i = 0; i < numbers.size(); ++i)
+	{
+		if(numbers[i] != first + i) return false;
+	}
+
+	return true;
+}
+
+suite<> csvImporterSuite("Testing suite for CsvImporter", [](auto& _){
+	_.test("Testing that the rows are written in the order of the file", []() {
+		createDatabase();
+
+		expect(isSequence(importText(makeCsv(1, 3000), makeOptions(2, 4)), 1, 3000), equal_to(true));
+
+		removeDatabase();
+	});
+
+	_.test("Testing that a header longer than a chunk is skipped", []() {
+		createDatabase();
+
+		std::string header = "Number of the lap,Name of the runner who ran it\r\n";
+		expect(isSequence(importText(makeCsv(1, 100, header), makeOptions(2, 3, true)), 1, 100), equal_to(true));
+
+		removeDatabase();
+	});
+
+	_.test("Testing that an invalid line stops the import, and is given", []() {
+		createDatabase();
+
+		std::string csv = makeCsv(1, 298, "Number,Runner\n") + "299,Ann,Extra\n" + makeCsv(300, 1000);
+		std::string message;
+
+		try
+		{
+			importText(csv, makeOptions(2, 4, true));
+		}
+		catch(const CsvImportException& e)
+		{
+			message = e.what();
+		}
+
+		// The header is the first line.
+		expect(message, regex_match(".*line 300,.*"));
+
+		removeDatabase();
+	});
+
+	_.test("Testing that the chunks in flight are handed back, whatever the depth of the queues", []() {
+		// Many more chunks than the pipeline lets in flight at once : with one missing, the import would never end.
+		for(size_type queueDepth : {0, 1, 3})
+		{
+			for(size_type threadCount : {1, 5})
+			{
+				createDatabase();
+
+				expect(isSequence(importText(makeCsv(1, 500), makeOptions(queueDepth, threadCount)), 1, 500), equal_to(true));
+
+				removeDatabase();
+			}
+		}
+	});
+});
@@ -0,0 +1,84 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <CsvRowEncoder.hxx>
+
+#include "RunnerSchema.hxx"
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static std::vector<uint8_t> encode(const DbSchema& schema, const std::string& line, char delimiter = ',')
+{
+	CsvRowEncoder<usedEndianness> encoder{schema, delimiter};
+	std::vector<uint8_t> row(schema.getDataSize());
+
+	encoder.encode(line.data(), line.data() + line.size(), row.data());
+
+	return row;
+}
+
+static bool throwsOn(const DbSchema& schema, const std::string& line)
+{
+	try
+	{
+		encode(schema, line);
+	}
+	catch(const CsvImportException&)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+suite<> csvRowEncoderSuite("Testing suite for CsvRowEncoder", [](auto& _){
+	_.test("Testing that the fields are encoded as the entries read them", []() {
+		DbSchema schema = makeRunnerSchema();
+		std::vector<uint8_t> row = encode(schema, "Norbert,3605,12.5,16/2/2016,true,7");
+		DbEntryView<usedEndianness> entry{schema, row.data()};
+
+		expect(entry.getAs<std::string>("Name"), equal_to("Norbert"));
+		expect(entry.getAs<uint32_t>("BestTime"), equal_to(3605));
+		expect(entry.getAs<double>("Speed"), equal_to(12.5));
+		expect(row[schema.getFieldOffset("Licensed")], equal_to(1));
+		expect(entry.getAs<uint16_t>("Number"), equal_to(7));
+	});
+
+	_.test("Testing that the quoted fields are unquoted", []() {
+		DbSchema schema = makeRunnerSchema();
+		std::vector<uint8_t> row = encode(schema, "\"A;\"\"B\"\";C\";1;0;1/1/2000;0;0\r", ';');
+		DbEntryView<usedEndianness> entry{schema, row.data()};
+
+		expect(entry.getAs<std::string>("Name"), equal_to("A;\"B\";C"));
+		expect(entry.getAs<uint32_t>("BestTime"), equal_to(1));
+		expect(row[schema.getFieldOffset("Licensed")], equal_to(0));
+	});
+
+	_.test("Testing that the dates are encoded day, month and year", []() {
+		DbSchema schema{"Book", {{"Parution", {DataType::DATE}}}};
+		std::vector<uint8_t> row = encode(schema, "16/2/2016");
+
+		expect(row, equal_to(std::vector<uint8_t>{16, 2, 0xE0, 0x07}));
+	});
+
+	_.test("Testing that the invalid lines are rejected", []() {
+		DbSchema schema = makeRunnerSchema();
+
+		expect(throwsOn(schema, "Norbert,3605,12.5,16/2/2016,true"), equal_to(true));
+		expect(throwsOn(schema, "Norbert,3605,12.5,16/2/2016,true,7,1"), equal_to(true));
+		expect(throwsOn(schema, "Norbert,-1,12.5,16/2/2016,true,7"), equal_to(true));
+		expect(throwsOn(schema, "Norbert,4294967296,12.5,16/2/2016,true,7"), equal_to(true));
+		expect(throwsOn(schema, "Norbert,3605,fast,16/2/2016,true,7"), equal_to(true));
+		expect(throwsOn(schema, "Norbert the runner,3605,12.5,16/2/2016,true,7"), equal_to(true));
+		expect(throwsOn(schema, "\"Norbert,3605,12.5,16/2/2016,true,7"), equal_to(true));
+	});
+});
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <SlotBitmap.hxx>
+#include <FieldCompare.hxx>
+
+// All the instruction sets of the processor, the kernels must agree on each of them.
+static std::vector<FieldCompare::InstructionSet> getInstructionSets()
+{
+	std::vector<FieldCompare::InstructionSet> instructionSets{FieldCompare::InstructionSet::scalar};
+
+	if(FieldCompare::getInstructionSet() != FieldCompare::InstructionSet::scalar) instructionSets.push_back(FieldCompare::InstructionSet::sse42);
+	if(FieldCompare::getInstructionSet() == FieldCompare::InstructionSet::avx2) instructionSets.push_back(FieldCompare::InstructionSet::avx2);
+
+	return instructionSets;
+}
+
+// Rows of stride bytes, after 8 bytes standing for the header of a page.
+struct Rows
+{
+	static constexpr size_type headerSize = 8;
+
+	Rows(size_type count, size_type stride) : bytes(headerSize + count * stride), stride{stride}
+	{
+		std::mt19937 generator{42};
+		for(auto& byte : bytes) byte = static_cast<uint8_t>(generator());
+	}
+
+	uint8_t* getField(size_type row, size_type offset)
+	{
+		return bytes.data() + headerSize + row * stride + offset;
+	}
+
+	std::vector<uint8_t> bytes;
+	size_type stride;
+};
+
+static uint64_t readInteger(const uint8_t* field, size_type size)
+{
+	uint64_t value = 0;
+	for(size_type i = 0; i < size; ++i) value |= static_cast<uint64_t>(field[i]) << (8 * i);
+
+	return value;
+}
+
+static bool checkIntegers(size_type count, size_type stride, size_type offset, size_type size, uint64_t low, uint64_t high, bool negate)
+{
+	Rows rows{count, stride};
+
+	for(auto instructionSet : getInstructionSets())
+	{
+		std::vector<uint8_t> mask(SlotBitmap::getSize(count), 0xFF);
+		FieldCompare::compareIntegers(rows.getField(0, offset), size, stride, count, low, high, negate, mask.data(), instructionSet);
+
+		for(size_type row = 0; row < count; ++row)
+		{
+			uint64_t value = readInteger(rows.getField(row, offset), size);
+
+			if(SlotBitmap::test(mask.data(), row) != (((value >= low) && (value <= high)) != negate)) return false;
+		}
+
+		// The bits past the last row are cleared.
+		for(size_type row = count; row < SlotBitmap::getSize(count) * 8; ++row)
+		{
+			if(SlotBitmap::test(mask.data(), row)) return false;
+		}
+	}
+
+	return true;
+}
+
+template<class T>
+static bool checkFloatingPoints(size_type count, size_type stride, T low, T high, bool negate)
+{
+	Rows rows{count, stride};
+
+	for(size_type row = 0; row < count; ++row)
+	{
+		T value = static_cast<T>(static_cast<int>(row % 41) - 20) / 4;
+		if(row % 37 == 0) value = std::numeric_limits<T>::quiet_NaN();
+
+		std::memcpy(rows.getField(row, 0), &value, sizeof(value));
+	}
+
+	for(auto instructionSet : getInstructionSets())
+	{
+		std::vector<uint8_t> mask(SlotBitmap::getSize(count), 0xFF);
+		FieldCompare::compareFloatingPoints<T>(rows.getField(0, 0), stride, count, low, high, negate, mask.data(), instructionSet);
+
+		for(size_type row = 0; row < count; ++row)
+		{
+			T value;
+			std::memcpy(&value, rows.getField(row, 0), sizeof(value));
+
+			if(SlotBitmap::test(mask.data(), row) != (((value >= low) && (value <= high)) != negate)) return false;
+		}
+	}
+
+	return true;
+}
+
+suite<> fieldCompareSuite("Testing suite for FieldCompare", [](auto& _){
+	_.test("Testing that the integers of every size are compared to the range", []() {
+		for(size_type size = 1; size <= 8; ++size)
+		{
+			uint64_t max = (size == 8) ? ~uint64_t{0} : ((uint64_t{1} << (8 * size)) - 1);
+
+			expect(checkIntegers(200, 13, 2, size, max / 4, max / 2, false), equal_to(true));
+			expect(checkIntegers(200, 13, 0, size, max / 4, max / 2, true), equal_to(true));
+			expect(checkIntegers(131, 32, 20, size, 0, max / 3, false), equal_to(true));
+			expect(checkIntegers(131, 32, 4, size, max / 3, max, false), equal_to(true));
+		}
+	});
+
+	_.test("Testing that the empty and the whole ranges select nothing and everything", []() {
+		expect(checkIntegers(100, 8, 0, 4, 10, 9, false), equal_to(true));
+		expect(checkIntegers(100, 8, 0, 4, uint64_t{1} << 40, ~uint64_t{0}, true), equal_to(true));
+		expect(checkIntegers(100, 8, 0, 8, 0, ~uint64_t{0}, false), equal_to(true));
+		expect(checkIntegers(64, 8, 0, 2, 0, ~uint64_t{0}, true), equal_to(true));
+	});
+
+	_.test("Testing that the floating point numbers are compared to the range, a NaN never in it", []() {
+		expect(checkFloatingPoints<float>(300, 12, -1.5f, 2.0f, false), equal_to(true));
+		expect(checkFloatingPoints<float>(300, 4, 0.25f, 0.25f, true), equal_to(true));
+		expect(checkFloatingPoints<double>(300, 24, -std::numeric_limits<double>::infinity(), 0.0, false), equal_to(true));
+		expect(checkFloatingPoints<double>(77, 8, 3.0, 1.0, true), equal_to(true));
+	});
+});
@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <DbSystem.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static const std::string dbFileName = "FreeSpaceMapTest.db";
+static const std::string schemaFileName = "FreeSpaceMapTest.sch";
+static const std::string mapFileName = dbFileName + ".fsm";
+
+static void removeDatabase()
+{
+	for(const std::string& fileName : {dbFileName, schemaFileName, dbFileName + ".cat", mapFileName})
+	{
+		std::remove(fileName.c_str());
+	}
+}
+
+/* Three pages of four rows, holding the values 0 to 9, the rows below 3 removed : the first and the last pages have
+ * free slots. Returns the offset of the first page. */
+static std::streamoff createDatabase()
+{
+	removeDatabase();
+
+	std::ofstream{dbFileName};
+	std::ofstream{schemaFileName};
+
+	FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+	schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(DbSchema{"Lap", {{"Number", {DataType::INTEGER, 32}}}}));
+	schemaWriter.flush();
+
+	DbSystem<usedEndianness> system{dbFileName, schemaFileName, 4};
+	const DbSchema& schema = *system.getSchema(*system.getSchemaIndex("Lap"));
+
+	for(uint8_t number = 0; number < 10; ++number)
+	{
+		std::vector<uint8_t> data(schema.getDataSize(), 0);
+		data[0] = number;
+		system.add(DbEntry<usedEndianness>{schema, data});
+	}
+
+	system.removeWhen("Lap", [](const DbEntryView<usedEndianness>& entry) { return entry.template getAs<int32_t>(0) < 3; });
+
+	return system.getCatalogEntry("Lap")->firstPageOffset;
+}
+
+// The map as the database committed it, the first page with a free slot forgotten.
+static std::streamoff forgetFirstPage(std::streamoff firstPageOffset, std::streamoff sizeShift)
+{
+	FreeSpaceMap<usedEndianness> freeSpaceMap{mapFileName};
+	std::streamoff databaseFileSize = freeSpaceMap.getDatabaseFileSize();
+
+	freeSpaceMap.update("Lap", firstPageOffset, false);
+	freeSpaceMap.commit(databaseFileSize + sizeShift);
+
+	return databaseFileSize;
+}
+
+suite<> freeSpaceMapSuite("Testing suite for the FreeSpaceMap", [](auto& _){
+	_.test("Testing that the map is loaded back as committed, and rejected when damaged", []() {
+		std::remove(mapFileName.c_str());
+
+		{
+			FreeSpaceMap<usedEndianness> freeSpaceMap{mapFileName};
+			expect(freeSpaceMap.isValid(), equal_to(false));
+
+			freeSpaceMap.update("Lap", 2048, true);
+			freeSpaceMap.update("Lap", 512, true);
+			freeSpaceMap.update("Runner", 1024, true);
+			freeSpaceMap.setValid(4096);
+			freeSpaceMap.commit(4096);
+		}
+
+		{
+			FreeSpaceMap<usedEndianness> freeSpaceMap{mapFileName};
+			expect(freeSpaceMap.isValid(), equal_to(true));
+			expect(freeSpaceMap.getDatabaseFileSize(), equal_to(4096));
+			expect(*freeSpaceMap.findPage("Lap"), equal_to(512));
+			expect(*freeSpaceMap.findPage("Runner"), equal_to(1024));
+			expect(bool(freeSpaceMap.findPage("Unknown")), equal_to(false));
+		}
+
+		std::string record;
+		{
+			std::ifstream file{mapFileName, std::ios::binary};
+			record.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+		}
+
+		// An offset which does not match the checksum anymore.
+		std::string damagedRecord = record;
+		damagedRecord[damagedRecord.size() - 12] ^= 0x01;
+		std::ofstream{mapFileName, std::ios::binary | std::ios::trunc} << damagedRecord;
+		expect(FreeSpaceMap<usedEndianness>{mapFileName}.isValid(), equal_to(false));
+
+		// A record cut short.
+		std::ofstream{mapFileName, std::ios::binary | std::ios::trunc} << record.substr(0, record.size() - 8);
+		expect(FreeSpaceMap<usedEndianness>{mapFileName}.isValid(), equal_to(false));
+
+		std::remove(mapFileName.c_str());
+	});
+
+	_.test("Testing that a map which does not match the size of the database is rebuilt", []() {
+		std::streamoff firstPageOffset = createDatabase();
+		expect(*FreeSpaceMap<usedEndianness>{mapFileName}.findPage("Lap"), equal_to(firstPageOffset));
+
+		std::streamoff databaseFileSize = forgetFirstPage(firstPageOffset, 1);
+
+		DbSystem<usedEndianness>{dbFileName, schemaFileName, 4};
+
+		FreeSpaceMap<usedEndianness> freeSpaceMap{mapFileName};
+		expect(freeSpaceMap.getDatabaseFileSize(), equal_to(databaseFileSize));
+		expect(*freeSpaceMap.findPage("Lap"), equal_to(firstPageOffset));
+
+		removeDatabase();
+	});
+
+	_.test("Testing that the map is rebuilt when the database was not closed", []() {
+		std::streamoff firstPageOffset = createDatabase();
+		forgetFirstPage(firstPageOffset, 0);
+
+		// A crash leaves the catalog committed while the database was open.
+		{
+			Catalog<usedEndianness> catalog{dbFileName + ".cat"};
+			catalog.commit();
+		}
+
+		{
+			DbSystem<usedEndianness> system{dbFileName, schemaFileName, 4};
+			expect(system.getCatalogEntry("Lap")->rowCount, equal_to(7u));
+		}
+
+		expect(*FreeSpaceMap<usedEndianness>{mapFileName}.findPage("Lap"), equal_to(firstPageOffset));
+
+		removeDatabase();
+	});
+});
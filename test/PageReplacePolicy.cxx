@@ -0,0 +1,347 @@
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <ARCPageReplacePolicy.hxx>
+#include <ClockPageReplacePolicy.hxx>
+#include <LRUPageReplacePolicy.hxx>
+#include <TwoQueuePageReplacePolicy.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+std::vector<DiskPage<usedEndianness>> makePages(size_type count)
+{
+	static const DbSchema schema{"Test", {{"Value", {DataType::CHARACTER, 1}}}};
+
+	std::vector<DiskPage<usedEndianness>> pages;
+	for(size_type i = 0; i < count; ++i)
+	{
+		pages.emplace_back(i, schema, 1);
+	}
+
+	return pages;
+}
+
+suite<> lruPolicySuite("Testing suite for LRUPageReplacePolicy", [](auto& _){
+	_.test("Testing that no candidate is given while every frame is pinned", []() {
+		auto pages = makePages(4);
+		LRUPageReplacePolicy<usedEndianness> policy{4};
+
+		for(auto& page : pages) policy.use(page);
+
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+
+	_.test("Testing that candidates are given in release order", []() {
+		auto pages = makePages(4);
+		LRUPageReplacePolicy<usedEndianness> policy{4};
+
+		policy.release(pages[2]);
+		policy.release(pages[0]);
+		policy.release(pages[3]);
+		policy.release(pages[1]);
+
+		expect(*policy.getCandidate(), equal_to(2));
+		expect(*policy.getCandidate(), equal_to(0));
+		expect(*policy.getCandidate(), equal_to(3));
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+
+	_.test("Testing that a pinned frame is never a candidate", []() {
+		auto pages = makePages(3);
+		LRUPageReplacePolicy<usedEndianness> policy{3};
+
+		for(auto& page : pages) policy.release(page);
+		policy.use(pages[0]);
+		policy.use(pages[2]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+
+	_.test("Testing that a re-used frame goes back to the most recently used end", []() {
+		auto pages = makePages(3);
+		LRUPageReplacePolicy<usedEndianness> policy{3};
+
+		for(auto& page : pages) policy.release(page);
+		policy.use(pages[0]);
+		policy.release(pages[0]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(*policy.getCandidate(), equal_to(2));
+		expect(*policy.getCandidate(), equal_to(0));
+	});
+
+	_.test("Testing that frames beyond the initial size are handled", []() {
+		auto pages = makePages(8);
+		LRUPageReplacePolicy<usedEndianness> policy{2};
+
+		policy.release(pages[7]);
+		policy.release(pages[5]);
+
+		expect(policy.getCandidateCount(), equal_to(2));
+		expect(*policy.getCandidate(), equal_to(7));
+		expect(*policy.getCandidate(), equal_to(5));
+	});
+});
+
+suite<> clockPolicySuite("Testing suite for ClockPageReplacePolicy", [](auto& _){
+	_.test("Testing that no candidate is given while every frame is pinned", []() {
+		auto pages = makePages(4);
+		ClockPageReplacePolicy<usedEndianness> policy{4};
+
+		for(auto& page : pages) policy.use(page);
+
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+
+	_.test("Testing that frames which never held a page are not candidates", []() {
+		auto pages = makePages(4);
+		ClockPageReplacePolicy<usedEndianness> policy{4};
+
+		policy.release(pages[1]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+	});
+
+	_.test("Testing that a referenced frame gets a second chance", []() {
+		auto pages = makePages(3);
+		ClockPageReplacePolicy<usedEndianness> policy{3};
+
+		for(auto& page : pages) policy.release(page);
+
+		// The first sweep clears every reference bit, and the hand comes back to the first frame.
+		expect(*policy.getCandidate(), equal_to(0));
+
+		policy.use(pages[1]);
+		policy.release(pages[1]);
+
+		expect(policy.isReferenced(1), equal_to(true));
+		expect(*policy.getCandidate(), equal_to(2));
+		expect(policy.isReferenced(1), equal_to(false));
+	});
+
+	_.test("Testing that a pinned frame is never a candidate", []() {
+		auto pages = makePages(3);
+		ClockPageReplacePolicy<usedEndianness> policy{3};
+
+		for(auto& page : pages) policy.release(page);
+		policy.use(pages[0]);
+		policy.use(pages[2]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(*policy.getCandidate(), equal_to(1));
+	});
+
+	_.test("Testing that frames beyond the initial size are handled", []() {
+		auto pages = makePages(8);
+		ClockPageReplacePolicy<usedEndianness> policy{2};
+
+		policy.release(pages[6]);
+
+		expect(*policy.getCandidate(), equal_to(6));
+	});
+});
+
+suite<> twoQueuePolicySuite("Testing suite for TwoQueuePageReplacePolicy", [](auto& _){
+	_.test("Testing that new pages go to the probationary queue", []() {
+		auto pages = makePages(4);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{4, 1, 4};
+
+		for(size_type i = 0; i < pages.size(); ++i)
+		{
+			policy.pageLoaded(pages[i], i * 100);
+			policy.release(pages[i]);
+		}
+
+		expect(policy.getProbationCount(), equal_to(4));
+		expect(policy.getProtectedCount(), equal_to(0));
+		expect(*policy.getCandidate(), equal_to(0));
+	});
+
+	_.test("Testing that the probationary queue keeps its pages in the order they were loaded", []() {
+		auto pages = makePages(3);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{3, 1, 4};
+
+		for(size_type i = 0; i < pages.size(); ++i)
+		{
+			policy.pageLoaded(pages[i], i * 100);
+			policy.release(pages[i]);
+		}
+
+		// Touched again during the scan, the first page is still the first to go.
+		policy.use(pages[0]);
+		policy.release(pages[0]);
+
+		expect(*policy.getCandidate(), equal_to(0));
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(policy.getProtectedCount(), equal_to(0));
+	});
+
+	_.test("Testing that a pinned page met at the front of the probationary queue goes back at its end", []() {
+		auto pages = makePages(3);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{3, 1, 4};
+
+		for(size_type i = 0; i < pages.size(); ++i)
+		{
+			policy.pageLoaded(pages[i], i * 100);
+			policy.release(pages[i]);
+		}
+
+		policy.use(pages[0]);
+		expect(*policy.getCandidate(), equal_to(1));
+
+		policy.release(pages[0]);
+		expect(*policy.getCandidate(), equal_to(2));
+		expect(*policy.getCandidate(), equal_to(0));
+	});
+
+	_.test("Testing that a page loaded again while remembered goes to the protected queue", []() {
+		auto pages = makePages(2);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{2, 1, 4};
+
+		policy.pageLoaded(pages[0], 100);
+		policy.release(pages[0]);
+
+		auto candidate = policy.getCandidate();
+		expect(*candidate, equal_to(0));
+		policy.pageEvicted(pages[0], 100);
+		expect(policy.getGhostCount(), equal_to(1));
+
+		policy.pageLoaded(pages[0], 100);
+		policy.release(pages[0]);
+
+		expect(policy.getGhostCount(), equal_to(0));
+		expect(policy.getProtectedCount(), equal_to(1));
+	});
+
+	_.test("Testing that a scan does not evict the protected pages", []() {
+		auto pages = makePages(4);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{4, 1, 8};
+
+		// Make page 0 hot : loaded, evicted, loaded again.
+		policy.pageLoaded(pages[0], 0);
+		policy.release(pages[0]);
+		policy.getCandidate();
+		policy.pageEvicted(pages[0], 0);
+		policy.pageLoaded(pages[0], 0);
+		policy.release(pages[0]);
+
+		for(size_type i = 1; i < pages.size(); ++i)
+		{
+			policy.pageLoaded(pages[i], i * 100);
+			policy.release(pages[i]);
+		}
+
+		// A long scan keeps recycling the probationary frames.
+		for(std::streamoff offset = 1000; offset < 2000; offset += 100)
+		{
+			auto candidate = policy.getCandidate();
+			expect(*candidate, not_equal_to(0));
+			policy.pageEvicted(pages[*candidate], 0);
+			policy.pageLoaded(pages[*candidate], offset);
+			policy.release(pages[*candidate]);
+		}
+
+		expect(policy.getProtectedCount(), equal_to(1));
+	});
+
+	_.test("Testing that a pinned frame is never a candidate", []() {
+		auto pages = makePages(2);
+		TwoQueuePageReplacePolicy<usedEndianness> policy{2};
+
+		policy.pageLoaded(pages[0], 0);
+		policy.pageLoaded(pages[1], 100);
+		policy.use(pages[0]);
+		policy.release(pages[1]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+});
+
+suite<> arcPolicySuite("Testing suite for ARCPageReplacePolicy", [](auto& _){
+	_.test("Testing that a page accessed twice moves to the frequent list", []() {
+		auto pages = makePages(2);
+		ARCPageReplacePolicy<usedEndianness> policy{2};
+
+		policy.pageLoaded(pages[0], 0);
+		policy.use(pages[0]);
+		policy.release(pages[0]);
+
+		expect(policy.getRecentCount(), equal_to(1));
+
+		policy.use(pages[0]);
+		policy.release(pages[0]);
+
+		expect(policy.getRecentCount(), equal_to(0));
+		expect(policy.getFrequentCount(), equal_to(1));
+	});
+
+	_.test("Testing that candidates are taken from the recent list while it exceeds its target", []() {
+		auto pages = makePages(3);
+		ARCPageReplacePolicy<usedEndianness> policy{3};
+
+		for(size_type i = 0; i < pages.size(); ++i)
+		{
+			policy.pageLoaded(pages[i], i * 100);
+			policy.use(pages[i]);
+			policy.release(pages[i]);
+		}
+		policy.use(pages[0]);
+		policy.release(pages[0]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+	});
+
+	_.test("Testing that the target adapts to the ghost hits", []() {
+		auto pages = makePages(2);
+		ARCPageReplacePolicy<usedEndianness> policy{2};
+
+		policy.pageLoaded(pages[0], 0);
+		policy.release(pages[0]);
+		policy.getCandidate();
+		policy.pageEvicted(pages[0], 0);
+
+		expect(policy.getRecentGhostCount(), equal_to(1));
+		expect(policy.getRecentTarget(), equal_to(0));
+
+		// Hit in B1 : the recent list deserved more room.
+		policy.pageLoaded(pages[0], 0);
+		policy.release(pages[0]);
+
+		expect(policy.getRecentTarget(), equal_to(1));
+		expect(policy.getFrequentCount(), equal_to(1));
+
+		policy.getCandidate();
+		policy.pageEvicted(pages[0], 0);
+		expect(policy.getFrequentGhostCount(), equal_to(1));
+
+		// Hit in B2 : the frequent list deserved more room.
+		policy.pageLoaded(pages[0], 0);
+
+		expect(policy.getRecentTarget(), equal_to(0));
+	});
+
+	_.test("Testing that a pinned frame is never a candidate", []() {
+		auto pages = makePages(2);
+		ARCPageReplacePolicy<usedEndianness> policy{2};
+
+		policy.pageLoaded(pages[0], 0);
+		policy.pageLoaded(pages[1], 100);
+		policy.use(pages[0]);
+		policy.use(pages[1]);
+		policy.release(pages[1]);
+
+		expect(*policy.getCandidate(), equal_to(1));
+		expect(policy.getCandidate(), equal_to(nullopt));
+	});
+});
@@ -0,0 +1,135 @@
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <SlotBitmap.hxx>
+#include <Predicate.hxx>
+
+#include "RunnerSchema.hxx"
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static std::vector<uint8_t> makeRow(const DbSchema& schema, const std::string& name, uint32_t bestTime, double speed,
+									std::vector<uint8_t> birth)
+{
+	DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+	entry.setAs("Name", name);
+	entry.setAs("BestTime", bestTime);
+	entry.setAs("Speed", speed);
+	std::copy(birth.begin(), birth.end(), entry.getRawData().begin() + schema.getFieldOffset("Birth"));
+
+	return entry.getRawData();
+}
+
+static bool matches(const Predicate& predicate, const DbSchema& schema, const std::vector<uint8_t>& row)
+{
+	return BoundPredicate<usedEndianness>{predicate, schema}.matches(row.data());
+}
+
+suite<> predicateSuite("Testing suite for Predicate", [](auto& _){
+	_.test("Testing that the comparisons follow the values of the fields", []() {
+		DbSchema schema = makeRunnerSchema();
+		std::vector<uint8_t> row = makeRow(schema, "Norbert", 3605, 12.5, {16, 2, 0xE0, 0x07});
+
+		expect(matches(Predicate::compare("Name", CompareOperator::equal, "Norbert"), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("Name", CompareOperator::equal, "Norb"), schema, row), equal_to(false));
+		expect(matches(Predicate::compare("Name", CompareOperator::greater, "Norb"), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("BestTime", CompareOperator::less, 3606), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("BestTime", CompareOperator::lessOrEqual, 3604), schema, row), equal_to(false));
+		expect(matches(Predicate::compare("Speed", CompareOperator::greaterOrEqual, 12.5), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("Speed", CompareOperator::notEqual, 12), schema, row), equal_to(true));
+	});
+
+	_.test("Testing that the dates are ordered by year, month then day", []() {
+		DbSchema schema = makeRunnerSchema();
+		std::vector<uint8_t> row = makeRow(schema, "Norbert", 3605, 12.5, {16, 2, 0xE0, 0x07});
+
+		expect(matches(Predicate::compare("Birth", CompareOperator::equal, "16/2/2016"), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("Birth", CompareOperator::less, "1/3/2016"), schema, row), equal_to(true));
+		expect(matches(Predicate::compare("Birth", CompareOperator::greater, "31/12/2015"), schema, row), equal_to(true));
+	});
+
+	_.test("Testing that the conjunctions and disjunctions combine the comparisons", []() {
+		DbSchema schema = makeRunnerSchema();
+		std::vector<uint8_t> row = makeRow(schema, "Norbert", 3605, 12.5, {16, 2, 0xE0, 0x07});
+		auto isNorbert = Predicate::compare("Name", CompareOperator::equal, "Norbert");
+		auto isFast = Predicate::compare("BestTime", CompareOperator::less, 3600);
+
+		expect(matches(isNorbert && isFast, schema, row), equal_to(false));
+		expect(matches(isNorbert || isFast, schema, row), equal_to(true));
+		expect(matches(isFast || (isNorbert && Predicate::compare("Speed", CompareOperator::greater, 10)), schema, row), equal_to(true));
+		expect(matches(isNorbert && isNorbert && isFast, schema, row), equal_to(false));
+	});
+
+	_.test("Testing that the slots of a page match as their rows", []() {
+		DbSchema schema = makeRunnerSchema();
+		size_type slotCount = 150;
+		size_type rowSize = schema.getDataSize();
+		// A header stands before the rows, as in a page.
+		std::vector<uint8_t> page(8 + slotCount * rowSize);
+		std::vector<uint8_t> slotBitmap(SlotBitmap::getSize(slotCount), 0);
+		const char* names[] = {"Ann", "Bob", "Norbert"};
+
+		for(size_type slot = 0; slot < slotCount; ++slot)
+		{
+			std::vector<uint8_t> row = makeRow(schema, names[slot % 3], 3500 + slot, (slot % 11) * 1.5,
+											   {static_cast<uint8_t>(1 + slot % 28), static_cast<uint8_t>(1 + slot % 12), 0xE0, 0x07});
+			std::copy(row.begin(), row.end(), page.begin() + 8 + slot * rowSize);
+
+			if(slot % 7 != 3) SlotBitmap::set(slotBitmap.data(), slot);
+		}
+
+		auto agrees = [&](const Predicate& predicate) {
+			BoundPredicate<usedEndianness> bound{predicate, schema};
+			std::vector<uint8_t> mask(slotBitmap.size());
+
+			bound.matchSlots(page.data() + 8, slotBitmap.data(), slotCount, mask.data());
+
+			for(size_type slot = 0; slot < slotCount; ++slot)
+			{
+				bool expected = SlotBitmap::test(slotBitmap.data(), slot) && bound.matches(page.data() + 8 + slot * rowSize);
+				if(SlotBitmap::test(mask.data(), slot) != expected) return false;
+			}
+
+			return true;
+		};
+
+		expect(agrees(Predicate::compare("BestTime", CompareOperator::less, 3600)), equal_to(true));
+		expect(agrees(Predicate::compare("BestTime", CompareOperator::greater, 3500)
+					  && Predicate::compare("BestTime", CompareOperator::lessOrEqual, 3520)), equal_to(true));
+		expect(agrees(Predicate::compare("Speed", CompareOperator::notEqual, 3) || Predicate::compare("Name", CompareOperator::equal, "Bob")),
+			   equal_to(true));
+		expect(agrees(Predicate::compare("Birth", CompareOperator::greaterOrEqual, "10/6/2016")
+					  && (Predicate::compare("Name", CompareOperator::less, "Bob") || Predicate::compare("Speed", CompareOperator::greater, 9))),
+			   equal_to(true));
+		expect(agrees(Predicate::compare("BestTime", CompareOperator::less, 0)), equal_to(true));
+	});
+
+	_.test("Testing that the predicates not fitting the schema are rejected", []() {
+		DbSchema schema = makeRunnerSchema();
+		auto binds = [&schema](const Predicate& predicate) {
+			try
+			{
+				BoundPredicate<usedEndianness>{predicate, schema};
+			}
+			catch(const PredicateException&)
+			{
+				return false;
+			}
+
+			return true;
+		};
+
+		expect(binds(Predicate::compare("Surname", CompareOperator::equal, "Norbert")), equal_to(false));
+		expect(binds(Predicate::compare("BestTime", CompareOperator::equal, "fast")), equal_to(false));
+		expect(binds(Predicate::compare("BestTime", CompareOperator::equal, -1)), equal_to(false));
+		expect(binds(Predicate::compare("Name", CompareOperator::equal, "Norbert the runner")), equal_to(false));
+	});
+});
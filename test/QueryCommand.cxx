@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <QueryCommand.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static const std::string dbFileName = "QueryCommandTest.db";
+static const std::string schemaFileName = "QueryCommandTest.sch";
+
+static void removeDatabase()
+{
+	for(const std::string& fileName : {dbFileName, schemaFileName, dbFileName + ".cat", dbFileName + ".fsm"})
+	{
+		std::remove(fileName.c_str());
+	}
+}
+
+// An empty database, with the schema of the runners.
+static void createDatabase()
+{
+	removeDatabase();
+
+	std::ofstream{dbFileName};
+	std::ofstream{schemaFileName};
+
+	FileValueWriter<usedEndianness> schemaWriter{schemaFileName};
+	schemaWriter.write(DbSchemaSerializer<usedEndianness>::serialize(
+		DbSchema{"Runner", {{"Name", {DataType::CHARACTER, 12}}, {"BestTime", {DataType::INTEGER, 32}}}}));
+}
+
+// What the command prints on the standard output, the exit code is checked.
+static std::string runCommand(const std::string& statement)
+{
+	std::vector<std::string> arguments{"query", dbFileName, schemaFileName, statement};
+	std::vector<char*> argv;
+
+	for(std::string& argument : arguments) argv.push_back(&argument[0]);
+
+	std::ostringstream output;
+	std::streambuf* coutBuffer = std::cout.rdbuf(output.rdbuf());
+	int exitCode = runQueryCommand(argv.size(), argv.data());
+	std::cout.rdbuf(coutBuffer);
+
+	expect(exitCode, equal_to(EXIT_SUCCESS));
+
+	return output.str();
+}
+
+suite<> queryCommandSuite("Testing suite for the query command", [](auto& _){
+	_.test("Testing that only the rows of a select are printed", []() {
+		createDatabase();
+
+		expect(runCommand("INSERT INTO Runner VALUES ('Ann', 3400), ('Bob', 4100), ('Norbert', 3550)"), equal_to(""));
+		expect(runCommand("SELECT Name, BestTime FROM Runner WHERE BestTime < 4000 ORDER BY BestTime"),
+			   equal_to("Name\tBestTime\nAnn\t3400\nNorbert\t3550\n"));
+		expect(runCommand("DELETE FROM Runner WHERE Name = 'Bob'"), equal_to(""));
+		expect(runCommand("SELECT count(*) FROM Runner"), equal_to("count(*)\n2\n"));
+
+		removeDatabase();
+	});
+});
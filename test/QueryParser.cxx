@@ -0,0 +1,115 @@
+#include <string>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <FileValueReader.hxx>
+#include <FileValueWriter.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+#include <DiskPage.hxx>
+#include <BufferManager.hxx>
+#include <PageWriter.hxx>
+#include <DbSystem.hxx>
+#include <Predicate.hxx>
+#include <QueryPlan.hxx>
+#include <QueryParser.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+static const std::vector<DbSchema>& getSchemas()
+{
+	static const std::vector<DbSchema> schemas{
+		DbSchema{"Runner", {{"Name", {DataType::CHARACTER, 12}}, {"BestTime", {DataType::INTEGER, 32}}, {"Club", {DataType::INTEGER, 32}}}},
+		DbSchema{"Club", {{"Id", {DataType::INTEGER, 32}}, {"Name", {DataType::CHARACTER, 12}}, {"City", {DataType::CHARACTER, 12}}}}};
+
+	return schemas;
+}
+
+static SqlStatement parse(const std::string& text)
+{
+	return QueryParser<usedEndianness>{getSchemas()}.parse(text);
+}
+
+static std::vector<std::string> getSortedFieldNames(const optional<Predicate>& predicate)
+{
+	std::vector<std::string> fieldNames;
+	if(predicate) fieldNames = predicate->getFieldNames();
+	std::sort(fieldNames.begin(), fieldNames.end());
+
+	return fieldNames;
+}
+
+suite<> queryParserSuite("Testing suite for QueryParser", [](auto& _){
+	_.test("Testing that a select is parsed into its columns, conditions, groups, sort keys and limit", []() {
+		SqlStatement statement = parse("select Name, count(*), MAX(BestTime) from Runner where BestTime between 3000 and 4000 "
+									   "and (Club = 2 or 'Ann' = Name) group by Name order by max(BestTime) desc, Name limit 5;");
+
+		expect(statement.kind, equal_to(StatementKind::select));
+		expect(statement.columnNames, equal_to(std::vector<std::string>{"Name", "count(*)", "max(BestTime)"}));
+		expect(statement.aggregates.size(), equal_to(2u));
+		expect(statement.conditions.size(), equal_to(3u));
+		expect(statement.groupColumnNames, equal_to(std::vector<std::string>{"Name"}));
+		expect(statement.sortKeys.size(), equal_to(2u));
+		expect(statement.sortKeys[0].columnName, equal_to("max(BestTime)"));
+		expect(statement.sortKeys[0].isDescending, equal_to(true));
+		expect(statement.sortKeys[1].isDescending, equal_to(false));
+		expect(*statement.limit, equal_to(5u));
+
+		SqlStatement all = parse("SELECT * FROM Club");
+		expect(all.columnNames, equal_to(std::vector<std::string>{"Id", "Name", "City"}));
+	});
+
+	_.test("Testing that the conditions on a single table are pushed down to its scan", []() {
+		QueryPlan plan = QueryPlanner::plan(parse("SELECT r.Name, c.Name FROM Runner r JOIN Club AS c ON c.Id = Club "
+												  "WHERE City = 'Lyon' AND r.BestTime < 3600 AND (r.Name = 'Ann' OR c.Name = 'ASL')"));
+
+		expect(plan.scans.size(), equal_to(2u));
+		expect(plan.joins[0].leftColumnName, equal_to("r.Club"));
+		expect(plan.joins[0].rightColumnName, equal_to("c.Id"));
+		expect(plan.scans[0].columnPrefix, equal_to("r."));
+		expect(getSortedFieldNames(plan.scans[0].predicate), equal_to(std::vector<std::string>{"BestTime"}));
+		expect(getSortedFieldNames(plan.scans[1].predicate), equal_to(std::vector<std::string>{"City"}));
+		expect(getSortedFieldNames(plan.filter), equal_to(std::vector<std::string>{"c.Name", "r.Name"}));
+		expect(plan.scans[0].fieldNames, equal_to(std::vector<std::string>{"Name", "Club"}));
+		expect(plan.scans[1].fieldNames, equal_to(std::vector<std::string>{"Name", "Id"}));
+	});
+
+	_.test("Testing that the inserts, updates and deletes are parsed into their fields and values", []() {
+		SqlStatement insert = parse("INSERT INTO Runner (BestTime, Name) VALUES (3400, 'Norbert'), (3550, 'Ann''s')");
+
+		expect(insert.kind, equal_to(StatementKind::insert));
+		expect(insert.fieldNames, equal_to(std::vector<std::string>{"BestTime", "Name"}));
+		expect(insert.rows[1], equal_to(std::vector<std::string>{"3550", "Ann's"}));
+		expect(parse("insert into Club values (1, 'ASL', 'Lyon')").fieldNames.size(), equal_to(3u));
+
+		QueryPlan update = QueryPlanner::plan(parse("UPDATE Runner SET BestTime = 3300, Club = 2 WHERE Name = 'Norbert'"));
+
+		expect(update.kind, equal_to(StatementKind::update));
+		expect(update.rows[0], equal_to(std::vector<std::string>{"3300", "2"}));
+		expect(getSortedFieldNames(update.scans[0].predicate), equal_to(std::vector<std::string>{"Name"}));
+
+		QueryPlan remove = QueryPlanner::plan(parse("DELETE FROM Runner"));
+
+		expect(remove.kind, equal_to(StatementKind::remove));
+		expect(bool(remove.scans[0].predicate), equal_to(false));
+	});
+
+	_.test("Testing that the statements not fitting the grammar or the schemas are rejected", []() {
+		expect([]() { parse("SELECT Name FROM Walker"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Surname FROM Runner"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name FROM Runner JOIN Club ON Club = Id"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name FROM Runner WHERE BestTime < Club"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name, count(*) FROM Runner"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name FROM Runner WHERE Name = 'Ann"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name FROM Runner LIMIT 1.5"); }, thrown<ParsingException>());
+		expect([]() { parse("INSERT INTO Runner (Name) VALUES ('Ann', 3400)"); }, thrown<ParsingException>());
+		expect([]() { parse("DELETE Runner"); }, thrown<ParsingException>());
+		expect([]() { parse("SELECT Name FROM Runner extra words"); }, thrown<ParsingException>());
+	});
+});
@@ -0,0 +1,18 @@
+#ifndef RUNNER_SCHEMA_HXX
+#define RUNNER_SCHEMA_HXX
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <Schema.hxx>
+
+/* The schema the tests build their rows on, one field of each kind the rows are read and compared by.
+ * Layout : Name (0, 12 bytes), BestTime (12, 4), Speed (16, 8), Birth (24, 4), Licensed (28, 1), Number (29, 2).
+ */
+inline DbSchema makeRunnerSchema()
+{
+	return DbSchema{"Runner", {{"Name", {DataType::CHARACTER, 12}}, {"BestTime", {DataType::INTEGER, 32}},
+							   {"Speed", {DataType::FLOAT, 48}}, {"Birth", {DataType::DATE}},
+							   {"Licensed", {DataType::BOOLEAN}}, {"Number", {DataType::INTEGER, 16}}}};
+}
+
+#endif // RUNNER_SCHEMA_HXX
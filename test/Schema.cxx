@@ -0,0 +1,56 @@
+#include <string>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbEntry.hxx>
+
+#include "RunnerSchema.hxx"
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+suite<> schemaSuite("Testing suite for DbSchema", [](auto& _){
+	_.test("Testing that the field offsets follow the fields", []() {
+		DbSchema schema = makeRunnerSchema();
+
+		expect(schema.getFieldOffset(0), equal_to(0));
+		expect(schema.getFieldOffset(1), equal_to(12));
+		expect(schema.getFieldOffset(2), equal_to(16));
+		expect(schema.getFieldOffset("Number"), equal_to(29));
+		expect(schema.getDataSize(), equal_to(31));
+	});
+
+	_.test("Testing that the fields are found by name", []() {
+		DbSchema schema = makeRunnerSchema();
+
+		expect(*schema.findIndexOf("BestTime"), equal_to(1));
+		expect(static_cast<bool>(schema.findIndexOf("Surname")), equal_to(false));
+		expect(static_cast<bool>(schema.findFieldRef("Surname")), equal_to(false));
+	});
+
+	_.test("Testing that a resolved field describes the field", []() {
+		DbSchema schema = makeRunnerSchema();
+		FieldRef field = *schema.findFieldRef("Number");
+
+		expect(field.index, equal_to(5));
+		expect(field.offset, equal_to(29));
+		expect(field.size, equal_to(2));
+		expect(field.type == DataType::INTEGER, equal_to(true));
+	});
+
+	_.test("Testing that a row is read the same by name and through a resolved field", []() {
+		DbSchema schema = makeRunnerSchema();
+		DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+
+		entry.setAs("Name", "Bertrand");
+		entry.setAs<uint32_t>("BestTime", 4242);
+
+		expect(entry.getAs<uint32_t>(*schema.findFieldRef("BestTime")), equal_to(4242));
+		expect(entry.getView().getAs<std::string>(schema.getFieldRef(0)), equal_to("Bertrand"));
+		expect(entry.getAs<uint32_t>("BestTime"), equal_to(entry.getAs<uint32_t>(1)));
+	});
+});
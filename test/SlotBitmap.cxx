@@ -0,0 +1,64 @@
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <SlotBitmap.hxx>
+
+suite<> slotBitmapSuite("Testing suite for SlotBitmap", [](auto& _){
+	_.test("Testing that the bitmap is made of whole 64 bits words", []() {
+		expect(SlotBitmap::getSize(0), equal_to(0));
+		expect(SlotBitmap::getSize(1), equal_to(8));
+		expect(SlotBitmap::getSize(64), equal_to(8));
+		expect(SlotBitmap::getSize(65), equal_to(16));
+	});
+
+	_.test("Testing that a slot is set and reset alone", []() {
+		std::vector<uint8_t> bitmap(SlotBitmap::getSize(130), 0);
+
+		SlotBitmap::set(bitmap.data(), 0);
+		SlotBitmap::set(bitmap.data(), 63);
+		SlotBitmap::set(bitmap.data(), 129);
+		SlotBitmap::reset(bitmap.data(), 63);
+
+		expect(SlotBitmap::test(bitmap.data(), 0), equal_to(true));
+		expect(SlotBitmap::test(bitmap.data(), 1), equal_to(false));
+		expect(SlotBitmap::test(bitmap.data(), 63), equal_to(false));
+		expect(SlotBitmap::test(bitmap.data(), 129), equal_to(true));
+		expect(bitmap[0], equal_to(1));
+		expect(bitmap[16], equal_to(2));
+	});
+
+	_.test("Testing that the next used slot is found across the words", []() {
+		size_type slotCount = 200;
+		std::vector<uint8_t> bitmap(SlotBitmap::getSize(slotCount), 0);
+
+		expect(SlotBitmap::findNextUsed(bitmap.data(), 0, slotCount), equal_to(slotCount));
+
+		SlotBitmap::set(bitmap.data(), 3);
+		SlotBitmap::set(bitmap.data(), 150);
+
+		expect(SlotBitmap::findNextUsed(bitmap.data(), 0, slotCount), equal_to(3));
+		expect(SlotBitmap::findNextUsed(bitmap.data(), 3, slotCount), equal_to(3));
+		expect(SlotBitmap::findNextUsed(bitmap.data(), 4, slotCount), equal_to(150));
+		expect(SlotBitmap::findNextUsed(bitmap.data(), 151, slotCount), equal_to(slotCount));
+		expect(SlotBitmap::findNextUsed(bitmap.data(), slotCount, slotCount), equal_to(slotCount));
+	});
+
+	_.test("Testing that the first free slot skips the full words", []() {
+		size_type slotCount = 70;
+		std::vector<uint8_t> bitmap(SlotBitmap::getSize(slotCount), 0);
+
+		expect(SlotBitmap::findFirstFree(bitmap.data(), slotCount), equal_to(0));
+
+		for(size_type i = 0; i < 66; ++i) SlotBitmap::set(bitmap.data(), i);
+
+		expect(SlotBitmap::findFirstFree(bitmap.data(), slotCount), equal_to(66));
+
+		for(size_type i = 66; i < slotCount; ++i) SlotBitmap::set(bitmap.data(), i);
+
+		// The bits past the last slot are free, but are no slots.
+		expect(SlotBitmap::findFirstFree(bitmap.data(), slotCount), equal_to(slotCount));
+	});
+});
@@ -0,0 +1,101 @@
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <mettle/header_only.hpp>
+using namespace mettle;
+
+#include <Configuration.hxx>
+#include <DataTypes.hxx>
+#include <RawDataUtils.hxx>
+#include <Schema.hxx>
+#include <DbSchemaSerializer.hxx>
+#include <DbEntry.hxx>
+#include <TypedSchema.hxx>
+
+static constexpr Endianness usedEndianness = Endianness::little;
+
+namespace Fields
+{
+	TYPED_FIELD(Name, CHARACTER, 24);
+	TYPED_FIELD(BestTime, INTEGER, 32);
+	TYPED_FIELD(Number, INTEGER, 16);
+	TYPED_FIELD(Speed, FLOAT, 24);
+	TYPED_FIELD(Distance, INTEGER, 64);
+}
+
+TYPED_SCHEMA(Runner, Fields::Name, Fields::BestTime, Fields::Number, Fields::Speed);
+TYPED_SCHEMA(Lap, Fields::Number, Fields::Distance);
+
+// Everything is known at compile time.
+static_assert(Runner::getFieldCount() == 4, "");
+static_assert(Runner::getDataSize() == 34, "");
+static_assert(Runner::getFieldIndex<Fields::Number>() == 2, "");
+static_assert(Runner::getFieldOffset<Fields::BestTime>() == 24, "");
+static_assert(Runner::getFieldOffset<Fields::Speed>() == 30, "");
+static_assert(Runner::getFieldRef<Fields::Number>().size == 2, "");
+static_assert(std::is_same<Fields::BestTime::value_type, uint32_t>::value, "");
+static_assert(std::is_same<Fields::Speed::value_type, float>::value, "");
+static_assert(std::is_same<Fields::Name::value_type, std::string>::value, "");
+static_assert(std::is_same<Fields::Distance::value_type, size_type>::value, "");
+
+suite<> typedSchemaSuite("Testing suite for TypedSchema", [](auto& _){
+	_.test("Testing that the typed schema is laid out as its DbSchema", []() {
+		DbSchema schema = Runner::toDbSchema();
+
+		expect(schema.getName(), equal_to("Runner"));
+		expect(schema.getDataSize(), equal_to(Runner::getDataSize()));
+		expect(schema.getFieldOffset("Speed"), equal_to(Runner::getFieldOffset<Fields::Speed>()));
+		expect(Runner::matches(schema), equal_to(true));
+	});
+
+	_.test("Testing that a serialized typed schema reads back as the same schema", []() {
+		auto serialData = DbSchemaSerializer<usedEndianness>::serialize(Runner::toDbSchema());
+
+		// The deserializer does not want the size in front of the schema.
+		std::vector<uint8_t> schemaData(serialData.begin() + sizeof(size_type), serialData.end());
+
+		expect(Runner::matches(DbSchemaSerializer<usedEndianness>::deserialize(schemaData)), equal_to(true));
+	});
+
+	_.test("Testing that another schema does not match", []() {
+		DbSchema renamed{"Runner", {{"Name", {DataType::CHARACTER, 24}}, {"BestTime", {DataType::INTEGER, 32}},
+									{"Number", {DataType::INTEGER, 32}}, {"Speed", {DataType::FLOAT, 24}}}};
+		DbSchema shorter{"Runner", {{"Name", {DataType::CHARACTER, 24}}}};
+
+		expect(Runner::matches(renamed), equal_to(false));
+		expect(Runner::matches(shorter), equal_to(false));
+	});
+
+	_.test("Testing that a row is read the same typed and untyped", []() {
+		DbSchema schema = Runner::toDbSchema();
+		DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+
+		entry.setAs("Name", "Didier");
+		entry.setAs<uint32_t>("BestTime", 1234);
+		entry.setAs<uint16_t>("Number", 7);
+
+		TypedEntryView<usedEndianness, Runner> runner{entry.getView()};
+
+		expect(runner.get<Fields::Name>(), equal_to("Didier"));
+		expect(runner.get<Fields::BestTime>(), equal_to(entry.getAs<uint32_t>("BestTime")));
+		expect(runner.get<Fields::Number>(), equal_to(7));
+	});
+
+	_.test("Testing that the integers wider than 32 bits are read whole", []() {
+		DbSchema schema = Lap::toDbSchema();
+		DbEntry<usedEndianness> entry{schema, std::vector<uint8_t>(schema.getDataSize())};
+
+		for(uint64_t distance : {(uint64_t{1} << 32) + 5, uint64_t{0x80000001FFFFFFFF}})
+		{
+			entry.setAs<uint64_t>("Distance", distance);
+			entry.setAs<uint16_t>("Number", 0xFFFF);
+
+			TypedEntryView<usedEndianness, Lap> lap{entry.getView()};
+
+			expect(lap.get<Fields::Distance>(), equal_to(distance));
+			expect(entry.getAs<uint64_t>("Distance"), equal_to(distance));
+			expect(lap.get<Fields::Number>(), equal_to(0xFFFF));
+		}
+	});
+});